@@ -0,0 +1,18 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    core \
+    app \
+    cli \
+    tests
+
+core.subdir = omodscan/core
+
+app.file = omodscan/omodscan.pro
+app.depends = core
+
+cli.subdir = omodscan/cli
+cli.depends = core
+
+tests.subdir = omodscan/tests
+tests.depends = core
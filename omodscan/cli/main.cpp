@@ -0,0 +1,25 @@
+#include <QTimer>
+#include <QCoreApplication>
+#include "modbusclitool.h"
+
+///
+/// \brief main
+/// \param argc
+/// \param argv
+/// \return
+///
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationName(APP_NAME);
+    a.setApplicationVersion(APP_VERSION);
+
+    ModbusCliTool tool;
+    if(!tool.parse(a.arguments()))
+        return ModbusCliTool::UsageError;
+
+    QObject::connect(&tool, &ModbusCliTool::finished, &a, &QCoreApplication::exit, Qt::QueuedConnection);
+    QTimer::singleShot(0, &tool, &ModbusCliTool::start);
+
+    return a.exec();
+}
@@ -0,0 +1,542 @@
+#include <limits>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+#include <QCommandLineParser>
+#include "formatutils.h"
+#include "modbuslimits.h"
+#include "modbusexception.h"
+#include "modbustcpscanner.h"
+#include "modbusrtuscanner.h"
+#include "modbusclitool.h"
+
+namespace {
+const int RegisterChunk = 120;  ///< a multiple of every value width, within the 125 register limit
+const int CoilChunk = 2000;
+
+const QMap<QString, DataDisplayMode> Formats = {
+    { "binary",         DataDisplayMode::Binary },
+    { "uint16",         DataDisplayMode::UInt16 },
+    { "int16",          DataDisplayMode::Int16 },
+    { "hex",            DataDisplayMode::Hex },
+    { "float",          DataDisplayMode::FloatingPt },
+    { "swapped-float",  DataDisplayMode::SwappedFP },
+    { "double",         DataDisplayMode::DblFloat },
+    { "swapped-double", DataDisplayMode::SwappedDbl },
+    { "int32",          DataDisplayMode::Int32 },
+    { "swapped-int32",  DataDisplayMode::SwappedInt32 },
+    { "uint32",         DataDisplayMode::UInt32 },
+    { "swapped-uint32", DataDisplayMode::SwappedUInt32 },
+    { "int64",          DataDisplayMode::Int64 },
+    { "swapped-int64",  DataDisplayMode::SwappedInt64 },
+    { "uint64",         DataDisplayMode::UInt64 },
+    { "swapped-uint64", DataDisplayMode::SwappedUInt64 }
+};
+
+const QMap<QString, QModbusDataUnit::RegisterType> PointTypes = {
+    { "coils",      QModbusDataUnit::Coils },
+    { "discrete",   QModbusDataUnit::DiscreteInputs },
+    { "input",      QModbusDataUnit::InputRegisters },
+    { "holding",    QModbusDataUnit::HoldingRegisters }
+};
+
+///
+/// \brief parseUInt
+/// Hex values may have a 0x prefix, other formats accept one too
+/// \param text
+/// \param mode
+/// \param max
+/// \param ok
+/// \return
+///
+quint64 parseUInt(QString text, DataDisplayMode mode, quint64 max, bool* ok)
+{
+    text = text.trimmed();
+
+    int base = 10;
+    if(text.startsWith("0x", Qt::CaseInsensitive))
+    {
+        text.remove(0, 2);
+        base = 16;
+    }
+    else if(mode == DataDisplayMode::Hex)
+    {
+        base = 16;
+    }
+    else if(mode == DataDisplayMode::Binary)
+    {
+        base = 2;
+    }
+
+    const auto value = text.toULongLong(ok, base);
+    if(*ok && value > max)
+        *ok = false;
+
+    return value;
+}
+
+///
+/// \brief parseWriteValue
+/// \param type
+/// \param mode
+/// \param text
+/// \return the value as ModbusClient::writeRegister expects it, invalid when text does not fit the format
+///
+QVariant parseWriteValue(QModbusDataUnit::RegisterType type, DataDisplayMode mode, const QString& text)
+{
+    bool ok = false;
+    QVariant value;
+
+    if(type == QModbusDataUnit::Coils)
+    {
+        value = uint(parseUInt(text, DataDisplayMode::UInt16, 1, &ok));
+        return ok ? value : QVariant();
+    }
+
+    const auto str = text.trimmed();
+    switch(mode)
+    {
+        case DataDisplayMode::Int16:
+        {
+            const auto v = str.toShort(&ok);
+            value = uint(quint16(v));
+        }
+        break;
+
+        case DataDisplayMode::FloatingPt:
+        case DataDisplayMode::SwappedFP:
+            value = str.toFloat(&ok);
+        break;
+
+        case DataDisplayMode::DblFloat:
+        case DataDisplayMode::SwappedDbl:
+            value = str.toDouble(&ok);
+        break;
+
+        case DataDisplayMode::Int32:
+        case DataDisplayMode::SwappedInt32:
+            value = str.toInt(&ok);
+        break;
+
+        // written through the signed path, so the bits are kept as they are
+        case DataDisplayMode::UInt32:
+        case DataDisplayMode::SwappedUInt32:
+            value = qint32(quint32(parseUInt(str, mode, std::numeric_limits<quint32>::max(), &ok)));
+        break;
+
+        case DataDisplayMode::Int64:
+        case DataDisplayMode::SwappedInt64:
+            value = str.toLongLong(&ok);
+        break;
+
+        case DataDisplayMode::UInt64:
+        case DataDisplayMode::SwappedUInt64:
+            value = qint64(parseUInt(str, mode, std::numeric_limits<quint64>::max(), &ok));
+        break;
+
+        default:
+            value = uint(parseUInt(str, mode, 0xFFFF, &ok));
+        break;
+    }
+
+    return ok ? value : QVariant();
+}
+
+///
+/// \brief replyError
+/// \param reply
+/// \return
+///
+QString replyError(const QModbusReply* reply)
+{
+    if(reply->error() != QModbusDevice::ProtocolError)
+        return reply->errorString();
+
+    const ModbusException ex(reply->rawResult().exceptionCode());
+    return QString("%1 (%2)").arg(ex, formatUInt8Value(DataDisplayMode::Hex, ex));
+}
+}
+
+///
+/// \brief ModbusCliTool::ModbusCliTool
+/// \param parent
+///
+ModbusCliTool::ModbusCliTool(QObject* parent)
+    : QObject(parent)
+    ,_out(stdout)
+    ,_err(stderr)
+{
+    connect(&_modbusClient, &ModbusClient::modbusConnected, this, &ModbusCliTool::on_modbusConnected);
+    connect(&_modbusClient, &ModbusClient::modbusDisconnected, this, &ModbusCliTool::on_modbusDisconnected);
+    connect(&_modbusClient, &ModbusClient::modbusConnectionError, this, &ModbusCliTool::on_modbusConnectionError);
+    connect(&_modbusClient, &ModbusClient::modbusError, this, &ModbusCliTool::on_modbusError);
+    connect(&_modbusClient, &ModbusClient::modbusReply, this, &ModbusCliTool::on_modbusReply);
+}
+
+///
+/// \brief ModbusCliTool::parse
+/// \param arguments
+/// \return false when the arguments are not usable, the reason is already printed
+///
+bool ModbusCliTool::parse(const QStringList& arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(tr("One-shot Modbus read, write and device scan."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("command", tr("read, write or scan"));
+
+    const QCommandLineOption tcpOption("tcp", tr("Modbus TCP server, may be repeated for a scan."), "host[:port]");
+    const QCommandLineOption serialOption("serial", tr("Serial port for Modbus RTU."), "port");
+    const QCommandLineOption baudOption("baud", tr("Baud rate of the serial port."), "rate", "9600");
+    const QCommandLineOption parityOption("parity", tr("Parity of the serial port: N, E or O."), "parity", "N");
+    const QCommandLineOption timeoutOption("timeout", tr("Response timeout."), "ms", "1000");
+    const QCommandLineOption retriesOption("retries", tr("Number of retries."), "n", "0");
+    const QCommandLineOption deviceOption("device", tr("Device id."), "id", "1");
+    const QCommandLineOption typeOption("type", tr("Point type: coils, discrete, input or holding."), "type", "holding");
+    const QCommandLineOption addressOption("address", tr("First address."), "address", "1");
+    const QCommandLineOption countOption("count", tr("Number of values to read, reads are split into valid requests."), "count", "1");
+    const QCommandLineOption zeroBasedOption("zero-based", tr("Addresses start at 0."));
+    const QCommandLineOption formatOption("format", tr("Value format: %1.").arg(Formats.keys().join(", ")), "format", "uint16");
+    const QCommandLineOption swappedOption("swapped", tr("Swap the bytes of every register."));
+    const QCommandLineOption valueOption("value", tr("Value to write, a comma separated list writes raw registers or coils."), "value");
+    const QCommandLineOption fromOption("from", tr("First device id to scan."), "id", "1");
+    const QCommandLineOption toOption("to", tr("Last device id to scan."), "id", "247");
+    const QCommandLineOption jsonOption("json", tr("Write the result as JSON."));
+
+    parser.addOptions({ tcpOption, serialOption, baudOption, parityOption, timeoutOption, retriesOption,
+                        deviceOption, typeOption, addressOption, countOption, zeroBasedOption, formatOption,
+                        swappedOption, valueOption, fromOption, toOption, jsonOption });
+    parser.process(arguments);
+
+    auto usageError = [this](const QString& error) {
+        _err << error << Qt::endl;
+        return false;
+    };
+
+    const auto command = parser.positionalArguments().value(0);
+    if(command == "read") _command = Command::Read;
+    else if(command == "write") _command = Command::Write;
+    else if(command == "scan") _command = Command::Scan;
+    else return usageError(tr("Unknown command '%1', expected read, write or scan").arg(command));
+
+    // connection
+    ConnectionDetails cd;
+    cd.ModbusParams.SlaveResponseTimeOut = parser.value(timeoutOption).toUInt();
+    cd.ModbusParams.NumberOfRetries = parser.value(retriesOption).toUInt();
+    cd.ModbusParams.normalize();
+
+    if(parser.isSet(serialOption))
+    {
+        static const QMap<QString, QSerialPort::Parity> parities = {
+            { "N", QSerialPort::NoParity }, { "E", QSerialPort::EvenParity }, { "O", QSerialPort::OddParity }
+        };
+
+        cd.Type = ConnectionType::Serial;
+        cd.SerialParams.PortName = parser.value(serialOption);
+        cd.SerialParams.BaudRate = QSerialPort::BaudRate(parser.value(baudOption).toInt());
+        cd.SerialParams.Parity = parities.value(parser.value(parityOption).toUpper(), QSerialPort::NoParity);
+        cd.SerialParams.normalize();
+        _scanTargets.append(cd);
+    }
+    else if(parser.isSet(tcpOption))
+    {
+        for(auto&& target : parser.values(tcpOption))
+        {
+            const auto parts = target.split(':');
+            cd.Type = ConnectionType::Tcp;
+            cd.TcpParams.IPAddress = parts.value(0);
+            cd.TcpParams.ServicePort = quint16(parts.value(1, "502").toUInt());
+            cd.TcpParams.normalize();
+            _scanTargets.append(cd);
+        }
+    }
+    else
+    {
+        return usageError(tr("No connection given, use --tcp or --serial"));
+    }
+    _connParams = _scanTargets.first();
+    _scanTimeout = int(cd.ModbusParams.SlaveResponseTimeOut);
+
+    // data
+    if(!PointTypes.contains(parser.value(typeOption)))
+        return usageError(tr("Unknown point type '%1'").arg(parser.value(typeOption)));
+    _pointType = PointTypes.value(parser.value(typeOption));
+
+    if(!Formats.contains(parser.value(formatOption)))
+        return usageError(tr("Unknown format '%1'").arg(parser.value(formatOption)));
+    _mode = Formats.value(parser.value(formatOption));
+    _order = parser.isSet(swappedOption) ? ByteOrder::Swapped : ByteOrder::Direct;
+
+    _zeroBased = parser.isSet(zeroBasedOption);
+    _deviceId = parser.value(deviceOption).toInt();
+    _count = parser.value(countOption).toInt();
+    _json = parser.isSet(jsonOption);
+
+    const int address = parser.value(addressOption).toInt() - (_zeroBased ? 0 : 1);
+    if(!ModbusLimits::slaveRange().contains(_deviceId))
+        return usageError(tr("Invalid device id %1").arg(parser.value(deviceOption)));
+    if(address < 0 || _count < 1 || address + _count > 65536)
+        return usageError(tr("Invalid address range"));
+    _address = quint16(address);
+
+    _deviceIds = QRange<int>(parser.value(fromOption).toInt(), parser.value(toOption).toInt());
+
+    if(_command == Command::Write)
+    {
+        if(_pointType != QModbusDataUnit::Coils && _pointType != QModbusDataUnit::HoldingRegisters)
+            return usageError(tr("Only coils and holding registers can be written"));
+        if(!parser.isSet(valueOption))
+            return usageError(tr("No value given, use --value"));
+
+        const auto format = parser.value(formatOption);
+        const auto items = parser.value(valueOption).split(',');
+        if(items.size() > 1)
+        {
+            // a list is written as raw registers or coils
+            if(valueWidth(_pointType, _mode) > 1)
+                return usageError(tr("A comma separated list writes raw registers, it cannot be used with format %1").arg(format));
+
+            QVector<quint16> values;
+            for(auto&& item : items)
+            {
+                const auto value = parseWriteValue(_pointType, _mode, item);
+                if(!value.isValid())
+                    return usageError(tr("Invalid value '%1' for format %2").arg(item.trimmed(), format));
+                values.push_back(quint16(value.toUInt()));
+            }
+            _writeValue = QVariant::fromValue(values);
+        }
+        else
+        {
+            _writeValue = parseWriteValue(_pointType, _mode, items.first());
+            if(!_writeValue.isValid())
+                return usageError(tr("Invalid value '%1' for format %2").arg(items.first().trimmed(), format));
+        }
+    }
+
+    return true;
+}
+
+///
+/// \brief ModbusCliTool::start
+///
+void ModbusCliTool::start()
+{
+    if(_command != Command::Scan)
+    {
+        _modbusClient.connectDevice(_connParams);
+        return;
+    }
+
+    ScanParams params;
+    params.ConnParams = _scanTargets;
+    params.DeviceIds = _deviceIds;
+    params.Timeout = _scanTimeout;
+
+    switch(_pointType)
+    {
+        case QModbusDataUnit::Coils: params.Request = QModbusRequest(QModbusPdu::ReadCoils, _address, quint16(1)); break;
+        case QModbusDataUnit::DiscreteInputs: params.Request = QModbusRequest(QModbusPdu::ReadDiscreteInputs, _address, quint16(1)); break;
+        case QModbusDataUnit::InputRegisters: params.Request = QModbusRequest(QModbusPdu::ReadInputRegisters, _address, quint16(1)); break;
+        default: params.Request = QModbusRequest(QModbusPdu::ReadHoldingRegisters, _address, quint16(1)); break;
+    }
+
+    if(_connParams.Type == ConnectionType::Serial)
+        _scanner.reset(new ModbusRtuScanner(params, this));
+    else
+        _scanner.reset(new ModbusTcpScanner(params, this));
+
+    connect(_scanner.data(), &ModbusScanner::found, this, &ModbusCliTool::on_deviceFound, Qt::QueuedConnection);
+    connect(_scanner.data(), &ModbusScanner::finished, this, &ModbusCliTool::on_scanFinished, Qt::QueuedConnection);
+    connect(_scanner.data(), &ModbusScanner::errorOccurred, this, [this](const QString& error) { _err << error << Qt::endl; }, Qt::QueuedConnection);
+
+    _scanner->startScan();
+}
+
+///
+/// \brief ModbusCliTool::on_modbusConnected
+///
+void ModbusCliTool::on_modbusConnected(const ConnectionDetails&)
+{
+    if(_command == Command::Read)
+    {
+        sendNextRead();
+        return;
+    }
+
+    ModbusWriteParams params;
+    params.Node = quint32(_deviceId);
+    params.Address = _address;
+    params.ZeroBasedAddress = true;
+    params.DisplayMode = _mode;
+    params.Order = _order;
+    params.Value = _writeValue;
+
+    _modbusClient.writeRegister(_pointType, params, 1);
+}
+
+///
+/// \brief ModbusCliTool::on_modbusDisconnected
+///
+void ModbusCliTool::on_modbusDisconnected(const ConnectionDetails&)
+{
+    finish(CommunicationError, tr("Connection closed"));
+}
+
+///
+/// \brief ModbusCliTool::on_modbusConnectionError
+/// \param error
+///
+void ModbusCliTool::on_modbusConnectionError(const QString& error)
+{
+    finish(CommunicationError, error);
+}
+
+///
+/// \brief ModbusCliTool::on_modbusError
+/// \param error
+///
+void ModbusCliTool::on_modbusError(const QString& error, int)
+{
+    finish(CommunicationError, error);
+}
+
+///
+/// \brief ModbusCliTool::on_modbusReply
+/// \param reply
+///
+void ModbusCliTool::on_modbusReply(QModbusReply* reply)
+{
+    if(!reply || _done) return;
+
+    if(reply->error() != QModbusDevice::NoError)
+    {
+        finish(CommunicationError, replyError(reply));
+        return;
+    }
+
+    if(_command == Command::Write)
+    {
+        finish(Success);
+        return;
+    }
+
+    const auto values = reply->result().values();
+    const int count = qMin(_count - _values.size(), int(values.size()));
+    for(int i = 0; i < count; i++)
+        _values.push_back(values.at(i));
+
+    if(_values.size() < _count)
+    {
+        sendNextRead();
+    }
+    else
+    {
+        printValues();
+        finish(Success);
+    }
+}
+
+///
+/// \brief ModbusCliTool::on_deviceFound
+/// \param cd
+/// \param deviceId
+/// \param dubious
+///
+void ModbusCliTool::on_deviceFound(const ConnectionDetails& cd, int deviceId, bool dubious)
+{
+    // a dubious answer may be confirmed later
+    const auto key = qMakePair(targetName(cd), deviceId);
+    _found[key] = _found.value(key, true) && dubious;
+}
+
+///
+/// \brief ModbusCliTool::on_scanFinished
+///
+void ModbusCliTool::on_scanFinished()
+{
+    QJsonArray devices;
+    for(auto it = _found.cbegin(); it != _found.cend(); ++it)
+    {
+        if(_json)
+            devices.append(QJsonObject{ { "target", it.key().first }, { "device", it.key().second }, { "dubious", it.value() } });
+        else
+            _out << it.key().first << ';' << it.key().second << ';' << int(it.value()) << '\n';
+    }
+
+    if(_json)
+        _out << QJsonDocument(devices).toJson(QJsonDocument::Compact) << '\n';
+
+    finish(Success);
+}
+
+///
+/// \brief ModbusCliTool::sendNextRead
+///
+void ModbusCliTool::sendNextRead()
+{
+    const bool isBit = (_pointType == QModbusDataUnit::Coils || _pointType == QModbusDataUnit::DiscreteInputs);
+    const int chunk = qMin(_count - _values.size(), isBit ? CoilChunk : RegisterChunk);
+    _modbusClient.sendReadRequest(_pointType, _address + _values.size(), quint16(chunk), _deviceId, 1, ModbusClient::Priority::InteractiveRead);
+}
+
+///
+/// \brief ModbusCliTool::printValues
+/// One line per value, multi-register values are listed at their first address
+///
+void ModbusCliTool::printValues()
+{
+    const int width = valueWidth(_pointType, _mode);
+
+    QJsonArray items;
+    for(int i = 0; i + width <= _values.size(); i += width)
+    {
+        const int address = _address + i + (_zeroBased ? 0 : 1);
+        const auto value = decodeValue(_pointType, _mode, _order, _values.constData() + i);
+        const auto text = formatPlainValue(_mode, value);
+
+        if(_json)
+            items.append(QJsonObject{ { "address", address }, { "value", QJsonValue::fromVariant(value) } });
+        else
+            _out << address << ';' << text << '\n';
+    }
+
+    if(_json)
+    {
+        const QJsonObject result{ { "device", _deviceId }, { "values", items } };
+        _out << QJsonDocument(result).toJson(QJsonDocument::Compact) << '\n';
+    }
+}
+
+///
+/// \brief ModbusCliTool::finish
+/// \param exitCode
+/// \param error
+///
+void ModbusCliTool::finish(int exitCode, const QString& error)
+{
+    if(_done) return;
+    _done = true;
+
+    if(!error.isEmpty())
+        _err << error << Qt::endl;
+
+    _out.flush();
+    _modbusClient.disconnectDevice();
+
+    emit finished(exitCode);
+}
+
+///
+/// \brief ModbusCliTool::targetName
+/// \param cd
+/// \return
+///
+QString ModbusCliTool::targetName(const ConnectionDetails& cd) const
+{
+    if(cd.Type == ConnectionType::Tcp)
+        return QString("%1:%2").arg(cd.TcpParams.IPAddress, QString::number(cd.TcpParams.ServicePort));
+
+    return cd.SerialParams.PortName;
+}
@@ -0,0 +1,89 @@
+#ifndef MODBUSCLITOOL_H
+#define MODBUSCLITOOL_H
+
+#include <QMap>
+#include <QTextStream>
+#include <QScopedPointer>
+#include "modbusclient.h"
+#include "modbusscanner.h"
+
+///
+/// \brief The ModbusCliTool class
+/// One-shot read, write and device scan for scripts. Results go to stdout as
+/// semicolon separated lines or JSON, diagnostics go to stderr
+///
+class ModbusCliTool : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ExitCode
+    {
+        Success = 0,
+        UsageError,
+        CommunicationError
+    };
+
+    explicit ModbusCliTool(QObject* parent = nullptr);
+
+    bool parse(const QStringList& arguments);
+
+public slots:
+    void start();
+
+signals:
+    void finished(int exitCode);
+
+private slots:
+    void on_modbusConnected(const ConnectionDetails& cd);
+    void on_modbusDisconnected(const ConnectionDetails& cd);
+    void on_modbusConnectionError(const QString& error);
+    void on_modbusError(const QString& error, int requestId);
+    void on_modbusReply(QModbusReply* reply);
+    void on_deviceFound(const ConnectionDetails& cd, int deviceId, bool dubious);
+    void on_scanFinished();
+
+private:
+    enum class Command
+    {
+        Read,
+        Write,
+        Scan
+    };
+
+    void sendNextRead();
+    void printValues();
+    void finish(int exitCode, const QString& error = QString());
+
+    QString targetName(const ConnectionDetails& cd) const;
+
+private:
+    Command _command = Command::Read;
+    bool _json = false;
+    bool _done = false;
+
+    ConnectionDetails _connParams;
+    QList<ConnectionDetails> _scanTargets;
+
+    int _deviceId = 1;
+    QModbusDataUnit::RegisterType _pointType = QModbusDataUnit::HoldingRegisters;
+    quint16 _address = 0;
+    int _count = 1;
+    bool _zeroBased = false;
+    DataDisplayMode _mode = DataDisplayMode::UInt16;
+    ByteOrder _order = ByteOrder::Direct;
+    QVariant _writeValue;
+    QRange<int> _deviceIds = QRange<int>(1, 247);
+    int _scanTimeout = 1000;
+
+    QVector<quint16> _values;
+
+    ModbusClient _modbusClient;
+    QScopedPointer<ModbusScanner> _scanner;
+    QMap<QPair<QString, int>, bool> _found;  ///< target and device id, dubious
+
+    QTextStream _out;
+    QTextStream _err;
+};
+
+#endif // MODBUSCLITOOL_H
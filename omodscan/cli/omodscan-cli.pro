@@ -0,0 +1,41 @@
+QT = core network serialbus serialport
+
+greaterThan(QT_MAJOR_VERSION, 5) {
+    QT += core5compat
+}
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+CONFIG -= debug_and_release
+CONFIG -= debug_and_release_target
+
+TARGET = omodscan-cli
+VERSION = 1.9.0
+
+QMAKE_TARGET_PRODUCT = "Open ModScan CLI"
+QMAKE_TARGET_DESCRIPTION = "Command-line Modbus read, write and scan tool"
+
+DEFINES += APP_NAME=\"\\\"$${QMAKE_TARGET_PRODUCT}\\\"\"
+DEFINES += APP_VERSION=\\\"$$VERSION\\\"
+
+# links the polling engine like the GUI, the scanners are compiled here, without QtGui or QtWidgets
+include(../core/core.pri)
+
+SOURCES += \
+    ../modbusrtuscanner.cpp \
+    ../modbusscanner.cpp \
+    ../modbustcpscanner.cpp \
+    main.cpp \
+    modbusclitool.cpp
+
+HEADERS += \
+    ../connectiondetails.h \
+    ../enums.h \
+    ../formatutils.h \
+    ../modbusexception.h \
+    ../modbuslimits.h \
+    ../modbusrtuscanner.h \
+    ../modbusscanner.h \
+    ../modbustcpscanner.h \
+    ../modbuswriteparams.h \
+    modbusclitool.h
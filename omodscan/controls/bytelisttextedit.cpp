@@ -1,5 +1,7 @@
 #include <QRegularExpressionValidator>
+#include <algorithm>
 #include <QMimeData>
+#include <QTextDocument>
 #include "formatutils.h"
 #include "bytelisttextedit.h"
 
@@ -31,7 +33,7 @@ ByteListTextEdit::ByteListTextEdit(QWidget* parent)
     ,_validator(nullptr)
 {
     setInputMode(DecMode);
-    connect(this, &QPlainTextEdit::textChanged, this, &ByteListTextEdit::on_textChanged);
+    connect(document(), &QTextDocument::contentsChange, this, &ByteListTextEdit::on_contentsChange);
 }
 
 ///
@@ -45,7 +47,7 @@ ByteListTextEdit::ByteListTextEdit(InputMode mode, QWidget *parent)
     ,_validator(nullptr)
 {
     setInputMode(mode);
-    connect(this, &QPlainTextEdit::textChanged, this, &ByteListTextEdit::on_textChanged);
+    connect(document(), &QTextDocument::contentsChange, this, &ByteListTextEdit::on_contentsChange);
 }
 
 ///
@@ -174,8 +176,9 @@ void ByteListTextEdit::keyPressEvent(QKeyEvent *e)
         return;
     }
 
+    // the pattern only constrains characters, so the typed text alone decides
     int pos = 0;
-    auto text = toPlainText() + e->text();
+    auto text = e->text();
     const auto state = _validator->validate(text, pos);
 
     if(state == QValidator::Acceptable ||
@@ -233,39 +236,69 @@ void ByteListTextEdit::insertFromMimeData(const QMimeData* source)
 }
 
 ///
-/// \brief ByteListTextEdit::on_textChanged
+/// \brief ByteListTextEdit::on_contentsChange
+/// Reparses only the edited span widened to the nearest separators
+/// and splices the result into the token list and the value
+/// \param position
+/// \param charsRemoved
+/// \param charsAdded
 ///
-void ByteListTextEdit::on_textChanged()
+void ByteListTextEdit::on_contentsChange(int position, int charsRemoved, int charsAdded)
 {
-    QByteArray value;
-    switch(_inputMode)
+    const auto doc = document();
+    const int length = doc->characterCount() - 1;
+    const int delta = charsAdded - charsRemoved;
+
+    int start = qMin(position, length);
+    while(start > 0 && !isSeparator(doc->characterAt(start - 1)))
+        start--;
+
+    int end = qMin(position + charsAdded, length);
+    while(end < length && !isSeparator(doc->characterAt(end)))
+        end++;
+
+    QTextCursor cursor(doc);
+    cursor.setPosition(start);
+    cursor.setPosition(end, QTextCursor::KeepAnchor);
+    const auto span = cursor.selectedText();
+
+    QVector<Token> tokens;
+    QByteArray bytes;
+    for(int i = 0; i < span.length();)
     {
-        case DecMode:
+        if(isSeparator(span[i]))
         {
-            for(auto&& s : text().split(_separator))
-            {
-                bool ok;
-                const quint8 v = s.trimmed().toUInt(&ok);
-                if(ok) value.push_back(v);
-            }
+            i++;
+            continue;
         }
-        break;
 
-        case HexMode:
+        const int from = i;
+        while(i < span.length() && !isSeparator(span[i]))
+            i++;
+
+        bool ok;
+        const quint8 v = span.mid(from, i - from).toUInt(&ok, _inputMode == HexMode ? 16 : 10);
+        if(ok)
         {
-            for(auto&& s : text().split(_separator))
-            {
-                bool ok;
-                const quint8 v = s.trimmed().toUInt(&ok, 16);
-                if(ok) value.push_back(v);
-            }
+            tokens.push_back({ start + from, i - from });
+            bytes.push_back(v);
         }
-        break;
     }
 
-    if(value != _value)
+    auto byStart = [](const Token& t, int pos) { return t.Start < pos; };
+    const int first = std::lower_bound(_tokens.cbegin(), _tokens.cend(), start, byStart) - _tokens.cbegin();
+    const int last = std::lower_bound(_tokens.cbegin(), _tokens.cend(), end - delta, byStart) - _tokens.cbegin();
+
+    for(int i = last; i < _tokens.size(); i++)
+        _tokens[i].Start += delta;
+
+    _tokens.remove(first, last - first);
+    _tokens.insert(first, tokens.size(), Token());
+    std::copy(tokens.cbegin(), tokens.cend(), _tokens.begin() + first);
+
+    if(last - first != bytes.size() || _value.mid(first, last - first) != bytes)
     {
-        _value = value;
+        _value.replace(first, last - first, bytes);
         emit valueChanged(_value);
     }
 }
@@ -275,35 +308,15 @@ void ByteListTextEdit::on_textChanged()
 ///
 void ByteListTextEdit::updateValue()
 {
-    QByteArray value;
-    switch(_inputMode)
-    {
-        case DecMode:
-        {
-            for(auto&& s : text().split(_separator))
-            {
-                bool ok;
-                const quint8 v = s.trimmed().toUInt(&ok);
-                if(ok) value.push_back(v);
-            }
-
-            if(!value.isEmpty()) setValue(value);
-            else setValue(_value);
-        }
-        break;
+    setValue(_value);
+}
 
-        case HexMode:
-        {
-            for(auto&& s : text().split(_separator))
-            {
-                bool ok;
-                const quint8 v = s.trimmed().toUInt(&ok, 16);
-                if(ok) value.push_back(v);
-            }
-
-            if(!value.isEmpty()) setValue(value);
-            else setValue(_value);
-        }
-        break;
-    }
+///
+/// \brief ByteListTextEdit::isSeparator
+/// \param c
+/// \return
+///
+bool ByteListTextEdit::isSeparator(QChar c) const
+{
+    return c == _separator || c.isSpace();
 }
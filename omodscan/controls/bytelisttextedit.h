@@ -3,6 +3,7 @@
 
 #include <QValidator>
 #include <QPlainTextEdit>
+#include <QVector>
 
 ///
 /// \brief The ByteListTextEdit class
@@ -31,7 +32,7 @@ public:
     void setText(const QString& text);
 
     bool isEmpty() const {
-        return text().isEmpty();
+        return document()->isEmpty();
     }
 
 signals:
@@ -44,14 +45,26 @@ protected:
     void insertFromMimeData(const QMimeData* source) override;
 
 private slots:
-    void on_textChanged();
+    void on_contentsChange(int position, int charsRemoved, int charsAdded);
 
 private:
     void updateValue();
+    bool isSeparator(QChar c) const;
 
 private:
+    ///
+    /// \brief The Token struct
+    /// Position of a parsed byte in the document, parallel to _value
+    ///
+    struct Token
+    {
+        int Start;
+        int Length;
+    };
+
     InputMode _inputMode;
     QByteArray _value;
+    QVector<Token> _tokens;
     QChar _separator;
     QValidator* _validator;
 };
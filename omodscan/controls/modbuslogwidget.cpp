@@ -74,10 +74,13 @@ void ModbusLogModel::append(const ModbusMessage* data)
 {
     if(data == nullptr) return;
 
-    while(rowCount() >= _rowLimit)
+    if(rowCount() >= _rowLimit)
     {
-        delete _items.first();
-        _items.removeFirst();
+        const int count = rowCount() - _rowLimit + 1;
+        beginRemoveRows(QModelIndex(), 0, count - 1);
+        for(int i = 0; i < count; i++)
+            delete _items.takeFirst();
+        endRemoveRows();
     }
 
     beginInsertRows(QModelIndex(), rowCount(), rowCount());
@@ -190,13 +193,23 @@ const ModbusMessage* ModbusLogWidget::addItem(const QModbusPdu& pdu, ModbusMessa
     {
         msg = ModbusMessage::create(pdu, protocol, deviceId, timestamp, request);
         if(protocol == ModbusMessage::Tcp)
-            ((QModbusAduTcp*)msg->adu())->setTransactionId(transactionId);
+            ((ModbusMessage*)msg)->setTransactionId(transactionId);
 
         ((ModbusLogModel*)model())->append(msg);
     }
     return msg;
 }
 
+///
+/// \brief ModbusLogWidget::addItem
+/// \param msg takes ownership
+///
+void ModbusLogWidget::addItem(const ModbusMessage* msg)
+{
+    if(model()) ((ModbusLogModel*)model())->append(msg);
+    else delete msg;
+}
+
 ///
 /// \brief ModbusLogWidget::itemAt
 /// \param index
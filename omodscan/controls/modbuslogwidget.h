@@ -54,6 +54,7 @@ public:
     QModelIndex index(int row);
 
     const ModbusMessage* addItem(const QModbusPdu& pdu, ModbusMessage::ProtocolType protocol, int deviceId, int transactionId, const QDateTime& timestamp, bool request);
+    void addItem(const ModbusMessage* msg);
     const ModbusMessage* itemAt(const QModelIndex& index);
 
     DataDisplayMode dataDisplayMode() const;
@@ -149,15 +149,15 @@ void ModbusMessageWidget::update()
     auto addChecksum = [&]{
         if(_mm->protocolType() == ModbusMessage::Rtu)
         {
-            auto adu = reinterpret_cast<const QModbusAduRtu*>(_mm->adu());
-            const auto checksum = formatUInt16Value(_dataDisplayMode, adu->checksum());
-            if(adu->matchingChecksum())
+            const auto adu = _mm->aduRtu();
+            const auto checksum = formatUInt16Value(_dataDisplayMode, adu.checksum());
+            if(adu.matchingChecksum())
             {
                 addItem(tr("<b>Checksum:</b> %1").arg(checksum));
             }
             else
             {
-                const auto calcChecksum = formatUInt16Value(_dataDisplayMode, adu->calcChecksum());
+                const auto calcChecksum = formatUInt16Value(_dataDisplayMode, adu.calcChecksum());
                 addItem(tr("<b>Checksum:</b> <span style='color:%3'>%1</span> (Expected: %2)").arg(checksum, calcChecksum, _statusClr.name()));
             }
         }
@@ -168,10 +168,10 @@ void ModbusMessageWidget::update()
 
     if(_mm->protocolType() == ModbusMessage::Tcp)
     {
-        auto adu = reinterpret_cast<const QModbusAduTcp*>(_mm->adu());
-        const auto transactionId = adu->isValid() ? formatUInt16Value(_dataDisplayMode, adu->transactionId()) : "??";
-        const auto protocolId = adu->isValid() ? formatUInt16Value(_dataDisplayMode, adu->protocolId()): "??";
-        const auto length = adu->isValid() ? formatUInt16Value(_dataDisplayMode, adu->length()): "??";
+        const auto adu = _mm->aduTcp();
+        const auto transactionId = adu.isValid() ? formatUInt16Value(_dataDisplayMode, adu.transactionId()) : "??";
+        const auto protocolId = adu.isValid() ? formatUInt16Value(_dataDisplayMode, adu.protocolId()): "??";
+        const auto length = adu.isValid() ? formatUInt16Value(_dataDisplayMode, adu.length()): "??";
         addItem(tr("<b>Transaction ID:</b> %1").arg(transactionId));
         addItem(tr("<b>Protocol ID:</b> %1").arg(protocolId));
         addItem(tr("<b>Length:</b> %1").arg(length));
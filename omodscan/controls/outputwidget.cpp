@@ -176,119 +176,153 @@ void OutputListModel::clear()
 
 ///
 /// \brief OutputListModel::update
+/// Formats every row again, e.g. after the display mode or byte order changed
 ///
 void OutputListModel::update()
 {
-    updateData(_lastData);
+    for(int i = 0; i < rowCount(); i++)
+        formatItem(i, _mapItems[i]);
+
+    emit dataChanged(index(0), index(rowCount() - 1), QVector<int>() << Qt::DisplayRole);
 }
 
 ///
 /// \brief OutputListModel::updateData
 /// \param data
+/// \param changed registers that differ from the shown block, empty when the whole block is new
 ///
-void OutputListModel::updateData(const QModbusDataUnit& data)
+void OutputListModel::updateData(const QModbusDataUnit& data, const QBitArray& changed)
 {
+    const bool sameBlock = _lastData.isValid() && data.isValid() &&
+                           _lastData.startAddress() == data.startAddress() &&
+                           _lastData.valueCount() == data.valueCount();
+
     _lastData = data;
+    if(changed.isEmpty() || !sameBlock)
+    {
+        update();
+        return;
+    }
 
+    const int rows = qMin(rowCount(), changed.size());
+
+    int first = -1;
+    int last = -1;
+    for(int i = 0; i < rows; i++)
+    {
+        if(!changed.testBit(i))
+            continue;
+
+        formatItem(i, _mapItems[i]);
+
+        if(first < 0) first = i;
+        last = i;
+    }
+
+    if(first >= 0)
+        emit dataChanged(index(first), index(last), QVector<int>() << Qt::DisplayRole);
+}
+
+///
+/// \brief OutputListModel::formatItem
+/// \param row
+/// \param itemData
+///
+void OutputListModel::formatItem(int row, ItemData& itemData) const
+{
     const auto mode = _parentWidget->dataDisplayMode();
     const auto pointType = _parentWidget->_displayDefinition.PointType;
     const auto byteOrder = _parentWidget->byteOrder();
     const auto codepage = _parentWidget->codepage();
 
-    for(int i = 0; i < rowCount(); i++)
+    const int i = row;
+    const auto value = _lastData.value(i);
+    itemData.Address = _parentWidget->_displayDefinition.PointAddress + i;
+
+    switch(mode)
     {
-        const auto value = _lastData.value(i);
+        case DataDisplayMode::Binary:
+            itemData.ValueStr = formatBinaryValue(pointType, value, byteOrder, itemData.Value);
+        break;
 
-        auto& itemData = _mapItems[i];
-        itemData.Address = _parentWidget->_displayDefinition.PointAddress + i;
+        case DataDisplayMode::UInt16:
+            itemData.ValueStr = formatUInt16Value(pointType, value, byteOrder, itemData.Value);
+        break;
 
-        switch(mode)
-        {
-            case DataDisplayMode::Binary:
-                itemData.ValueStr = formatBinaryValue(pointType, value, byteOrder, itemData.Value);
-            break;
+        case DataDisplayMode::Int16:
+            itemData.ValueStr = formatInt16Value(pointType, value, byteOrder, itemData.Value);
+        break;
 
-            case DataDisplayMode::UInt16:
-                itemData.ValueStr = formatUInt16Value(pointType, value, byteOrder, itemData.Value);
-            break;
+        case DataDisplayMode::Hex:
+            itemData.ValueStr = formatHexValue(pointType, value, byteOrder, itemData.Value);
+        break;
 
-            case DataDisplayMode::Int16:
-                itemData.ValueStr = formatInt16Value(pointType, value, byteOrder, itemData.Value);
-            break;
+        case DataDisplayMode::Ansi:
+            itemData.ValueStr = formatAnsiValue(pointType, value, byteOrder, codepage, itemData.Value);
+        break;
 
-            case DataDisplayMode::Hex:
-                itemData.ValueStr = formatHexValue(pointType, value, byteOrder, itemData.Value);
-            break;
+        case DataDisplayMode::FloatingPt:
+            itemData.ValueStr = formatFloatValue(pointType, value, _lastData.value(i+1), byteOrder,
+                                      (i%2) || (i+1>=rowCount()), itemData.Value);
+        break;
 
-            case DataDisplayMode::Ansi:
-                itemData.ValueStr = formatAnsiValue(pointType, value, byteOrder, codepage, itemData.Value);
-            break;
+        case DataDisplayMode::SwappedFP:
+            itemData.ValueStr = formatFloatValue(pointType, _lastData.value(i+1), value, byteOrder,
+                                      (i%2) || (i+1>=rowCount()), itemData.Value);
+        break;
+
+        case DataDisplayMode::DblFloat:
+            itemData.ValueStr = formatDoubleValue(pointType, value, _lastData.value(i+1), _lastData.value(i+2), _lastData.value(i+3),
+                                       byteOrder, (i%4) || (i+3>=rowCount()), itemData.Value);
+        break;
+
+        case DataDisplayMode::SwappedDbl:
+            itemData.ValueStr = formatDoubleValue(pointType, _lastData.value(i+3), _lastData.value(i+2), _lastData.value(i+1), value,
+                                       byteOrder, (i%4) || (i+3>=rowCount()), itemData.Value);
+        break;
 
-            case DataDisplayMode::FloatingPt:
-                itemData.ValueStr = formatFloatValue(pointType, value, _lastData.value(i+1), byteOrder,
+        case DataDisplayMode::Int32:
+            itemData.ValueStr = formatInt32Value(pointType, value, _lastData.value(i+1), byteOrder,
                                           (i%2) || (i+1>=rowCount()), itemData.Value);
-            break;
+        break;
 
-            case DataDisplayMode::SwappedFP:
-                itemData.ValueStr = formatFloatValue(pointType, _lastData.value(i+1), value, byteOrder,
+        case DataDisplayMode::SwappedInt32:
+            itemData.ValueStr = formatInt32Value(pointType, _lastData.value(i+1), value, byteOrder,
                                           (i%2) || (i+1>=rowCount()), itemData.Value);
-            break;
 
-            case DataDisplayMode::DblFloat:
-                itemData.ValueStr = formatDoubleValue(pointType, value, _lastData.value(i+1), _lastData.value(i+2), _lastData.value(i+3),
-                                           byteOrder, (i%4) || (i+3>=rowCount()), itemData.Value);
-            break;
+        break;
 
-            case DataDisplayMode::SwappedDbl:
-                itemData.ValueStr = formatDoubleValue(pointType, _lastData.value(i+3), _lastData.value(i+2), _lastData.value(i+1), value,
-                                           byteOrder, (i%4) || (i+3>=rowCount()), itemData.Value);
-            break;
+        case DataDisplayMode::UInt32:
+            itemData.ValueStr = formatUInt32Value(pointType, value, _lastData.value(i+1), byteOrder,
+                                          (i%2) || (i+1>=rowCount()), itemData.Value);
+        break;
 
-            case DataDisplayMode::Int32:
-                itemData.ValueStr = formatInt32Value(pointType, value, _lastData.value(i+1), byteOrder,
-                                              (i%2) || (i+1>=rowCount()), itemData.Value);
+        case DataDisplayMode::SwappedUInt32:
+            itemData.ValueStr = formatUInt32Value(pointType, _lastData.value(i+1), value, byteOrder,
+                                          (i%2) || (i+1>=rowCount()), itemData.Value);
+        break;
+
+        case DataDisplayMode::Int64:
+            itemData.ValueStr = formatInt64Value(pointType, value, _lastData.value(i+1), _lastData.value(i+2), _lastData.value(i+3),
+                                       byteOrder, (i%4) || (i+3>=rowCount()), itemData.Value);
             break;
 
-            case DataDisplayMode::SwappedInt32:
-                itemData.ValueStr = formatInt32Value(pointType, _lastData.value(i+1), value, byteOrder,
-                                              (i%2) || (i+1>=rowCount()), itemData.Value);
+        case DataDisplayMode::SwappedInt64:
+            itemData.ValueStr = formatInt64Value(pointType, _lastData.value(i+3), _lastData.value(i+2), _lastData.value(i+1), value,
+                                                 byteOrder, (i%4) || (i+3>=rowCount()), itemData.Value);
 
             break;
 
-            case DataDisplayMode::UInt32:
-                itemData.ValueStr = formatUInt32Value(pointType, value, _lastData.value(i+1), byteOrder,
-                                              (i%2) || (i+1>=rowCount()), itemData.Value);
+        case DataDisplayMode::UInt64:
+            itemData.ValueStr = formatUInt64Value(pointType, value, _lastData.value(i+1), _lastData.value(i+2), _lastData.value(i+3),
+                                       byteOrder, (i%4) || (i+3>=rowCount()), itemData.Value);
             break;
 
-            case DataDisplayMode::SwappedUInt32:
-                itemData.ValueStr = formatUInt32Value(pointType, _lastData.value(i+1), value, byteOrder,
-                                              (i%2) || (i+1>=rowCount()), itemData.Value);
+        case DataDisplayMode::SwappedUInt64:
+            itemData.ValueStr = formatUInt64Value(pointType, _lastData.value(i+3), _lastData.value(i+2), _lastData.value(i+1), value,
+                                                  byteOrder, (i%4) || (i+3>=rowCount()), itemData.Value);
             break;
-
-            case DataDisplayMode::Int64:
-                itemData.ValueStr = formatInt64Value(pointType, value, _lastData.value(i+1), _lastData.value(i+2), _lastData.value(i+3),
-                                           byteOrder, (i%4) || (i+3>=rowCount()), itemData.Value);
-                break;
-
-            case DataDisplayMode::SwappedInt64:
-                itemData.ValueStr = formatInt64Value(pointType, _lastData.value(i+3), _lastData.value(i+2), _lastData.value(i+1), value,
-                                                     byteOrder, (i%4) || (i+3>=rowCount()), itemData.Value);
-
-                break;
-
-            case DataDisplayMode::UInt64:
-                itemData.ValueStr = formatUInt64Value(pointType, value, _lastData.value(i+1), _lastData.value(i+2), _lastData.value(i+3),
-                                           byteOrder, (i%4) || (i+3>=rowCount()), itemData.Value);
-                break;
-
-            case DataDisplayMode::SwappedUInt64:
-                itemData.ValueStr = formatUInt64Value(pointType, _lastData.value(i+3), _lastData.value(i+2), _lastData.value(i+1), value,
-                                                      byteOrder, (i%4) || (i+3>=rowCount()), itemData.Value);
-                break;
-        }
     }
-
-    emit dataChanged(index(0), index(rowCount() - 1), QVector<int>() << Qt::DisplayRole);
 }
 
 ///
@@ -644,9 +678,9 @@ void OutputWidget::updateTraffic(const QModbusResponse& response, int deviceId,
 ///
 /// \brief OutputWidget::updateData
 ///
-void OutputWidget::updateData(const QModbusDataUnit& data)
+void OutputWidget::updateData(const QModbusDataUnit& data, const QBitArray& changed)
 {
-    _listModel->updateData(data);
+    _listModel->updateData(data, changed);
 }
 
 ///
@@ -7,6 +7,7 @@
 #include <QListWidgetItem>
 #include <QModbusReply>
 #include <QPainter>
+#include <QBitArray>
 #include <QStyledItemDelegate>
 #include "enums.h"
 #include "modbusmessage.h"
@@ -41,7 +42,7 @@ public:
 
     void clear();
     void update();
-    void updateData(const QModbusDataUnit& data);
+    void updateData(const QModbusDataUnit& data, const QBitArray& changed = QBitArray());
 
     QModelIndex find(QModbusDataUnit::RegisterType type, quint16 addr) const;
 
@@ -55,6 +56,8 @@ private:
         bool Simulated = false;
     };
 
+    void formatItem(int row, ItemData& itemData) const;
+
     OutputWidget* _parentWidget;
     QModbusDataUnit _lastData;
     QIcon _iconPointGreen;
@@ -122,7 +125,7 @@ public:
 
     void updateTraffic(const QModbusRequest& request, int server, int transactionId);
     void updateTraffic(const QModbusResponse& response, int server, int transactionId);
-    void updateData(const QModbusDataUnit& data);
+    void updateData(const QModbusDataUnit& data, const QBitArray& changed = QBitArray());
 
     AddressDescriptionMap descriptionMap() const;
     void setDescription(QModbusDataUnit::RegisterType type, quint16 addr, const QString& desc);
@@ -1,6 +1,11 @@
+#include <QHelpEvent>
 #include "statisticwidget.h"
 #include "ui_statisticwidget.h"
 
+namespace {
+const int RefreshInterval = 100;
+}
+
 ///
 /// \brief StatisticWidget::StatisticWidget
 /// \param parent
@@ -8,10 +13,18 @@
 StatisticWidget::StatisticWidget(QWidget *parent) :
       QWidget(parent)
     , ui(new Ui::StatisticWidget)
-    ,_numberOfPolls(0)
-    ,_validSlaveResponses(0)
 {
     ui->setupUi(this);
+
+    _refreshTimer.setSingleShot(true);
+    _refreshTimer.setInterval(RefreshInterval);
+    connect(&_refreshTimer, &QTimer::timeout, this, &StatisticWidget::updateStatistic);
+
+    ui->labelNumberOfPolls->installEventFilter(this);
+    ui->labelResponseTime->installEventFilter(this);
+    ui->labelErrors->installEventFilter(this);
+
+    updateStatistic();
 }
 
 ///
@@ -31,45 +44,48 @@ void StatisticWidget::changeEvent(QEvent* event)
     if (event->type() == QEvent::LanguageChange)
     {
         ui->retranslateUi(this);
+        updateStatistic();
     }
 
     QWidget::changeEvent(event);
 }
 
 ///
-/// \brief StatisticWidget::increaseNumberOfPolls
+/// \brief StatisticWidget::eventFilter
+/// Sets the tooltip of a label just before it is shown
+/// \param watched
+/// \param event
+/// \return
 ///
-void StatisticWidget::increaseNumberOfPolls()
+bool StatisticWidget::eventFilter(QObject* watched, QEvent* event)
 {
-    _numberOfPolls++;
-    updateStatistic();
+    if(event->type() == QEvent::ToolTip)
+    {
+        auto label = qobject_cast<QWidget*>(watched);
+        if(label) label->setToolTip(toolTip(watched));
+    }
 
-    emit numberOfPollsChanged(_numberOfPolls);
+    return QWidget::eventFilter(watched, event);
 }
 
 ///
-/// \brief StatisticWidget::increaseValidSlaveResponses
+/// \brief StatisticWidget::setPollTask
+/// \param task the counters are read from it on every refresh
 ///
-void StatisticWidget::increaseValidSlaveResponses()
+void StatisticWidget::setPollTask(const PollTask* task)
 {
-   _validSlaveResponses++;
-   updateStatistic();
-
-   emit validSlaveResposesChanged(_validSlaveResponses);
+    _pollTask = task;
+    updateStatistic();
 }
 
 ///
-/// \brief StatisticWidget::resetCtrls
+/// \brief StatisticWidget::refresh
+/// Updates the labels at most once per refresh interval
 ///
-void StatisticWidget::resetCtrs()
+void StatisticWidget::refresh()
 {
-    _numberOfPolls = 0;
-    _validSlaveResponses = 0;
-
-    updateStatistic();
-
-    emit numberOfPollsChanged(_numberOfPolls);
-    emit validSlaveResposesChanged(_validSlaveResponses);
+    if(!_refreshTimer.isActive())
+        _refreshTimer.start();
 }
 
 ///
@@ -77,7 +93,6 @@ void StatisticWidget::resetCtrs()
 ///
 void StatisticWidget::on_pushButtonResetCtrs_clicked()
 {
-    resetCtrs();
     emit ctrsReseted();
 }
 
@@ -86,6 +101,51 @@ void StatisticWidget::on_pushButtonResetCtrs_clicked()
 ///
 void StatisticWidget::updateStatistic()
 {
-    ui->labelNumberOfPolls->setText(QString(tr("Number of Polls: %1")).arg(_numberOfPolls));
-    ui->labelValidSlaveResponses->setText(QString(tr("Valid Slave Responses: %1")).arg(_validSlaveResponses));
+    static const ModbusStatistics empty;
+    const auto& statistics = _pollTask ? _pollTask->statistics() : empty;
+
+    ui->labelNumberOfPolls->setText(QString(tr("Number of Polls: %1")).arg(_pollTask ? _pollTask->numberOfPolls() : 0));
+    ui->labelValidSlaveResponses->setText(QString(tr("Valid Slave Responses: %1")).arg(_pollTask ? _pollTask->validSlaveResponses() : 0));
+
+    const auto& latency = statistics.Latency;
+    ui->labelResponseTime->setText(QString(tr("Response Time: %1 / %2 / %3 / %4 ms")).arg(formatLatency(latency.percentile(50)),
+                                                                                         formatLatency(latency.percentile(95)),
+                                                                                         formatLatency(latency.percentile(99)),
+                                                                                         formatLatency(latency.max())));
+
+    ui->labelErrors->setText(QString(tr("Timeouts: %1, Exceptions: %2, Invalid: %3")).arg(QString::number(statistics.Timeouts),
+                                                                                         QString::number(statistics.Exceptions),
+                                                                                         QString::number(statistics.InvalidResponses)));
+}
+
+///
+/// \brief StatisticWidget::toolTip
+/// \param label
+/// \return
+///
+QString StatisticWidget::toolTip(QObject* label) const
+{
+    if(!_pollTask)
+        return QString();
+
+    if(label == ui->labelNumberOfPolls)
+    {
+        const auto& jitter = _pollTask->scanJitter();
+        return tr("Scan rate: %1 polls/s, jitter p50 / p99: %2 / %3 ms, missed deadlines: %4, skipped while unresponsive: %5").arg(QString::number(_pollTask->achievedRate(), 'f', 1),
+                                                                                                                                formatLatency(jitter.percentile(50)),
+                                                                                                                                formatLatency(jitter.percentile(99)),
+                                                                                                                                QString::number(_pollTask->missedDeadlines()),
+                                                                                                                                QString::number(_pollTask->skippedPolls()));
+    }
+
+    const auto& statistics = _pollTask->statistics();
+    if(label == ui->labelResponseTime)
+        return tr("p50 / p95 / p99 / max of %1 responses").arg(statistics.Latency.count());
+
+    if(label == ui->labelErrors)
+        return tr("Timeouts: %1%, Exceptions: %2%, Invalid (CRC) Responses: %3%").arg(QString::number(statistics.rate(statistics.Timeouts), 'f', 1),
+                                                                                       QString::number(statistics.rate(statistics.Exceptions), 'f', 1),
+                                                                                       QString::number(statistics.rate(statistics.InvalidResponses), 'f', 1));
+
+    return QString();
 }
@@ -1,7 +1,10 @@
 #ifndef STATISTICWIDGET_H
 #define STATISTICWIDGET_H
 
+#include <QTimer>
 #include <QWidget>
+#include <QPointer>
+#include "polltask.h"
 
 namespace Ui {
 class StatisticWidget;
@@ -9,6 +12,8 @@ class StatisticWidget;
 
 ///
 /// \brief The StatisticWidget class
+/// View of a poll task's counters. Updates are throttled and the percentile tooltips
+/// are computed only when shown, so a fast scan rate does not relabel the widget on every poll
 ///
 class StatisticWidget : public QWidget
 {
@@ -18,33 +23,29 @@ public:
     explicit StatisticWidget(QWidget *parent = nullptr);
     ~StatisticWidget();
 
-    uint numberOfPolls() const { return _numberOfPolls; }
-    uint validSlaveResposes() const { return _validSlaveResponses; }
-
-    void increaseNumberOfPolls();
-    void increaseValidSlaveResponses();
-    void resetCtrs();
+    void setPollTask(const PollTask* task);
+    void refresh();
 
 signals:
-    void numberOfPollsChanged(uint value);
-    void validSlaveResposesChanged(uint value);
     void ctrsReseted();
 
 protected:
     void changeEvent(QEvent* event) override;
+    bool eventFilter(QObject* watched, QEvent* event) override;
 
 private slots:
     void on_pushButtonResetCtrs_clicked();
 
 private:
     void updateStatistic();
+    QString toolTip(QObject* label) const;
 
 private:
     Ui::StatisticWidget *ui;
 
 private:
-    uint _numberOfPolls;
-    uint _validSlaveResponses;
+    QPointer<const PollTask> _pollTask;
+    QTimer _refreshTimer;
 };
 
 #endif // STATISTICWIDGET_H
@@ -0,0 +1,11 @@
+# Links the core library, it is built first by the top-level project
+
+INCLUDEPATH += $$PWD/..
+
+QT += network serialbus serialport
+
+CORE_LIB_DIR = $$shadowed($$PWD)
+LIBS += -L$$CORE_LIB_DIR -lomodscan-core
+
+win32-msvc*: PRE_TARGETDEPS += $$CORE_LIB_DIR/omodscan-core.lib
+else: PRE_TARGETDEPS += $$CORE_LIB_DIR/libomodscan-core.a
@@ -0,0 +1,14 @@
+TEMPLATE = lib
+TARGET = omodscan-core
+
+QT = core network serialbus serialport
+
+greaterThan(QT_MAJOR_VERSION, 5) {
+    QT += core5compat
+}
+
+CONFIG += c++17 staticlib
+CONFIG -= debug_and_release
+CONFIG -= debug_and_release_target
+
+include(sources.pri)
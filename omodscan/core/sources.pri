@@ -0,0 +1,16 @@
+# Polling engine: the client, the poll tasks, their scheduler and the statistics, without QtGui or QtWidgets.
+# Compiled once by core.pro, the GUI, the CLI and the tests link it through core.pri
+
+INCLUDEPATH += $$PWD/..
+
+SOURCES += \
+    $$PWD/../modbusclient.cpp \
+    $$PWD/../modbusstatistics.cpp \
+    $$PWD/../pollscheduler.cpp \
+    $$PWD/../polltask.cpp
+
+HEADERS += \
+    $$PWD/../modbusclient.h \
+    $$PWD/../modbusstatistics.h \
+    $$PWD/../pollscheduler.h \
+    $$PWD/../polltask.h
@@ -34,19 +34,26 @@ void DataSimulator::startSimulation(DataDisplayMode mode, QModbusDataUnit::Regis
     {
         case SimulationMode::Increment:
             value = params.IncrementParams.Range.from();
-            emit dataSimulated(mode, type, addr, deviceId, value);
+            emit dataSimulated({ { mode, type, addr, deviceId, value } });
         break;
 
         case SimulationMode::Decrement:
             value = params.DecrementParams.Range.to();
-            emit dataSimulated(mode, type, addr, deviceId, value);
+            emit dataSimulated({ { mode, type, addr, deviceId, value } });
         break;
 
         default:
         break;
     }
 
-    _simulationMap.insert({ type, addr, deviceId}, { mode, params, value });
+    const SimulationKey key = { type, addr, deviceId };
+    const auto it = _simulationMap.constFind(key);
+    if(it != _simulationMap.cend())
+        unschedule(*it);
+
+    const auto generation = ++_generation;
+    const auto due = schedule(key, params.Interval, generation);
+    _simulationMap.insert(key, { mode, params, value, generation, due });
     resumeSimulations();
 
     emit simulationStarted(type, addr, deviceId);
@@ -59,7 +66,12 @@ void DataSimulator::startSimulation(DataDisplayMode mode, QModbusDataUnit::Regis
 ///
 void DataSimulator::stopSimulation(QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId)
 {
-    _simulationMap.remove({ type, addr, deviceId});
+    const auto it = _simulationMap.find({ type, addr, deviceId });
+    if(it != _simulationMap.end())
+    {
+        unschedule(*it);
+        _simulationMap.erase(it);
+    }
     emit simulationStopped(type, addr, deviceId);
 }
 
@@ -70,6 +82,8 @@ void DataSimulator::stopSimulations()
 {
     pauseSimulations();
     _simulationMap.clear();
+    for(auto&& slot : _wheel)
+        slot.clear();
 }
 
 ///
@@ -95,12 +109,10 @@ void DataSimulator::resumeSimulations()
 void DataSimulator::restartSimulations()
 {
     pauseSimulations();
-    for(auto&& key : _simulationMap.keys())
-    {
-        const auto mode = _simulationMap[key].Mode;
-        const auto params = _simulationMap[key].Params;
-        startSimulation(mode, key.Type, key.Address,  key.DeviceId, params);
-    }
+
+    const auto simulations = _simulationMap;
+    for(auto it = simulations.cbegin(); it != simulations.cend(); ++it)
+        startSimulation(it->Mode, it.key().Type, it.key().Address, it.key().DeviceId, it->Params);
 }
 
 ///
@@ -122,49 +134,112 @@ ModbusSimulationParams DataSimulator::simulationParams(QModbusDataUnit::Register
 ModbusSimulationMap DataSimulator::simulationMap(quint8 deviceId) const
 {
     ModbusSimulationMap map;
-    for(auto&& key : _simulationMap.keys())
-        if(key.DeviceId == deviceId)
-            map[{key.Type, key.Address}] = _simulationMap[key].Params;
+    for(auto it = _simulationMap.cbegin(); it != _simulationMap.cend(); ++it)
+        if(it.key().DeviceId == deviceId)
+            map[{it.key().Type, it.key().Address}] = it->Params;
 
     return map;
 }
 
+///
+/// \brief DataSimulator::schedule
+/// The next due tick stays a multiple of the interval, as with the former modulo check
+/// \param key
+/// \param interval in ticks
+/// \param generation tells the entry of a simulation apart from one of its earlier starts
+/// \return the due tick
+///
+quint32 DataSimulator::schedule(const SimulationKey& key, quint32 interval, quint32 generation)
+{
+    interval = qMax(interval, 1u);
+    const quint32 due = (_elapsed / interval + 1) * interval;
+    _wheel[due % WheelSize].push_back({ key, due, generation });
+    return due;
+}
+
+///
+/// \brief DataSimulator::unschedule
+/// Removes the wheel entry of a simulation that is stopped or started again, so slots only hold live entries
+/// \param sim
+///
+void DataSimulator::unschedule(const SimulationParams& sim)
+{
+    auto& slot = _wheel[sim.Due % WheelSize];
+    for(int i = 0; i < slot.size(); i++)
+    {
+        if(slot[i].Generation == sim.Generation)
+        {
+            slot.remove(i);
+            break;
+        }
+    }
+}
+
 ///
 /// \brief DataSimulator::on_timeout
+/// Only the slot of the current tick is visited. Entries due in a later round of the wheel stay in it
+/// and the fired ones move on by their interval
 ///
 void DataSimulator::on_timeout()
 {
     _elapsed++;
-    for(auto&& key : _simulationMap.keys())
+
+    auto& slot = _wheel[_elapsed % WheelSize];
+    if(slot.isEmpty())
+        return;
+
+    QVector<WheelEntry> entries;
+    entries.swap(slot);
+
+    QVector<SimulatedValue> values;
+    for(auto&& entry : entries)
     {
-        const auto mode = _simulationMap[key].Mode;
-        const auto params = _simulationMap[key].Params;
-        const auto interval = params.Interval;
+        if(entry.Due != _elapsed)
+        {
+            slot.push_back(entry);
+            continue;
+        }
 
-        if(_elapsed % interval) continue;
+        const auto it = _simulationMap.find(entry.Key);
+        if(it == _simulationMap.end() || it->Generation != entry.Generation)
+            continue;
+
+        const auto& params = it->Params;
+        auto mode = it->Mode;
+        auto&& value = it->CurrentValue;
 
         switch(params.Mode)
         {
             case SimulationMode::Random:
-                randomSimulation(mode, key.Type, key.Address, key.DeviceId, params.RandomParams);
+                randomSimulation(mode, entry.Key.Type, value, params.RandomParams);
             break;
 
             case SimulationMode::Increment:
-                incrementSimulation(mode, key.Type, key.Address, key.DeviceId, params.IncrementParams);
+                incrementSimulation(mode, value, params.IncrementParams);
             break;
 
             case SimulationMode::Decrement:
-                decrementSimailation(mode, key.Type, key.Address, key.DeviceId, params.DecrementParams);
+                decrementSimailation(mode, value, params.DecrementParams);
             break;
 
             case SimulationMode::Toggle:
-                toggleSimulation(key.Type, key.Address, key.DeviceId);
+                toggleSimulation(value);
+                mode = DataDisplayMode::Binary;
             break;
 
             default:
             break;
         }
+
+        if(value.isValid())
+            values.push_back({ mode, entry.Key.Type, entry.Key.Address, entry.Key.DeviceId, value });
+
+        it->Due = entry.Due + qMax(params.Interval, 1u);
+        _wheel[it->Due % WheelSize].push_back({ entry.Key, it->Due, entry.Generation });
     }
+
+    if(!values.isEmpty())
+        emit dataSimulated(values);
 }
 
 template<typename T>
@@ -183,13 +258,11 @@ T generateRandom(const QRange<double>& range)
 /// \brief DataSimulator::randomSimulation
 /// \param mode
 /// \param type
-/// \param addr
-/// \param order
+/// \param value
 /// \param params
 ///
-void DataSimulator::randomSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId, const RandomSimulationParams& params)
+void DataSimulator::randomSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, QVariant& value, const RandomSimulationParams& params)
 {
-    auto&& value = _simulationMap[{ type, addr, deviceId}].CurrentValue;
     switch(type)
     {
         case QModbusDataUnit::Coils:
@@ -244,9 +317,6 @@ void DataSimulator::randomSimulation(DataDisplayMode mode, QModbusDataUnit::Regi
         default:
         break;
     }
-
-    if(value.isValid())
-        emit dataSimulated(mode, type, addr, deviceId, value);
 }
 
 template<typename T>
@@ -260,13 +330,11 @@ T incrementValue(T value, T step, const QRange<double>& range)
 ///
 /// \brief DataSimulator::incrementSimulation
 /// \param mode
-/// \param type
-/// \param addr
+/// \param value
 /// \param params
 ///
-void DataSimulator::incrementSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId, const IncrementSimulationParams& params)
+void DataSimulator::incrementSimulation(DataDisplayMode mode, QVariant& value, const IncrementSimulationParams& params)
 {
-    auto&& value = _simulationMap[{ type, addr, deviceId}].CurrentValue;
     switch(mode)
     {
         case DataDisplayMode::Int16:
@@ -310,9 +378,6 @@ void DataSimulator::incrementSimulation(DataDisplayMode mode, QModbusDataUnit::R
             value = incrementValue<quint64>(value.toULongLong(), params.Step, params.Range);
         break;
     }
-
-    if(value.isValid())
-        emit dataSimulated(mode, type, addr, deviceId, value);
 }
 
 template<typename T>
@@ -326,14 +391,11 @@ T decrementValue(T value, T step, const QRange<double>& range)
 ///
 /// \brief DataSimulator::decrementSimailation
 /// \param mode
-/// \param type
-/// \param addr
-/// \param order
+/// \param value
 /// \param params
 ///
-void DataSimulator::decrementSimailation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId, const DecrementSimulationParams& params)
+void DataSimulator::decrementSimailation(DataDisplayMode mode, QVariant& value, const DecrementSimulationParams& params)
 {
-    auto&& value = _simulationMap[{ type, addr, deviceId}].CurrentValue;
     switch(mode)
     {
         case DataDisplayMode::Int16:
@@ -377,20 +439,13 @@ void DataSimulator::decrementSimailation(DataDisplayMode mode, QModbusDataUnit::
             value = decrementValue<quint64>(value.toULongLong(), params.Step, params.Range);
         break;
     }
-
-    if(value.isValid())
-        emit dataSimulated(mode, type, addr, deviceId, value);
 }
 
 ///
 /// \brief DataSimulator::toggleSimulation
-/// \param type
-/// \param addr
+/// \param value
 ///
-void DataSimulator::toggleSimulation(QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId)
+void DataSimulator::toggleSimulation(QVariant& value)
 {
-    auto&& value = _simulationMap[{ type, addr, deviceId}].CurrentValue;
     value = !value.toBool();
-
-    emit dataSimulated(DataDisplayMode::Binary, type, addr, deviceId, value);
 }
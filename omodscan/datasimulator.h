@@ -1,14 +1,30 @@
 #ifndef DATASIMULATOR_H
 #define DATASIMULATOR_H
 
+#include <array>
 #include <QTimer>
+#include <QVector>
 #include <QModbusDataUnit>
 #include "modbussimulationparams.h"
 
 typedef QMap<QPair<QModbusDataUnit::RegisterType, quint16>, ModbusSimulationParams> ModbusSimulationMap;
 
+///
+/// \brief The SimulatedValue struct
+///
+struct SimulatedValue
+{
+    DataDisplayMode Mode;
+    QModbusDataUnit::RegisterType Type;
+    quint16 Address;
+    quint8 DeviceId;
+    QVariant Value;
+};
+
 ///
 /// \brief The DataSimulator class
+/// Simulations wait in a hashed timing wheel by their next due tick, so a tick only visits the
+/// simulations falling into its slot. The values of one tick are emitted as a single batch
 ///
 class DataSimulator : public QObject
 {
@@ -32,16 +48,16 @@ public:
 signals:
     void simulationStarted(QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId);
     void simulationStopped(QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId);
-    void dataSimulated(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId, QVariant value);
+    void dataSimulated(const QVector<SimulatedValue>& values);
 
 private slots:
     void on_timeout();
 
 private:
-    void randomSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId, const RandomSimulationParams& params);
-    void incrementSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId, const IncrementSimulationParams& params);
-    void decrementSimailation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId, const DecrementSimulationParams& params);
-    void toggleSimulation(QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId);
+    void randomSimulation(DataDisplayMode mode, QModbusDataUnit::RegisterType type, QVariant& value, const RandomSimulationParams& params);
+    void incrementSimulation(DataDisplayMode mode, QVariant& value, const IncrementSimulationParams& params);
+    void decrementSimailation(DataDisplayMode mode, QVariant& value, const DecrementSimulationParams& params);
+    void toggleSimulation(QVariant& value);
 
 private:
     QTimer _timer;
@@ -52,6 +68,8 @@ private:
         DataDisplayMode Mode;
         ModbusSimulationParams Params;
         QVariant CurrentValue;
+        quint32 Generation = 0;
+        quint32 Due = 0;    ///< tick of its wheel entry
     };
     struct SimulationKey{
         QModbusDataUnit::RegisterType Type;
@@ -63,6 +81,19 @@ private:
         }
     };
 
+    struct WheelEntry {
+        SimulationKey Key;
+        quint32 Due;
+        quint32 Generation;
+    };
+
+    quint32 schedule(const SimulationKey& key, quint32 interval, quint32 generation);
+    void unschedule(const SimulationParams& sim);
+
+    static constexpr int WheelSize = 64;
+    std::array<QVector<WheelEntry>, WheelSize> _wheel;
+    quint32 _generation = 0;
+
     QMap<SimulationKey, SimulationParams> _simulationMap;
 };
 
@@ -2,9 +2,50 @@
 #include <QtWidgets>
 #include <QtPrintSupport>
 #include "modbuslimits.h"
+#include "parquetwriter.h"
 #include "dialogaddressscan.h"
 #include "ui_dialogaddressscan.h"
 
+///
+/// \brief formatScanValue
+/// \param data
+/// \param idx
+/// \param hexView
+/// \param order
+/// \return
+///
+static QString formatScanValue(const ModbusDataUnit& data, int idx, bool hexView, ByteOrder order)
+{
+    if(!data.hasValue(idx))
+        return "-";
+
+    QVariant outValue;
+    const auto value = data.value(idx);
+    const auto pointType = data.registerType();
+    auto result = hexView ? formatHexValue(pointType, value, order, outValue) :
+                            formatUInt16Value(pointType, value, order, outValue);
+
+    return result.remove('<').remove('>');
+}
+
+///
+/// \brief formatScanRowHeader
+/// \param data
+/// \param row
+/// \param columns
+/// \param base
+/// \return
+///
+static QString formatScanRowHeader(const ModbusDataUnit& data, int row, int columns, AddressBase base)
+{
+    const auto length = data.valueCount();
+    const auto pointType = data.registerType();
+    const auto pointAddress = data.startAddress() + (base == AddressBase::Base0 ? 0 : 1);
+    const auto addressFrom = pointAddress + row * columns;
+    const auto addressTo = pointAddress + qMin<quint16>(length - 1, (row + 1) * columns - 1);
+    return QString("%1-%2").arg(formatAddress(pointType, addressFrom, false), formatAddress(pointType, addressTo, false));
+}
+
 ///
 /// \brief TableViewItemModel::TableViewItemModel
 /// \param parent
@@ -53,15 +94,7 @@ QVariant TableViewItemModel::data(const QModelIndex &index, int role) const
             return formatAddress(_data.registerType(), getAddress(idx), false);
 
         case Qt::DisplayRole:
-        {
-            QVariant outValue;
-            const auto value = _data.value(idx);
-            const auto pointType = _data.registerType();
-            auto result = _hexView ? formatHexValue(pointType, value, _byteOrder, outValue) :
-                                    formatUInt16Value(pointType, value, _byteOrder, outValue);
-
-            return _data.hasValue(idx) ? result.remove('<').remove('>') : "-";
-        }
+            return formatScanValue(_data, idx, _hexView, _byteOrder);
 
         case Qt::TextAlignmentRole:
             return Qt::AlignCenter;
@@ -102,11 +135,7 @@ bool TableViewItemModel::setData(const QModelIndex &index, const QVariant &value
             const auto idx = index.row() * _columns + index.column();
             if(value.userType() == qMetaTypeId<QVector<quint16>>())
             {
-                const auto values = value.value<QVector<quint16>>();
-                for(int i = 0; i < values.size(); i++)
-                    _data.setValue(idx + i, values.at(i));
-
-                emit dataChanged(index, this->index(rowCount() - 1, columnCount() - 1), QVector<int>() << role);
+                updateValues(_data.startAddress() + idx, value.value<QVector<quint16>>());
             }
             else
             {
@@ -143,14 +172,7 @@ QVariant TableViewItemModel::headerData(int section, Qt::Orientation orientation
                     return QString("+%1").arg(section);
 
                 case Qt::Vertical:
-                {
-                    const auto length = _data.valueCount();
-                    const auto pointType = _data.registerType();
-                    const auto pointAddress = getAddress(0);
-                    const auto addressFrom = pointAddress + section * _columns;
-                    const auto addressTo = pointAddress + qMin<quint16>(length - 1, (section + 1) * _columns - 1);
-                    return QString("%1-%2").arg(formatAddress(pointType, addressFrom, false), formatAddress(pointType, addressTo, false));
-                }
+                    return formatScanRowHeader(_data, section, _columns, _addressBase);
             }
         break;
     }
@@ -191,6 +213,44 @@ void TableViewItemModel::setAddressBase(AddressBase base)
     _addressBase = base;
 }
 
+///
+/// \brief TableViewItemModel::addressIndex
+/// \param address zero-based modbus address
+/// \return
+///
+QModelIndex TableViewItemModel::addressIndex(int address) const
+{
+    const auto idx = address - _data.startAddress();
+    if(idx < 0 || idx >= (int)_data.valueCount())
+        return QModelIndex();
+
+    return index(idx / _columns, idx % _columns);
+}
+
+///
+/// \brief TableViewItemModel::updateValues
+/// \param address zero-based modbus address of the first value
+/// \param values
+///
+void TableViewItemModel::updateValues(int address, const QVector<quint16>& values)
+{
+    const int first = qMax<int>(address, _data.startAddress());
+    const int last = qMin<int>(address + values.size(), _data.startAddress() + _data.valueCount()) - 1;
+    if(first > last)
+        return;
+
+    _data.setValues(address - _data.startAddress(), values);
+
+    auto topLeft = addressIndex(first);
+    auto bottomRight = addressIndex(last);
+    if(topLeft.row() != bottomRight.row())
+    {
+        topLeft = index(topLeft.row(), 0);
+        bottomRight = index(bottomRight.row(), _columns - 1);
+    }
+    emit dataChanged(topLeft, bottomRight, QVector<int>() << Qt::DisplayRole);
+}
+
 ///
 /// \brief TableViewItemModel::getAddress
 /// \param idx
@@ -356,6 +416,24 @@ DialogAddressScan::DialogAddressScan(const DisplayDefinition& dd, DataDisplayMod
     ui->comboBoxByteOrder->setCurrentByteOrder(order);
     ui->info->setShowTimestamp(false);
 
+    ui->comboBoxFindType->addItem(tr("Unsigned 16-bit Integer"), QVariant::fromValue(DataDisplayMode::UInt16));
+    ui->comboBoxFindType->addItem(tr("16-bit Integer"), QVariant::fromValue(DataDisplayMode::Int16));
+    ui->comboBoxFindType->addItem(tr("32-bit Integer"), QVariant::fromValue(DataDisplayMode::Int32));
+    ui->comboBoxFindType->addItem(tr("Swapped 32-bit Integer"), QVariant::fromValue(DataDisplayMode::SwappedInt32));
+    ui->comboBoxFindType->addItem(tr("Unsigned 32-bit Integer"), QVariant::fromValue(DataDisplayMode::UInt32));
+    ui->comboBoxFindType->addItem(tr("Swapped Unsigned 32-bit Integer"), QVariant::fromValue(DataDisplayMode::SwappedUInt32));
+    ui->comboBoxFindType->addItem(tr("Float"), QVariant::fromValue(DataDisplayMode::FloatingPt));
+    ui->comboBoxFindType->addItem(tr("Swapped Float"), QVariant::fromValue(DataDisplayMode::SwappedFP));
+    ui->comboBoxFindType->addItem(tr("Double"), QVariant::fromValue(DataDisplayMode::DblFloat));
+    ui->comboBoxFindType->addItem(tr("Swapped Double"), QVariant::fromValue(DataDisplayMode::SwappedDbl));
+    ui->comboBoxFindType->setCurrentIndex(0);
+
+    ui->lineEditFindMask->setInputMode(NumericLineEdit::HexMode);
+    ui->lineEditFindMask->setInputRange(0, 0xFFFF);
+    ui->lineEditFindMask->setValue(0xFFFF);
+    ui->lineEditFindMask->setToolTip(tr("Applied to every register as received, before the byte order"));
+    updateFindInputMode();
+
     auto dispatcher = QAbstractEventDispatcher::instance();
     connect(dispatcher, &QAbstractEventDispatcher::awake, this, &DialogAddressScan::on_awake);
 
@@ -372,6 +450,13 @@ DialogAddressScan::DialogAddressScan(const DisplayDefinition& dd, DataDisplayMod
 ///
 DialogAddressScan::~DialogAddressScan()
 {
+    if(_exportThread)
+    {
+        _exportThread->requestInterruption();
+        _exportThread->quit();
+        _exportThread->wait();
+    }
+
     delete ui;
 }
 
@@ -397,8 +482,9 @@ void DialogAddressScan::on_awake()
     ui->lineEditSlaveAddress->setEnabled(!_scanning);
     ui->spinBoxRegsOnQuery->setEnabled(!_scanning);
     ui->comboBoxPointType->setEnabled(!_scanning);
-    ui->pushButtonExport->setEnabled(_finished);
-    ui->progressBar->setVisible(_scanning);
+    ui->pushButtonExport->setEnabled(_finished && !_exportThread);
+    ui->progressBar->setVisible(_scanning || _exportThread);
+    ui->pushButtonScan->setEnabled(!_exportThread);
     ui->pushButtonScan->setText(_scanning ? tr("Stop") : tr("Scan"));
     ui->pushButtonFind->setEnabled(ui->tableView->model()->rowCount() > 0);
 }
@@ -421,7 +507,7 @@ void DialogAddressScan::on_checkBoxHexView_toggled(bool on)
     ((TableViewItemModel*)ui->tableView->model())->setHexView(on);
     ((LogViewProxyModel*)ui->logView->model())->setHexView(on);
     ui->info->setDataDisplayMode(on ? DataDisplayMode::Hex : DataDisplayMode::UInt16);
-    ui->lineEditToFind->setInputMode(on ? NumericLineEdit::HexMode : NumericLineEdit::Int32Mode);
+    updateFindInputMode();
 }
 
 ///
@@ -462,9 +548,49 @@ void DialogAddressScan::on_lineEditLength_valueChanged(const QVariant& value)
 /// \param value
 ///
 void DialogAddressScan::on_lineEditToFind_valueChanged(const QVariant& value)
+{
+    // a new value searches for itself, a range is set by changing "to" afterwards
+    ui->lineEditToFindTo->setValue(value);
+
+    _findMatches.clear();
+    ui->tableView->selectionModel()->clearSelection();
+}
+
+///
+/// \brief DialogAddressScan::on_lineEditToFindTo_valueChanged
+/// \param value
+///
+void DialogAddressScan::on_lineEditToFindTo_valueChanged(const QVariant& value)
+{
+    Q_UNUSED(value)
+
+    _findMatches.clear();
+    ui->tableView->selectionModel()->clearSelection();
+}
+
+///
+/// \brief DialogAddressScan::on_lineEditFindMask_valueChanged
+/// \param value
+///
+void DialogAddressScan::on_lineEditFindMask_valueChanged(const QVariant& value)
 {
     Q_UNUSED(value)
 
+    _findMatches.clear();
+    ui->tableView->selectionModel()->clearSelection();
+}
+
+///
+/// \brief DialogAddressScan::on_comboBoxFindType_currentIndexChanged
+/// \param index
+///
+void DialogAddressScan::on_comboBoxFindType_currentIndexChanged(int index)
+{
+    Q_UNUSED(index)
+
+    updateFindInputMode();
+
+    _findMatches.clear();
     ui->tableView->selectionModel()->clearSelection();
 }
 
@@ -506,6 +632,9 @@ void DialogAddressScan::on_comboBoxByteOrder_byteOrderChanged(ByteOrder order)
 {
     ui->info->setByteOrder(order);
     ((TableViewItemModel*)ui->tableView->model())->setByteOrder(order);
+
+    _findMatches.clear();
+    ui->tableView->selectionModel()->clearSelection();
 }
 
 ///
@@ -584,11 +713,12 @@ void DialogAddressScan::on_pushButtonScan_clicked()
 ///
 void DialogAddressScan::on_pushButtonExport_clicked()
 {
-    auto filename = QFileDialog::getSaveFileName(this, QString(), windowTitle(), tr("Pdf files (*.pdf);;CSV files (*.csv)"));
+    auto filename = QFileDialog::getSaveFileName(this, QString(), windowTitle(), tr("Pdf files (*.pdf);;CSV files (*.csv);;Parquet files (*.parquet)"));
     if(filename.isEmpty()) return;
 
     if(!filename.endsWith(".pdf", Qt::CaseInsensitive) &&
-       !filename.endsWith(".csv", Qt::CaseInsensitive))
+       !filename.endsWith(".csv", Qt::CaseInsensitive) &&
+       !filename.endsWith(".parquet", Qt::CaseInsensitive))
     {
         filename += ".pdf";
     }
@@ -597,6 +727,8 @@ void DialogAddressScan::on_pushButtonExport_clicked()
         exportPdf(filename);
     else if(filename.endsWith(".csv", Qt::CaseInsensitive))
         exportCsv(filename);
+    else if(filename.endsWith(".parquet", Qt::CaseInsensitive))
+        exportParquet(filename);
 }
 
 ///
@@ -604,48 +736,48 @@ void DialogAddressScan::on_pushButtonExport_clicked()
 ///
 void DialogAddressScan::on_pushButtonFind_clicked()
 {
-    const auto valueToFind = ui->lineEditToFind->value<int>();
     auto model = ((TableViewItemModel*)ui->tableView->model());
     auto selectionModel = ui->tableView->selectionModel();
+    const auto columns = model->columnCount();
 
     if(!selectionModel->hasSelection())
     {
-        for(int i = 0; i < model->rowCount(); i++)
+        _findMatches = model->findValues(searchParams());
+
+        QItemSelection selection;
+        for(int i = 0; i < _findMatches.size(); )
         {
-            for(int j = 0; j < model->columnCount(); j++)
+            // merge consecutive matches on the same row into one range
+            int j = i + 1;
+            while(j < _findMatches.size() &&
+                  _findMatches[j] == _findMatches[j - 1] + 1 &&
+                  _findMatches[j] / columns == _findMatches[i] / columns)
             {
-                const auto index = model->index(i,j);
-
-                bool ok;
-                const auto value = model->data(index, Qt::UserRole + 1).toInt(&ok);
-                if(!ok) continue;
-
-                if(value == valueToFind)
-                {
-                    selectionModel->select(index, QItemSelectionModel::Select);
-                }
+                j++;
             }
+
+            selection.select(model->index(_findMatches[i] / columns, _findMatches[i] % columns),
+                             model->index(_findMatches[j - 1] / columns, _findMatches[j - 1] % columns));
+            i = j;
         }
+        selectionModel->select(selection, QItemSelectionModel::Select);
     }
 
-    bool found = false;
-    const auto currentIndex = ui->tableView->currentIndex();
-    const auto selectedIndexes = selectionModel->selectedIndexes();
-    const auto  i = currentIndex.row() * model->columnCount() + currentIndex.column();
-    for(auto&& index : selectedIndexes)
+    if(!_findMatches.isEmpty())
     {
-        const int j = index.row() * model->columnCount() + index.column();
-        if(j > i) {
-            found = true;
-            ui->tableView->scrollTo(index);
-            ui->tableView->setCurrentIndex(index);
-            break;
+        const auto currentIndex = ui->tableView->currentIndex();
+        const auto current = currentIndex.isValid() ? currentIndex.row() * columns + currentIndex.column() : -1;
+
+        auto it = std::upper_bound(_findMatches.cbegin(), _findMatches.cend(), current);
+        if(it == _findMatches.cend())
+        {
+            it = _findMatches.cbegin();
+            ui->tableView->scrollTo(model->index(0,0));
         }
-    }
-    if(!found && !selectedIndexes.isEmpty()) {
-        ui->tableView->scrollTo(model->index(0,0));
-        ui->tableView->scrollTo(selectedIndexes.first());
-        ui->tableView->setCurrentIndex(selectedIndexes.first());
+
+        const auto index = model->index(*it / columns, *it % columns);
+        ui->tableView->scrollTo(index);
+        ui->tableView->setCurrentIndex(index);
     }
 
     ui->tableView->setFocus();
@@ -667,6 +799,7 @@ void DialogAddressScan::startScan()
 
     _scanning = true;
     _finished = false;
+    _scanStartTime = QDateTime::currentDateTime();
 
     clearTableView();
     clearLogView();
@@ -709,7 +842,7 @@ void DialogAddressScan::sendReadRequest()
     else
     {
         _requestCount += count;
-        _modbusClient.sendReadRequest(pointType, address, count, deviceId, -1);
+        _modbusClient.sendReadRequest(pointType, address, count, deviceId, -1, ModbusClient::Priority::BackgroundScan);
     }
 }
 
@@ -769,6 +902,58 @@ void DialogAddressScan::updateProgress()
     ui->progressBar->setValue(progress);
 }
 
+///
+/// \brief DialogAddressScan::updateFindInputMode
+///
+void DialogAddressScan::updateFindInputMode()
+{
+    NumericLineEdit::InputMode mode;
+    switch(ui->comboBoxFindType->currentData().value<DataDisplayMode>())
+    {
+        case DataDisplayMode::UInt16:
+            mode = ui->checkBoxHexView->isChecked() ? NumericLineEdit::HexMode : NumericLineEdit::Int32Mode;
+        break;
+
+        case DataDisplayMode::UInt32:
+        case DataDisplayMode::SwappedUInt32:
+            mode = NumericLineEdit::UInt32Mode;
+        break;
+
+        case DataDisplayMode::FloatingPt:
+        case DataDisplayMode::SwappedFP:
+            mode = NumericLineEdit::FloatMode;
+        break;
+
+        case DataDisplayMode::DblFloat:
+        case DataDisplayMode::SwappedDbl:
+            mode = NumericLineEdit::DoubleMode;
+        break;
+
+        default:
+            mode = NumericLineEdit::Int32Mode;
+        break;
+    }
+
+    ui->lineEditToFind->setInputMode(mode);
+    ui->lineEditToFindTo->setInputMode(mode);
+}
+
+///
+/// \brief DialogAddressScan::searchParams
+/// \return
+///
+ModbusSearchParams DialogAddressScan::searchParams() const
+{
+    ModbusSearchParams params;
+    params.Mode = ui->comboBoxFindType->currentData().value<DataDisplayMode>();
+    params.Order = ui->comboBoxByteOrder->currentByteOrder();
+    params.From = ui->lineEditToFind->value<double>();
+    params.To = qMax(params.From, ui->lineEditToFindTo->value<double>());
+    params.Mask = ui->lineEditFindMask->value<quint16>();
+
+    return params;
+}
+
 ///
 /// \brief DialogAddressScan::updateTableView
 /// \param pointAddress
@@ -776,23 +961,7 @@ void DialogAddressScan::updateProgress()
 ///
 void DialogAddressScan::updateTableView(int pointAddress, QVector<quint16> values)
 {
-    auto model = ui->tableView->model();
-
-    const auto addressBase = ui->comboBoxAddressBase->currentAddressBase();
-    pointAddress += (addressBase == AddressBase::Base0 ? 0 : 1);
-
-    for(int i = 0; i < model->rowCount(); i++)
-    {
-        for(int j = 0; j < model->columnCount(); j++)
-        {
-            const auto index = model->index(i, j);
-            if(model->data(index, Qt::UserRole).toInt() == pointAddress)
-            {
-                model->setData(index, QVariant::fromValue(values), Qt::DisplayRole);
-                return;
-            }
-        }
-    }
+    ((TableViewItemModel*)ui->tableView->model())->updateValues(pointAddress, values);
 }
 
 ///
@@ -812,7 +981,7 @@ void DialogAddressScan::updateLogView(int deviceId, int transactionId, const QMo
     auto msg = ModbusMessage::create(request, protocol, deviceId, QDateTime::currentDateTime(), true);
 
     if(protocol == ModbusMessage::Tcp)
-        ((QModbusAduTcp*)msg->adu())->setTransactionId(transactionId);
+        ((ModbusMessage*)msg)->setTransactionId(transactionId);
 
     const auto addressBase = ui->comboBoxAddressBase->currentAddressBase();
     pointAddress += (addressBase == AddressBase::Base0 ? 0 : 1);
@@ -841,28 +1010,87 @@ void DialogAddressScan::updateLogView(const QModbusReply* reply)
     auto msg = ModbusMessage::create(pdu, protocol, deviceId, QDateTime::currentDateTime(), false);
 
     if(protocol == ModbusMessage::Tcp)
-        ((QModbusAduTcp*)msg->adu())->setTransactionId(transactionId);
+        ((ModbusMessage*)msg)->setTransactionId(transactionId);
 
     proxyLogModel->append(pointAddress, ui->comboBoxPointType->currentPointType(), msg);
 }
 
+///
+/// \brief DialogAddressScan::on_exportFinished
+/// \param success
+/// \param filename
+///
+void DialogAddressScan::on_exportFinished(bool success, const QString& filename)
+{
+    ui->progressBar->setValue(0);
+
+    if(!success)
+    {
+        QString text;
+        if(filename.endsWith(".pdf", Qt::CaseInsensitive))
+            text = tr("Error. Failed to write PDF file!");
+        else if(filename.endsWith(".csv", Qt::CaseInsensitive))
+            text = tr("Error. Failed to write CSV file!");
+        else
+            text = tr("Error. Failed to write Parquet file!");
+        QMessageBox::warning(this, windowTitle(), text);
+    }
+}
+
+///
+/// \brief DialogAddressScan::exportParams
+/// \return
+///
+ScanExportParams DialogAddressScan::exportParams() const
+{
+    auto model = ((TableViewItemModel*)ui->tableView->model());
+
+    ScanExportParams params;
+    params.Data = model->dataUnit();
+    params.Columns = model->columnCount();
+    params.HexView = ui->checkBoxHexView->isChecked();
+    params.Order = ui->comboBoxByteOrder->currentByteOrder();
+    params.Base = ui->comboBoxAddressBase->currentAddressBase();
+    params.Timestamp = _scanStartTime;
+    params.AddressBaseText = ui->comboBoxAddressBase->currentText();
+    params.StartAddressText = ui->lineEditStartAddress->text();
+    params.LengthText = ui->lineEditLength->text();
+    params.DeviceIdText = ui->lineEditSlaveAddress->text();
+    params.PointTypeText = ui->comboBoxPointType->currentText();
+    params.RegsOnQueryText = ui->spinBoxRegsOnQuery->text();
+    params.ByteOrderText = ui->comboBoxByteOrder->currentText();
+
+    return params;
+}
+
+///
+/// \brief DialogAddressScan::startExport
+/// \param exporter
+/// \param filename
+///
+void DialogAddressScan::startExport(ScanExporter* exporter, const QString& filename)
+{
+    _exportThread = new QThread(this);
+    exporter->moveToThread(_exportThread);
+
+    connect(_exportThread, &QThread::started, exporter, [exporter, filename]{ exporter->exportFile(filename); });
+    connect(exporter, &ScanExporter::progress, ui->progressBar, &QProgressBar::setValue);
+    connect(exporter, &ScanExporter::finished, this, &DialogAddressScan::on_exportFinished);
+    connect(exporter, &ScanExporter::finished, _exportThread, &QThread::quit);
+    connect(_exportThread, &QThread::finished, exporter, &QObject::deleteLater);
+    connect(_exportThread, &QThread::finished, _exportThread, &QObject::deleteLater);
+
+    ui->progressBar->setValue(0);
+    _exportThread->start(QThread::LowPriority);
+}
+
 ///
 /// \brief DialogAddressScan::exportPdf
 /// \param filename
 ///
 void DialogAddressScan::exportPdf(const QString& filename)
 {
-    PdfExporter exporter(ui->tableView->model(),
-                         ui->comboBoxAddressBase->currentText(),
-                         ui->lineEditStartAddress->text(),
-                         ui->lineEditLength->text(),
-                         ui->lineEditSlaveAddress->text(),
-                         ui->comboBoxPointType->currentText(),
-                         ui->spinBoxRegsOnQuery->text(),
-                         ui->comboBoxByteOrder->currentText(),
-                         this);
-
-    exporter.exportPdf(filename);
+    startExport(new PdfExporter(exportParams()), filename);
 }
 
 ///
@@ -871,48 +1099,108 @@ void DialogAddressScan::exportPdf(const QString& filename)
 ///
 void DialogAddressScan::exportCsv(const QString& filename)
 {
-    CsvExporter exporter(ui->tableView->model(),
-                         ui->comboBoxAddressBase->currentText(),
-                         ui->lineEditStartAddress->text(),
-                         ui->lineEditLength->text(),
-                         ui->lineEditSlaveAddress->text(),
-                         ui->comboBoxPointType->currentText(),
-                         ui->spinBoxRegsOnQuery->text(),
-                         ui->comboBoxByteOrder->currentText(),
-                         this);
+    startExport(new CsvExporter(exportParams()), filename);
+}
 
-    exporter.exportCsv(filename);
+///
+/// \brief DialogAddressScan::exportParquet
+/// \param filename
+///
+void DialogAddressScan::exportParquet(const QString& filename)
+{
+    startExport(new ParquetExporter(exportParams()), filename);
 }
 
 ///
-/// \brief PdfExporter::PdfExporter
-/// \param model
-/// \param addressBase
-/// \param startAddress
-/// \param length
-/// \param devId
-/// \param pointType
-/// \param regsOnQuery
+/// \brief ScanExporter::ScanExporter
+/// \param params
 /// \param parent
 ///
-PdfExporter::PdfExporter(QAbstractItemModel* model,
-                         const QString& addressBase,
-                         const QString& startAddress,
-                         const QString& length,
-                         const QString& devId,
-                         const QString& pointType,
-                         const QString& regsOnQuery,
-                         const QString& byteOrder,
-                         QObject* parent)
+ScanExporter::ScanExporter(const ScanExportParams& params, QObject* parent)
     : QObject(parent)
-    ,_model(model)
-    ,_addressBase(addressBase)
-    ,_startAddress(startAddress)
-    ,_length(length)
-    ,_deviceId(devId)
-    ,_pointType(pointType)
-    ,_regsOnQuery(regsOnQuery)
-    ,_byteOrder(byteOrder)
+    ,_params(params)
+{
+}
+
+///
+/// \brief ScanExporter::rowCount
+/// \return
+///
+int ScanExporter::rowCount() const
+{
+    return qCeil(_params.Data.valueCount() / (double)_params.Columns);
+}
+
+///
+/// \brief ScanExporter::columnCount
+/// \return
+///
+int ScanExporter::columnCount() const
+{
+    return _params.Columns;
+}
+
+///
+/// \brief ScanExporter::horizontalHeader
+/// \param column
+/// \return
+///
+QString ScanExporter::horizontalHeader(int column) const
+{
+    return QString("+%1").arg(column);
+}
+
+///
+/// \brief ScanExporter::verticalHeader
+/// \param row
+/// \return
+///
+QString ScanExporter::verticalHeader(int row) const
+{
+    return formatScanRowHeader(_params.Data, row, _params.Columns, _params.Base);
+}
+
+///
+/// \brief ScanExporter::cellText
+/// \param row
+/// \param column
+/// \return
+///
+QString ScanExporter::cellText(int row, int column) const
+{
+    return formatScanValue(_params.Data, row * _params.Columns + column, _params.HexView, _params.Order);
+}
+
+///
+/// \brief ScanExporter::updateProgress
+/// \param row
+///
+void ScanExporter::updateProgress(int row)
+{
+    const int value = 100 * (row + 1) / qMax(1, rowCount());
+    if(value != _progress)
+    {
+        _progress = value;
+        emit progress(value);
+    }
+}
+
+///
+/// \brief ScanExporter::isInterrupted
+/// \return
+///
+bool ScanExporter::isInterrupted() const
+{
+    return QThread::currentThread()->isInterruptionRequested();
+}
+
+///
+/// \brief PdfExporter::PdfExporter
+/// \param params
+/// \param parent
+///
+PdfExporter::PdfExporter(const ScanExportParams& params, QObject* parent)
+    : ScanExporter(params, parent)
 {
     _printer = QSharedPointer<QPrinter>(new QPrinter(QPrinter::PrinterResolution));
     _printer->setOutputFormat(QPrinter::PdfFormat);
@@ -939,10 +1227,7 @@ void PdfExporter::exportPdf(const QString& filename)
      QPainter painter;
      if(!painter.begin(_printer.get()))
      {
-         auto w = qobject_cast<QWidget*>(parent());
-         Q_ASSERT(w != nullptr);
-
-         QMessageBox::warning(w, w->windowTitle(), tr("Error. Failed to write PDF file!"));
+         emit finished(false, filename);
          return;
      }
 
@@ -953,35 +1238,47 @@ void PdfExporter::exportPdf(const QString& filename)
 
      int yPos = _pageRect.top();
      paintPageHeader(yPos, painter);
-     paintTable(yPos, painter);
+     const bool success = paintTable(yPos, painter);
+
+     painter.end();
+     emit finished(success, filename);
 }
 
 ///
 /// \brief PdfExporter::calcTable
+/// Cell texts have a fixed format, so the widest possible value and the last
+/// (widest) row header are measured instead of every cell
 ///
 void PdfExporter::calcTable(QPainter& painter)
 {
     const auto rc = _pageRect;
-    const auto rows = _model->rowCount();
-    const auto cols = _model->columnCount();
+    const auto rows = rowCount();
 
-    for(int i = 0; i < rows; i++)
+    if(rows > 0)
     {
-        for(int j = 0; j < cols; j++)
-        {
-            if(j == 0)
-            {
-                const auto text = _model->headerData(i, Qt::Vertical, Qt::DisplayRole).toString();
-                const auto rcText = painter.boundingRect(rc, Qt::TextSingleLine, text);
-                _headerWidth = qMax(_headerWidth, rcText.width() + _cx);
-            }
+        const auto text = verticalHeader(rows - 1);
+        const auto rcText = painter.boundingRect(rc, Qt::TextSingleLine, text);
+        _headerWidth = qMax(_headerWidth, rcText.width() + _cx);
+    }
 
-            const auto text = _model->data(_model->index(i, j), Qt::DisplayRole).toString();
-            const auto rcText = painter.boundingRect(rc, Qt::TextSingleLine, text);
+    QStringList samples = { "-" };
+    switch(_params.Data.registerType())
+    {
+        case QModbusDataUnit::Coils:
+        case QModbusDataUnit::DiscreteInputs:
+            samples << "0" << "1";
+        break;
 
-            _colWidth = qMax(_colWidth, rcText.width() + _cx);
-            _rowHeight = qMax(_rowHeight, rcText.height());
-        }
+        default:
+            samples << (_params.HexView ? "0xFFFF" : "00000") << "88888";
+        break;
+    }
+
+    for(auto&& text : samples)
+    {
+        const auto rcText = painter.boundingRect(rc, Qt::TextSingleLine, text);
+        _colWidth = qMax(_colWidth, rcText.width() + _cx);
+        _rowHeight = qMax(_rowHeight, rcText.height());
     }
 }
 
@@ -995,13 +1292,13 @@ void PdfExporter::paintPageHeader(int& yPos, QPainter& painter)
     const auto textTime = QLocale().toString(QDateTime::currentDateTime(), QLocale::ShortFormat);
     auto rcTime = painter.boundingRect(_pageRect, Qt::TextSingleLine, textTime);
 
-    const auto text1 = QString(tr("Address Base: %1\nStart Address: %2")).arg(_addressBase, _startAddress);
+    const auto text1 = QString(tr("Address Base: %1\nStart Address: %2")).arg(_params.AddressBaseText, _params.StartAddressText);
     auto rc1 = painter.boundingRect(_pageRect, Qt::TextWordWrap, text1);
 
-    const auto text2 = QString(tr("Device Id: %1\t\tLength: %2\nPoint Type: [%3]")).arg(_deviceId, _length, _pointType);
+    const auto text2 = QString(tr("Device Id: %1\t\tLength: %2\nPoint Type: [%3]")).arg(_params.DeviceIdText, _params.LengthText, _params.PointTypeText);
     auto rc2 = painter.boundingRect(_pageRect, Qt::TextWordWrap, text2);
 
-    const auto text3 = QString(tr("Registers on Query: %1\nByte Order: %2")).arg(_regsOnQuery, _byteOrder);
+    const auto text3 = QString(tr("Registers on Query: %1\nByte Order: %2")).arg(_params.RegsOnQueryText, _params.ByteOrderText);
     auto rc3 = painter.boundingRect(_pageRect, Qt::TextWordWrap, text3);
 
     rcTime.moveTopRight({ _pageRect.right(), 10 });
@@ -1040,12 +1337,12 @@ void PdfExporter::paintTableHeader(int& yPos, QPainter& painter)
     rc.setTop(yPos);
     rc.setBottom(yPos + _rowHeight);
 
-    for(int j = 0; j < _model->columnCount(); j++)
+    for(int j = 0; j < columnCount(); j++)
     {
         auto rcPaint = rc;
         rcPaint.setLeft(rc.left() + _headerWidth + _colWidth * j);
         rcPaint.setRight(rcPaint.left() + _colWidth);
-        painter.drawText(rcPaint, Qt::AlignHCenter | Qt::TextSingleLine, _model->headerData(j, Qt::Horizontal, Qt::DisplayRole).toString());
+        painter.drawText(rcPaint, Qt::AlignHCenter | Qt::TextSingleLine, horizontalHeader(j));
     }
 
     painter.drawLine(rc.bottomLeft(), rc.bottomRight());
@@ -1063,15 +1360,15 @@ void PdfExporter::paintTableRow(int& yPos, QPainter& painter, int row)
     QRect rc = _pageRect;
     rc.setTop(yPos);
 
-    for(int j = 0; j < _model->columnCount(); j++)
+    for(int j = 0; j < columnCount(); j++)
     {
         if(j == 0)
-            painter.drawText(rc, Qt::TextSingleLine, _model->headerData(row, Qt::Vertical, Qt::DisplayRole).toString());
+            painter.drawText(rc, Qt::TextSingleLine, verticalHeader(row));
 
         auto rcPaint = rc;
         rcPaint.setLeft(rc.left() + _headerWidth + _colWidth * j);
         rcPaint.setRight(rcPaint.left() + _colWidth);
-        painter.drawText(rcPaint, Qt::AlignHCenter | Qt::TextSingleLine, _model->data(_model->index(row, j), Qt::DisplayRole).toString());
+        painter.drawText(rcPaint, Qt::AlignHCenter | Qt::TextSingleLine, cellText(row, j));
     }
 
     yPos += _rowHeight;
@@ -1081,17 +1378,23 @@ void PdfExporter::paintTableRow(int& yPos, QPainter& painter, int row)
 /// \brief PdfExporter::paintTable
 /// \param yPos
 /// \param painter
+/// \return false if the export was interrupted
 ///
-void PdfExporter::paintTable(int& yPos, QPainter& painter)
+bool PdfExporter::paintTable(int& yPos, QPainter& painter)
 {
     paintTableHeader(yPos, painter);
 
     QRect rc = _pageRect;
     rc.setTop(yPos);
 
-    for(int i = 0; i < _model->rowCount(); i++)
+    const auto rows = rowCount();
+    for(int i = 0; i < rows; i++)
     {
+        if(isInterrupted())
+            return false;
+
         paintTableRow(yPos, painter, i);
+        updateProgress(i);
 
         if(yPos > rc.bottom() - _rowHeight)
         {
@@ -1112,6 +1415,7 @@ void PdfExporter::paintTable(int& yPos, QPainter& painter)
         paintPageFooter(painter);
 
     paintVLine(rc.top() - _rowHeight, yPos + _cy, painter);
+    return true;
 }
 
 ///
@@ -1132,66 +1436,178 @@ void PdfExporter::paintVLine(int top, int bottom, QPainter& painter)
 
 ///
 /// \brief CsvExporter::CsvExporter
-/// \param model
-/// \param startAddress
-/// \param length
-/// \param devId
-/// \param pointType
-/// \param regsOnQuery
+/// \param params
 /// \param parent
 ///
-CsvExporter::CsvExporter(QAbstractItemModel* model,
-                         const QString& addressBase,
-                         const QString& startAddress,
-                         const QString& length,
-                         const QString& devId,
-                         const QString& pointType,
-                         const QString& regsOnQuery,
-                         const QString& byteOrder,
-                         QObject* parent)
-    : QObject(parent)
-    ,_model(model)
-    ,_addressBase(addressBase)
-    ,_startAddress(startAddress)
-    ,_length(length)
-    ,_deviceId(devId)
-    ,_pointType(pointType)
-    ,_regsOnQuery(regsOnQuery)
-    ,_byteOrder(byteOrder)
+CsvExporter::CsvExporter(const ScanExportParams& params, QObject* parent)
+    : ScanExporter(params, parent)
 {
 }
 
 ///
 /// \brief CsvExporter::exportCsv
+/// Rows are formatted into a buffer that is flushed to the file in chunks
 /// \param filename
 ///
 void CsvExporter::exportCsv(const QString& filename)
 {
     QFile file(filename);
     if(!file.open(QFile::WriteOnly))
+    {
+        emit finished(false, filename);
         return;
+    }
+
+    const int chunkSize = 64 * 1024;
+    const QString delim = ";";
 
-    QTextStream ts(&file);
-    ts.setGenerateByteOrderMark(true);
+    QString buffer;
+    buffer.reserve(chunkSize);
+
+    const auto flush = [&file, &buffer]
+    {
+        const auto data = buffer.toUtf8();
+        buffer.clear();
+        return file.write(data) == data.size();
+    };
+
+    file.write("\xEF\xBB\xBF");
 
-    const char* delim = ";";
     const auto header = QString("%2%1%3%1%4%1%5%1%6%1%7%1%8").arg(delim, tr("Address Base"), tr("Start Address"), tr("Device Id"), tr("Length"), tr("Point Type"), tr("Registers on Query"), tr("Byte Order"));
-    ts << header << "\n";
+    buffer += header + "\n";
 
-    const auto headerData = QString("%2%1%3%1%4%1%5%1%6%1%7%1%8").arg(delim, _addressBase, _startAddress, _deviceId, _length, _pointType, _regsOnQuery, _byteOrder);
-    ts << headerData << "\n";
+    const auto headerData = QString("%2%1%3%1%4%1%5%1%6%1%7%1%8").arg(delim, _params.AddressBaseText, _params.StartAddressText, _params.DeviceIdText, _params.LengthText, _params.PointTypeText, _params.RegsOnQueryText, _params.ByteOrderText);
+    buffer += headerData + "\n";
 
-    ts << "\n";
+    buffer += "\n";
 
-    for(int j = 0; j < _model->columnCount(); j++)
-        ts << delim << QString("=\"%1\"").arg(_model->headerData(j, Qt::Horizontal, Qt::DisplayRole).toString());
+    for(int j = 0; j < columnCount(); j++)
+        buffer += delim + QString("=\"%1\"").arg(horizontalHeader(j));
 
-    for(int i = 0; i < _model->rowCount(); i++)
+    bool success = true;
+    const auto rows = rowCount();
+    for(int i = 0; i < rows && success; i++)
     {
-        ts << "\n" << _model->headerData(i, Qt::Vertical, Qt::DisplayRole).toString();
-        for(int j = 0; j < _model->columnCount(); j++)
+        if(isInterrupted())
         {
-            ts << delim << _model->data(_model->index(i, j), Qt::DisplayRole).toString();
+            success = false;
+            break;
         }
+
+        buffer += "\n" + verticalHeader(i);
+        for(int j = 0; j < columnCount(); j++)
+        {
+            buffer += delim;
+            buffer += cellText(i, j);
+        }
+
+        if(buffer.size() >= chunkSize)
+            success = flush();
+
+        updateProgress(i);
     }
+
+    if(success)
+        success = flush();
+
+    emit finished(success, filename);
+}
+
+///
+/// \brief ParquetExporter::ParquetExporter
+/// \param params
+/// \param parent
+///
+ParquetExporter::ParquetExporter(const ScanExportParams& params, QObject* parent)
+    : ScanExporter(params, parent)
+{
+}
+
+///
+/// \brief ParquetExporter::exportParquet
+/// Writes one row per scanned register with typed columns; multi-register
+/// values are decoded starting at that register and are null when it is the last one
+/// \param filename
+///
+void ParquetExporter::exportParquet(const QString& filename)
+{
+    const auto& data = _params.Data;
+    const auto order = _params.Order;
+    const bool registers = data.registerType() == QModbusDataUnit::HoldingRegisters ||
+                           data.registerType() == QModbusDataUnit::InputRegisters;
+
+    ParquetWriter writer;
+    writer.setMetadata("device_id", _params.DeviceIdText);
+    writer.setMetadata("point_type", _params.PointTypeText);
+    writer.setMetadata("address_base", _params.AddressBaseText);
+    writer.setMetadata("start_address", _params.StartAddressText);
+    writer.setMetadata("length", _params.LengthText);
+    writer.setMetadata("byte_order", _params.ByteOrderText);
+
+    const int colTimestamp = writer.addColumn("timestamp", ParquetWriter::Int64, ParquetWriter::TimestampMillis);
+    const int colAddress = writer.addColumn("address", ParquetWriter::Int32);
+    const int colRaw = writer.addColumn("raw", ParquetWriter::Int32, ParquetWriter::UInt16);
+
+    int colInt16 = -1, colInt32 = -1, colUInt32 = -1, colFloat = -1, colDouble = -1;
+    if(registers)
+    {
+        colInt16 = writer.addColumn("int16", ParquetWriter::Int32, ParquetWriter::Int16);
+        colInt32 = writer.addColumn("int32", ParquetWriter::Int32, ParquetWriter::NoConvertedType, true);
+        colUInt32 = writer.addColumn("uint32", ParquetWriter::Int64, ParquetWriter::NoConvertedType, true);
+        colFloat = writer.addColumn("float", ParquetWriter::Float, ParquetWriter::NoConvertedType, true);
+        colDouble = writer.addColumn("double", ParquetWriter::Double, ParquetWriter::NoConvertedType, true);
+    }
+
+    const qint64 timestamp = _params.Timestamp.toMSecsSinceEpoch();
+    const int addressOffset = data.startAddress() + (_params.Base == AddressBase::Base0 ? 0 : 1);
+    const int count = data.valueCount();
+
+    for(int i = 0; i < count; i++)
+    {
+        if(isInterrupted())
+        {
+            emit finished(false, filename);
+            return;
+        }
+
+        if(i % _params.Columns == 0)
+            updateProgress(i / _params.Columns);
+
+        if(!data.hasValue(i))
+            continue;
+
+        const quint16 value = data.value(i);
+        writer.append(colTimestamp, timestamp);
+        writer.append(colAddress, qint64(addressOffset + i));
+        writer.append(colRaw, qint64(value));
+
+        if(!registers)
+            continue;
+
+        writer.append(colInt16, qint64(qint16(toByteOrderValue(value, order))));
+
+        if(i + 1 < count && data.hasValue(i + 1))
+        {
+            const auto value2 = data.value(i + 1);
+            writer.append(colInt32, qint64(makeInt32(value, value2, order)));
+            writer.append(colUInt32, qint64(makeUInt32(value, value2, order)));
+            writer.append(colFloat, double(makeFloat(value, value2, order)));
+        }
+        else
+        {
+            writer.appendNull(colInt32);
+            writer.appendNull(colUInt32);
+            writer.appendNull(colFloat);
+        }
+
+        if(i + 3 < count && data.hasValue(i + 1) && data.hasValue(i + 2) && data.hasValue(i + 3))
+            writer.append(colDouble, makeDouble(value, data.value(i + 1), data.value(i + 2), data.value(i + 3), order));
+        else
+            writer.appendNull(colDouble);
+    }
+
+    QFile file(filename);
+    const bool success = file.open(QFile::WriteOnly) && writer.write(&file);
+
+    emit finished(success, filename);
 }
@@ -3,11 +3,15 @@
 
 #include <QDialog>
 #include <QTimer>
+#include <QDateTime>
+#include <QThread>
+#include <QPointer>
 #include <QPrinter>
 #include <QAbstractTableModel>
 #include <QSortFilterProxyModel>
 #include "modbusmessage.h"
 #include "modbusdataunit.h"
+#include "modbusdatasearch.h"
 #include "modbusclient.h"
 #include "displaydefinition.h"
 
@@ -35,6 +39,17 @@ public:
     AddressBase addressBse() const;
     void setAddressBase(AddressBase base);
 
+    QModelIndex addressIndex(int address) const;
+    void updateValues(int address, const QVector<quint16>& values);
+
+    QVector<int> findValues(const ModbusSearchParams& params) const {
+        return ::findValues(_data, params);
+    }
+
+    const ModbusDataUnit& dataUnit() const {
+        return _data;
+    }
+
     void reset(const ModbusDataUnit& data, int columns = 10){
         beginResetModel();
         _columns = columns;
@@ -160,32 +175,84 @@ private:
     bool _showValid;
 };
 
+///
+/// \brief The ScanExportParams class
+///
+struct ScanExportParams
+{
+    ModbusDataUnit Data;
+    int Columns = 10;
+    bool HexView = false;
+    ByteOrder Order = ByteOrder::Direct;
+    AddressBase Base = AddressBase::Base1;
+    QDateTime Timestamp;
+    QString AddressBaseText;
+    QString StartAddressText;
+    QString LengthText;
+    QString DeviceIdText;
+    QString PointTypeText;
+    QString RegsOnQueryText;
+    QString ByteOrderText;
+};
+
+///
+/// \brief The ScanExporter class
+/// Formats cells straight from the scan store so it can run on a worker thread
+///
+class ScanExporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ScanExporter(const ScanExportParams& params, QObject* parent = nullptr);
+
+    int rowCount() const;
+    int columnCount() const;
+    QString horizontalHeader(int column) const;
+    QString verticalHeader(int row) const;
+    QString cellText(int row, int column) const;
+
+public slots:
+    virtual void exportFile(const QString& filename) = 0;
+
+signals:
+    void progress(int value);
+    void finished(bool success, const QString& filename);
+
+protected:
+    void updateProgress(int row);
+    bool isInterrupted() const;
+
+protected:
+    const ScanExportParams _params;
+
+private:
+    int _progress = -1;
+};
+
 ///
 /// \brief The PdfExporter class
 ///
-class PdfExporter : public QObject
+class PdfExporter : public ScanExporter
 {
     Q_OBJECT
 
 public:
-    explicit PdfExporter(QAbstractItemModel* model,
-                         const QString& addressBase,
-                         const QString& startAddress,
-                         const QString& length,
-                         const QString& devId,
-                         const QString& pointType,
-                         const QString& regsOnQuery,
-                         const QString& byteOrder,
-                         QObject* parent = nullptr);
+    explicit PdfExporter(const ScanExportParams& params, QObject* parent = nullptr);
     void exportPdf(const QString& filename);
 
+public slots:
+    void exportFile(const QString& filename) override {
+        exportPdf(filename);
+    }
+
 private:
     void calcTable(QPainter& painter);
     void paintPageHeader(int& yPos, QPainter& painter);
     void paintPageFooter(QPainter& painter);
     void paintTableHeader(int& yPos, QPainter& painter);
     void paintTableRow(int& yPos, QPainter& painter, int row);
-    void paintTable(int& yPos, QPainter& painter);
+    bool paintTable(int& yPos, QPainter& painter);
     void paintVLine(int top, int bottom, QPainter& painter);
 
 private:
@@ -196,45 +263,41 @@ private:
     const int _cy = 4;
     const int _cx = 10;
     QRect _pageRect;
-    QAbstractItemModel* _model;
-    const QString _addressBase;
-    const QString _startAddress;
-    const QString _length;
-    const QString _deviceId;
-    const QString _pointType;
-    const QString _regsOnQuery;
-    const QString _byteOrder;
     QSharedPointer<QPrinter> _printer;
 };
 
 ///
 /// \brief The CsvExporter class
 ///
-class CsvExporter: public QObject
+class CsvExporter: public ScanExporter
 {
     Q_OBJECT
 
 public:
-    explicit CsvExporter(QAbstractItemModel* model,
-                         const QString& addressBase,
-                         const QString& startAddress,
-                         const QString& length,
-                         const QString& devId,
-                         const QString& pointType,
-                         const QString& regsOnQuery,
-                         const QString& byteOrder,
-                         QObject* parent = nullptr);
+    explicit CsvExporter(const ScanExportParams& params, QObject* parent = nullptr);
     void exportCsv(const QString& filename);
 
-private:
-    QAbstractItemModel* _model;
-    const QString _addressBase;
-    const QString _startAddress;
-    const QString _length;
-    const QString _deviceId;
-    const QString _pointType;
-    const QString _regsOnQuery;
-    const QString _byteOrder;
+public slots:
+    void exportFile(const QString& filename) override {
+        exportCsv(filename);
+    }
+};
+
+///
+/// \brief The ParquetExporter class
+///
+class ParquetExporter: public ScanExporter
+{
+    Q_OBJECT
+
+public:
+    explicit ParquetExporter(const ScanExportParams& params, QObject* parent = nullptr);
+    void exportParquet(const QString& filename);
+
+public slots:
+    void exportFile(const QString& filename) override {
+        exportParquet(filename);
+    }
 };
 
 ///
@@ -261,6 +324,9 @@ private slots:
     void on_lineEditStartAddress_valueChanged(const QVariant& value);
     void on_lineEditLength_valueChanged(const QVariant& value);
     void on_lineEditToFind_valueChanged(const QVariant& value);
+    void on_lineEditToFindTo_valueChanged(const QVariant& value);
+    void on_lineEditFindMask_valueChanged(const QVariant& value);
+    void on_comboBoxFindType_currentIndexChanged(int index);
     void on_comboBoxPointType_pointTypeChanged(QModbusDataUnit::RegisterType pointType);
     void on_comboBoxAddressBase_addressBaseChanged(AddressBase base);
     void on_comboBoxByteOrder_byteOrderChanged(ByteOrder);
@@ -268,6 +334,7 @@ private slots:
     void on_pushButtonScan_clicked();
     void on_pushButtonExport_clicked();
     void on_pushButtonFind_clicked();
+    void on_exportFinished(bool success, const QString& filename);
 
 private:
     void startScan();
@@ -281,13 +348,18 @@ private:
     void clearProgress();
 
     void updateProgress();
+    void updateFindInputMode();
+    ModbusSearchParams searchParams() const;
     void updateTableView(int pointAddress, QVector<quint16> values);
 
     void updateLogView(int deviceId, int transactionId, const QModbusRequest& request);
     void updateLogView(const QModbusReply* reply);
 
+    ScanExportParams exportParams() const;
+    void startExport(ScanExporter* exporter, const QString& filename);
     void exportPdf(const QString& filename);
     void exportCsv(const QString& filename);
+    void exportParquet(const QString& filename);
 
 private:
     Ui::DialogAddressScan *ui;
@@ -297,7 +369,10 @@ private:
     bool _scanning = false;
     bool _finished = false;
     quint64 _scanTime = 0;
+    QDateTime _scanStartTime;
+    QVector<int> _findMatches;
     QTimer _scanTimer;
+    QPointer<QThread> _exportThread;
     ModbusClient& _modbusClient;
 };
 
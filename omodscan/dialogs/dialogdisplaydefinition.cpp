@@ -19,6 +19,8 @@ DialogDisplayDefinition::DialogDisplayDefinition(DisplayDefinition dd, QWidget*
     ui->lineEditLength->setInputRange(ModbusLimits::lengthRange());
     ui->lineEditSlaveAddress->setInputRange(ModbusLimits::slaveRange());
     ui->lineEditLogLimit->setInputRange(4, 1000);
+    ui->lineEditDeadband->setInputMode(NumericLineEdit::DoubleMode);
+    ui->lineEditDeadband->setInputRange(0., 1e9);
 
     ui->comboBoxAddressBase->setCurrentAddressBase(dd.ZeroBasedAddress ? AddressBase::Base0 : AddressBase::Base1);
     ui->comboBoxPointType->setCurrentPointType(dd.PointType);
@@ -27,6 +29,11 @@ DialogDisplayDefinition::DialogDisplayDefinition(DisplayDefinition dd, QWidget*
     ui->lineEditSlaveAddress->setValue(dd.DeviceId);
     ui->lineEditLength->setValue(dd.Length);
     ui->lineEditLogLimit->setValue(dd.LogViewLimit);
+    ui->checkBoxReportByException->setChecked(dd.ReportByException);
+    ui->lineEditDeadband->setValue(dd.Deadband);
+    ui->lineEditDeadband->setEnabled(dd.ReportByException);
+
+    connect(ui->checkBoxReportByException, &QCheckBox::toggled, ui->lineEditDeadband, &NumericLineEdit::setEnabled);
 
     ui->buttonBox->setFocus();
 }
@@ -51,6 +58,8 @@ void DialogDisplayDefinition::accept()
     _displayDefinition.ScanRate = ui->lineEditScanRate->value<int>();
     _displayDefinition.LogViewLimit = ui->lineEditLogLimit->value<int>();
     _displayDefinition.ZeroBasedAddress = (ui->comboBoxAddressBase->currentAddressBase() == AddressBase::Base0);
+    _displayDefinition.ReportByException = ui->checkBoxReportByException->isChecked();
+    _displayDefinition.Deadband = ui->lineEditDeadband->value<double>();
 
     QFixedSizeDialog::accept();
 }
@@ -1,5 +1,12 @@
+#include <QColor>
+#include <QFileInfo>
 #include <QPushButton>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QProgressDialog>
 #include <QAbstractEventDispatcher>
+#include "modbusdumpimporter.h"
+#include "modbuspcapimporter.h"
 #include "dialogmsgparser.h"
 #include "ui_dialogmsgparser.h"
 
@@ -13,6 +20,7 @@ DialogMsgParser::DialogMsgParser(DataDisplayMode mode, ModbusMessage::ProtocolTy
     : QDialog(parent)
     , ui(new Ui::DialogMsgParser)
     ,_mm(nullptr)
+    ,_dumpProtocol(protocol)
 {
     ui->setupUi(this);
 
@@ -25,6 +33,13 @@ DialogMsgParser::DialogMsgParser(DataDisplayMode mode, ModbusMessage::ProtocolTy
     ui->buttonRtu->setChecked(protocol == ModbusMessage::Rtu);
     ui->buttonTcp->setChecked(protocol == ModbusMessage::Tcp);
 
+    auto model = new FrameListModel(this);
+    model->setHexView(mode == DataDisplayMode::Hex);
+    ui->listViewFrames->setModel(model);
+    ui->listViewFrames->setUniformItemSizes(true);
+    ui->listViewFrames->hide();
+    connect(ui->listViewFrames->selectionModel(), &QItemSelectionModel::currentChanged, this, &DialogMsgParser::on_frameChanged);
+
     auto dispatcher = QAbstractEventDispatcher::instance();
     connect(dispatcher, &QAbstractEventDispatcher::awake, this, &DialogMsgParser::on_awake);
 }
@@ -34,6 +49,13 @@ DialogMsgParser::DialogMsgParser(DataDisplayMode mode, ModbusMessage::ProtocolTy
 ///
 DialogMsgParser::~DialogMsgParser()
 {
+    if(_importThread)
+    {
+        _importThread->requestInterruption();
+        _importThread->quit();
+        _importThread->wait();
+    }
+
     delete ui;
     if(_mm) delete _mm;
 }
@@ -57,7 +79,8 @@ void DialogMsgParser::changeEvent(QEvent* event)
 ///
 void DialogMsgParser::on_awake()
 {
-    ui->pushButtonParse->setEnabled(!ui->bytesData->isEmpty());
+    ui->pushButtonParse->setEnabled(!ui->bytesData->isEmpty() && !_importThread);
+    ui->pushButtonLoad->setEnabled(!_importThread);
 }
 
 ///
@@ -68,6 +91,7 @@ void DialogMsgParser::on_hexView_toggled(bool checked)
 {
     ui->bytesData->setInputMode(checked ? ByteListTextEdit::HexMode : ByteListTextEdit::DecMode);
     ui->info->setDataDisplayMode(checked ? DataDisplayMode::Hex : DataDisplayMode::UInt16);
+    ((FrameListModel*)ui->listViewFrames->model())->setHexView(checked);
 }
 
 ///
@@ -93,11 +117,327 @@ void DialogMsgParser::on_pushButtonParse_clicked()
     auto data = ui->bytesData->value();
     if(data.isEmpty()) return;
 
-    auto protocol = ModbusMessage::Rtu;
-    if(ui->buttonTcp->isChecked())
-        protocol = ModbusMessage::Tcp;
+    const auto frames = ModbusFrameParser(protocol()).parse(data);
+    if(frames.size() > 1)
+    {
+        _dumpData = data;
+        _dumpGaps.clear();
+        _dumpProtocol = protocol();
+        showFrames(data, frames);
+        return;
+    }
+
+    _dumpData.clear();
+    _dumpGaps.clear();
+    ui->listViewFrames->hide();
+    ui->info->setShowTimestamp(false);
+    showMessage(ModbusMessage::create(data, protocol(), QDateTime::currentDateTime(), ui->request->isChecked()));
+}
+
+///
+/// \brief DialogMsgParser::on_pushButtonLoad_clicked
+///
+void DialogMsgParser::on_pushButtonLoad_clicked()
+{
+    const auto filename = QFileDialog::getOpenFileName(this, QString(), QString(), tr("All files (*);;Capture files (*.pcap *.pcapng *.cap)"));
+    if(filename.isEmpty()) return;
+
+    if(ModbusPcapImporter::isPcapFile(filename))
+    {
+        importCapture(filename);
+        return;
+    }
+
+    importDump(filename);
+}
+
+///
+/// \brief DialogMsgParser::on_buttonTcp_toggled
+/// Loaded frames are split again for the newly selected protocol
+///
+void DialogMsgParser::on_buttonTcp_toggled(bool)
+{
+    if(_dumpData.isEmpty() || _importThread || _dumpProtocol == protocol())
+        return;
+
+    parseDump(_dumpData, _dumpGaps);
+}
+
+///
+/// \brief DialogMsgParser::on_frameChanged
+/// \param index
+///
+void DialogMsgParser::on_frameChanged(const QModelIndex& index)
+{
+    if(!index.isValid()) return;
+
+    const auto model = (FrameListModel*)ui->listViewFrames->model();
+    const auto data = model->frame(index.row());
+    const auto ref = model->frameRef(index.row());
+
+    const bool captured = (ref.Timestamp >= 0);
+    const auto timestamp = captured ? QDateTime::fromMSecsSinceEpoch(ref.Timestamp) : QDateTime::currentDateTime();
+    ui->info->setShowTimestamp(captured);
+
+    if(ref.Dir == ModbusFrameRef::Unknown)
+        showMessage(ModbusFrameParser::createMessage(data, protocol(), timestamp));
+    else
+        showMessage(ModbusMessage::create(data, protocol(), timestamp, ref.Dir == ModbusFrameRef::Request));
+}
+
+///
+/// \brief DialogMsgParser::on_importFinished
+/// \param data
+/// \param frames
+/// \param error
+///
+void DialogMsgParser::on_importFinished(const QByteArray& data, const QVector<ModbusFrameRef>& frames, const QString& error)
+{
+    _dumpData.clear();
+    _dumpGaps.clear();
+
+    ui->buttonTcp->setChecked(true);
+    ui->bytesData->clear();
+    showFrames(data, frames);
+
+    if(!error.isEmpty())
+        QMessageBox::warning(this, windowTitle(), error);
+    else if(frames.isEmpty())
+        QMessageBox::information(this, windowTitle(), tr("No Modbus TCP traffic found in the capture."));
+}
+
+///
+/// \brief DialogMsgParser::on_dumpFinished
+/// \param data
+/// \param gaps
+/// \param frames
+/// \param error
+///
+void DialogMsgParser::on_dumpFinished(const QByteArray& data, const QVector<qint64>& gaps, const QVector<ModbusFrameRef>& frames, const QString& error)
+{
+    if(!error.isEmpty())
+    {
+        QMessageBox::warning(this, windowTitle(), error);
+        return;
+    }
+
+    if(data.isEmpty())
+        return;
+
+    _dumpData = data;
+    _dumpGaps = gaps;
+
+    ui->bytesData->clear();
+    showFrames(data, frames);
+}
+
+///
+/// \brief DialogMsgParser::protocol
+/// \return
+///
+ModbusMessage::ProtocolType DialogMsgParser::protocol() const
+{
+    return ui->buttonTcp->isChecked() ? ModbusMessage::Tcp : ModbusMessage::Rtu;
+}
+
+///
+/// \brief DialogMsgParser::importCapture
+/// The capture is read on a worker thread, the frames are shown when it is done
+/// \param filename
+///
+void DialogMsgParser::importCapture(const QString& filename)
+{
+    auto importer = new ModbusPcapImporter();
+    connect(importer, &ModbusPcapImporter::finished, this, &DialogMsgParser::on_importFinished);
+
+    startImport(importer, tr("Importing %1...").arg(QFileInfo(filename).fileName()),
+                [importer, filename]{ importer->importFile(filename); });
+}
+
+///
+/// \brief DialogMsgParser::importDump
+/// A raw or hex dump is read and split on a worker thread, like a pcap capture
+/// \param filename
+///
+void DialogMsgParser::importDump(const QString& filename)
+{
+    _dumpProtocol = protocol();
+
+    auto importer = new ModbusDumpImporter(_dumpProtocol);
+    connect(importer, &ModbusDumpImporter::finished, this, &DialogMsgParser::on_dumpFinished);
+
+    startImport(importer, tr("Loading %1...").arg(QFileInfo(filename).fileName()),
+                [importer, filename]{ importer->importFile(filename); });
+}
+
+///
+/// \brief DialogMsgParser::parseDump
+/// \param data
+/// \param gaps
+///
+void DialogMsgParser::parseDump(const QByteArray& data, const QVector<qint64>& gaps)
+{
+    _dumpProtocol = protocol();
+
+    auto importer = new ModbusDumpImporter(_dumpProtocol);
+    connect(importer, &ModbusDumpImporter::finished, this, &DialogMsgParser::on_dumpFinished);
+
+    startImport(importer, tr("Parsing..."), [importer, data, gaps]{ importer->parseData(data, gaps); });
+}
+
+///
+/// \brief DialogMsgParser::startImport
+/// Runs the importer on a worker thread with a cancellable progress dialog
+/// \param importer
+/// \param label
+/// \param run
+///
+template<typename Importer, typename Function>
+void DialogMsgParser::startImport(Importer* importer, const QString& label, Function run)
+{
+    _importThread = new QThread(this);
+    importer->moveToThread(_importThread);
+
+    auto progress = new QProgressDialog(label, tr("Cancel"), 0, 100, this);
+    progress->setWindowModality(Qt::WindowModal);
+    progress->setMinimumDuration(500);
+
+    connect(_importThread, &QThread::started, importer, run);
+    connect(importer, &Importer::progress, progress, &QProgressDialog::setValue);
+    connect(progress, &QProgressDialog::canceled, _importThread, &QThread::requestInterruption);
+    connect(importer, &Importer::finished, progress, &QObject::deleteLater);
+    connect(importer, &Importer::finished, _importThread, &QThread::quit);
+    connect(_importThread, &QThread::finished, importer, &QObject::deleteLater);
+    connect(_importThread, &QThread::finished, _importThread, &QObject::deleteLater);
+    connect(_importThread, &QThread::finished, this, [this]
+    {
+        // the protocol may have been switched while the worker was busy
+        _importThread = nullptr;
+        on_buttonTcp_toggled(ui->buttonTcp->isChecked());
+    });
+
+    _importThread->start(QThread::LowPriority);
+}
+
+///
+/// \brief DialogMsgParser::showFrames
+/// \param data
+/// \param frames
+///
+void DialogMsgParser::showFrames(const QByteArray& data, const QVector<ModbusFrameRef>& frames)
+{
+    ((FrameListModel*)ui->listViewFrames->model())->reset(data, frames);
+
+    showMessage(nullptr);
+    ui->listViewFrames->setVisible(!frames.isEmpty());
+    if(!frames.isEmpty())
+        ui->listViewFrames->setCurrentIndex(ui->listViewFrames->model()->index(0, 0));
+}
+
+///
+/// \brief DialogMsgParser::showMessage
+/// \param msg
+///
+void DialogMsgParser::showMessage(const ModbusMessage* msg)
+{
+    ui->info->setModbusMessage(msg);
 
     if(_mm) delete _mm;
-    _mm = ModbusMessage::create(data, protocol, QDateTime::currentDateTime(), ui->request->isChecked());
-    ui->info->setModbusMessage(_mm);
+    _mm = msg;
+}
+
+///
+/// \brief FrameListModel::FrameListModel
+/// \param parent
+///
+FrameListModel::FrameListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+///
+/// \brief FrameListModel::rowCount
+/// \return
+///
+int FrameListModel::rowCount(const QModelIndex&) const
+{
+    return _frames.size();
+}
+
+///
+/// \brief FrameListModel::data
+/// \param index
+/// \param role
+/// \return
+///
+QVariant FrameListModel::data(const QModelIndex& index, int role) const
+{
+    if(!index.isValid() || index.row() >= _frames.size())
+        return QVariant();
+
+    const auto& f = _frames[index.row()];
+    switch(role)
+    {
+        case Qt::DisplayRole:
+        {
+            const int maxBytes = 32;
+            const auto bytes = QByteArray::fromRawData(_data.constData() + f.Offset, qMin(f.Length, maxBytes));
+            auto text = formatUInt8Array(_hexView ? DataDisplayMode::Hex : DataDisplayMode::UInt16, bytes);
+            if(f.Length > maxBytes) text += " ...";
+
+            if(f.Timestamp < 0)
+                return QString("%1: %2").arg(index.row() + 1).arg(text);
+
+            return QString("%1: %2 %3 %4").arg(QString::number(index.row() + 1),
+                                                QDateTime::fromMSecsSinceEpoch(f.Timestamp).toString("hh:mm:ss.zzz"),
+                                                QString((f.Dir == ModbusFrameRef::Request) ? QChar(0x2190) : QChar(0x2192)),
+                                                text);
+        }
+
+        case Qt::ToolTipRole:
+            if(f.Dir == ModbusFrameRef::Request)
+            {
+                if(f.Pair < 0) return tr("No response");
+                return tr("Response: %1 (%2 ms)").arg(f.Pair + 1).arg(_frames[f.Pair].Timestamp - f.Timestamp);
+            }
+            else if(f.Dir == ModbusFrameRef::Response)
+            {
+                if(f.Pair < 0) return tr("No request");
+                return tr("Request: %1").arg(f.Pair + 1);
+            }
+        break;
+
+        case Qt::ForegroundRole:
+            if(!f.Valid) return QColor(Qt::red);
+        break;
+    }
+
+    return QVariant();
+}
+
+///
+/// \brief FrameListModel::frame
+/// \param row
+/// \return
+///
+QByteArray FrameListModel::frame(int row) const
+{
+    if(row < 0 || row >= _frames.size())
+        return QByteArray();
+
+    const auto& f = _frames[row];
+    return _data.mid(f.Offset, f.Length);
+}
+
+///
+/// \brief FrameListModel::frameRef
+/// \param row
+/// \return
+///
+ModbusFrameRef FrameListModel::frameRef(int row) const
+{
+    if(row < 0 || row >= _frames.size())
+        return ModbusFrameRef();
+
+    return _frames[row];
 }
@@ -2,13 +2,53 @@
 #define DIALOGMSGPARSER_H
 
 #include <QDialog>
+#include <QThread>
+#include <QPointer>
+#include <QAbstractListModel>
 #include "enums.h"
 #include "modbusmessage.h"
+#include "modbusframeparser.h"
 
 namespace Ui {
 class DialogMsgParser;
 }
 
+///
+/// \brief The FrameListModel class
+/// Frames are kept as offsets into one capture buffer and formatted on demand
+///
+class FrameListModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit FrameListModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role) const override;
+
+    QByteArray frame(int row) const;
+    ModbusFrameRef frameRef(int row) const;
+
+    void reset(const QByteArray& data, const QVector<ModbusFrameRef>& frames){
+        beginResetModel();
+        _data = data;
+        _frames = frames;
+        endResetModel();
+    }
+
+    void setHexView(bool on){
+        beginResetModel();
+        _hexView = on;
+        endResetModel();
+    }
+
+private:
+    QByteArray _data;
+    QVector<ModbusFrameRef> _frames;
+    bool _hexView = false;
+};
+
 ///
 /// \brief The DialogMsgParser class
 ///
@@ -28,10 +68,30 @@ private slots:
     void on_hexView_toggled(bool);
     void on_bytesData_valueChanged(const QByteArray& value);
     void on_pushButtonParse_clicked();
+    void on_pushButtonLoad_clicked();
+    void on_buttonTcp_toggled(bool);
+    void on_frameChanged(const QModelIndex& index);
+    void on_importFinished(const QByteArray& data, const QVector<ModbusFrameRef>& frames, const QString& error);
+    void on_dumpFinished(const QByteArray& data, const QVector<qint64>& gaps, const QVector<ModbusFrameRef>& frames, const QString& error);
+
+private:
+    ModbusMessage::ProtocolType protocol() const;
+    void importCapture(const QString& filename);
+    void importDump(const QString& filename);
+    void parseDump(const QByteArray& data, const QVector<qint64>& gaps);
+    template<typename Importer, typename Function>
+    void startImport(Importer* importer, const QString& label, Function run);
+    void showFrames(const QByteArray& data, const QVector<ModbusFrameRef>& frames);
+    void showMessage(const ModbusMessage* msg);
 
 private:
     Ui::DialogMsgParser *ui;
     const ModbusMessage* _mm;
+    QPointer<QThread> _importThread;
+
+    QByteArray _dumpData;
+    QVector<qint64> _dumpGaps;
+    ModbusMessage::ProtocolType _dumpProtocol;
 };
 
 #endif // DIALOGMSGPARSER_H
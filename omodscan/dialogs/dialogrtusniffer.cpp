@@ -0,0 +1,240 @@
+#include <QMessageBox>
+#include <QAbstractEventDispatcher>
+#include "modbusframeparser.h"
+#include "dialogconnectiondetails.h"
+#include "dialogrtusniffer.h"
+#include "ui_dialogrtusniffer.h"
+
+///
+/// \brief DialogRtuSniffer::DialogRtuSniffer
+/// \param cd
+/// \param mode
+/// \param parent
+///
+DialogRtuSniffer::DialogRtuSniffer(const ConnectionDetails& cd, DataDisplayMode mode, QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::DialogRtuSniffer)
+    ,_connParams(cd)
+{
+    ui->setupUi(this);
+
+    setWindowFlags(Qt::Dialog |
+                   Qt::CustomizeWindowHint |
+                   Qt::WindowTitleHint |
+                   Qt::WindowMaximizeButtonHint);
+
+    _connParams.Type = ConnectionType::Serial;
+
+    ui->logView->setRowLimit(10000);
+    ui->logView->setAutoscroll(true);
+    ui->info->setShowTimestamp(true);
+    ui->hexView->setChecked(mode == DataDisplayMode::Hex);
+    on_hexView_toggled(ui->hexView->isChecked());
+
+    connect(ui->logView->selectionModel(),
+            &QItemSelectionModel::selectionChanged,
+            this, [&](const QItemSelection& sel) {
+                if(!sel.indexes().isEmpty())
+                    ui->info->setModbusMessage(ui->logView->itemAt(sel.indexes().first()));
+            });
+
+    // the log drops its oldest messages, do not keep showing a deleted one
+    connect(ui->logView->model(),
+            &QAbstractItemModel::rowsAboutToBeRemoved,
+            this, [&](const QModelIndex&, int first, int last) {
+                for(int i = first; i <= last; i++)
+                {
+                    if(ui->logView->itemAt(ui->logView->index(i)) == ui->info->modbusMessage())
+                        ui->info->setModbusMessage(nullptr);
+                }
+            });
+    connect(ui->logView->model(),
+            &QAbstractItemModel::modelAboutToBeReset,
+            this, [&]{ ui->info->setModbusMessage(nullptr); });
+
+    updatePortInfo();
+    updateStatus();
+
+    auto dispatcher = QAbstractEventDispatcher::instance();
+    connect(dispatcher, &QAbstractEventDispatcher::awake, this, &DialogRtuSniffer::on_awake);
+}
+
+///
+/// \brief DialogRtuSniffer::~DialogRtuSniffer
+///
+DialogRtuSniffer::~DialogRtuSniffer()
+{
+    stopSniffing();
+    if(_snifferThread)
+    {
+        _snifferThread->quit();
+        _snifferThread->wait();
+    }
+
+    delete ui;
+}
+
+///
+/// \brief DialogRtuSniffer::changeEvent
+/// \param event
+///
+void DialogRtuSniffer::changeEvent(QEvent* event)
+{
+    if (event->type() == QEvent::LanguageChange)
+    {
+        ui->retranslateUi(this);
+        updatePortInfo();
+        updateStatus();
+    }
+
+    QDialog::changeEvent(event);
+}
+
+///
+/// \brief DialogRtuSniffer::on_awake
+///
+void DialogRtuSniffer::on_awake()
+{
+    const bool sniffing = !_snifferThread.isNull();
+    ui->pushButtonSettings->setEnabled(!sniffing);
+    ui->pushButtonStart->setText(sniffing ? tr("Stop") : tr("Start"));
+}
+
+///
+/// \brief DialogRtuSniffer::on_hexView_toggled
+/// \param checked
+///
+void DialogRtuSniffer::on_hexView_toggled(bool checked)
+{
+    const auto mode = checked ? DataDisplayMode::Hex : DataDisplayMode::UInt16;
+    ui->logView->setDataDisplayMode(mode);
+    ui->info->setDataDisplayMode(mode);
+}
+
+///
+/// \brief DialogRtuSniffer::on_pushButtonSettings_clicked
+///
+void DialogRtuSniffer::on_pushButtonSettings_clicked()
+{
+    auto cd = _connParams;
+    DialogConnectionDetails dlg(cd, this);
+    if(dlg.exec() != QDialog::Accepted)
+        return;
+
+    if(cd.Type != ConnectionType::Serial)
+    {
+        QMessageBox::warning(this, windowTitle(), tr("The sniffer listens on a serial port only."));
+        return;
+    }
+
+    _connParams = cd;
+    updatePortInfo();
+}
+
+///
+/// \brief DialogRtuSniffer::on_pushButtonStart_clicked
+///
+void DialogRtuSniffer::on_pushButtonStart_clicked()
+{
+    if(_snifferThread) stopSniffing();
+    else startSniffing();
+}
+
+///
+/// \brief DialogRtuSniffer::on_pushButtonClear_clicked
+///
+void DialogRtuSniffer::on_pushButtonClear_clicked()
+{
+    ui->logView->clear();
+    _frames = _invalidFrames = 0;
+    updateStatus();
+}
+
+///
+/// \brief DialogRtuSniffer::on_frameReceived
+/// \param frame
+/// \param timestamp
+/// \param valid
+///
+void DialogRtuSniffer::on_frameReceived(const QByteArray& frame, const QDateTime& timestamp, bool valid)
+{
+    _frames++;
+    if(!valid) _invalidFrames++;
+
+    // a frame addressed like the last request is most likely its response
+    const int key = (frame.size() > 1) ? (quint8(frame[0]) << 8 | (quint8(frame[1]) & ~QModbusPdu::ExceptionByte)) : -1;
+    const auto msg = ModbusFrameParser::createMessage(frame, ModbusMessage::Rtu, timestamp, valid && key == _lastRequestKey);
+    _lastRequestKey = (valid && msg->isRequest()) ? key : -1;
+
+    ui->logView->addItem(msg);
+    updateStatus();
+}
+
+///
+/// \brief DialogRtuSniffer::on_errorOccurred
+/// \param error
+///
+void DialogRtuSniffer::on_errorOccurred(const QString& error)
+{
+    QMessageBox::warning(this, windowTitle(), error);
+}
+
+///
+/// \brief DialogRtuSniffer::startSniffing
+///
+void DialogRtuSniffer::startSniffing()
+{
+    _sniffer = new ModbusRtuSniffer(_connParams.SerialParams);
+    _snifferThread = new QThread(this);
+    _sniffer->moveToThread(_snifferThread);
+
+    connect(_snifferThread, &QThread::started, _sniffer, &ModbusRtuSniffer::start);
+    connect(_sniffer, &ModbusRtuSniffer::frameReceived, this, &DialogRtuSniffer::on_frameReceived);
+    connect(_sniffer, &ModbusRtuSniffer::errorOccurred, this, &DialogRtuSniffer::on_errorOccurred);
+    connect(_sniffer, &ModbusRtuSniffer::finished, _snifferThread, &QThread::quit);
+    connect(_snifferThread, &QThread::finished, _sniffer, &QObject::deleteLater);
+    connect(_snifferThread, &QThread::finished, _snifferThread, &QObject::deleteLater);
+
+    _lastRequestKey = -1;
+    _snifferThread->start(QThread::TimeCriticalPriority);
+}
+
+///
+/// \brief DialogRtuSniffer::stopSniffing
+///
+void DialogRtuSniffer::stopSniffing()
+{
+    if(_sniffer)
+        QMetaObject::invokeMethod(_sniffer, "stop", Qt::QueuedConnection);
+}
+
+///
+/// \brief DialogRtuSniffer::updatePortInfo
+///
+void DialogRtuSniffer::updatePortInfo()
+{
+    const auto& sp = _connParams.SerialParams;
+
+    QString parity;
+    switch(sp.Parity)
+    {
+        case QSerialPort::EvenParity: parity = "E"; break;
+        case QSerialPort::OddParity: parity = "O"; break;
+        case QSerialPort::SpaceParity: parity = "S"; break;
+        case QSerialPort::MarkParity: parity = "M"; break;
+        default: parity = "N"; break;
+    }
+
+    const auto port = sp.PortName.isEmpty() ? tr("(no port)") : sp.PortName;
+    ui->labelPort->setText(QString("%1: %2, %3%4%5").arg(port, QString::number(sp.BaudRate),
+                                                         QString::number(sp.WordLength), parity,
+                                                         QString::number(sp.StopBits)));
+}
+
+///
+/// \brief DialogRtuSniffer::updateStatus
+///
+void DialogRtuSniffer::updateStatus()
+{
+    ui->labelStatus->setText(tr("Frames: %1, Invalid: %2").arg(_frames).arg(_invalidFrames));
+}
@@ -0,0 +1,56 @@
+#ifndef DIALOGRTUSNIFFER_H
+#define DIALOGRTUSNIFFER_H
+
+#include <QDialog>
+#include <QThread>
+#include <QPointer>
+#include "enums.h"
+#include "connectiondetails.h"
+#include "modbusrtusniffer.h"
+
+namespace Ui {
+class DialogRtuSniffer;
+}
+
+///
+/// \brief The DialogRtuSniffer class
+///
+class DialogRtuSniffer : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DialogRtuSniffer(const ConnectionDetails& cd, DataDisplayMode mode, QWidget *parent = nullptr);
+    ~DialogRtuSniffer();
+
+protected:
+    void changeEvent(QEvent* event) override;
+
+private slots:
+    void on_awake();
+    void on_hexView_toggled(bool);
+    void on_pushButtonSettings_clicked();
+    void on_pushButtonStart_clicked();
+    void on_pushButtonClear_clicked();
+    void on_frameReceived(const QByteArray& frame, const QDateTime& timestamp, bool valid);
+    void on_errorOccurred(const QString& error);
+
+private:
+    void startSniffing();
+    void stopSniffing();
+    void updatePortInfo();
+    void updateStatus();
+
+private:
+    Ui::DialogRtuSniffer *ui;
+    ConnectionDetails _connParams;
+
+    QPointer<QThread> _snifferThread;
+    QPointer<ModbusRtuSniffer> _sniffer;
+
+    int _lastRequestKey = -1;
+    quint64 _frames = 0;
+    quint64 _invalidFrames = 0;
+};
+
+#endif // DIALOGRTUSNIFFER_H
@@ -0,0 +1,280 @@
+#include <QSpinBox>
+#include <QMessageBox>
+#include <QDoubleSpinBox>
+#include <QAbstractEventDispatcher>
+#include "dialogconnectiondetails.h"
+#include "pointtypecombobox.h"
+#include "simulationmodecombobox.h"
+#include "dialogserversimulator.h"
+#include "ui_dialogserversimulator.h"
+
+namespace {
+enum GeneratorColumn
+{
+    PointTypeColumn = 0,
+    AddressColumn,
+    ModeColumn,
+    FromColumn,
+    ToColumn,
+    StepColumn,
+    IntervalColumn
+};
+}
+
+///
+/// \brief DialogServerSimulator::DialogServerSimulator
+/// \param cd
+/// \param parent
+///
+DialogServerSimulator::DialogServerSimulator(const ConnectionDetails& cd, QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::DialogServerSimulator)
+    ,_connParams(cd)
+{
+    ui->setupUi(this);
+
+    setWindowFlags(Qt::Dialog |
+                   Qt::CustomizeWindowHint |
+                   Qt::WindowTitleHint |
+                   Qt::WindowMaximizeButtonHint);
+
+    ui->tableGenerators->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+    ui->tableGenerators->horizontalHeader()->setStretchLastSection(true);
+
+    updateConnectionInfo();
+    on_statisticsChanged(0, 0, 0, 0);
+
+    auto dispatcher = QAbstractEventDispatcher::instance();
+    connect(dispatcher, &QAbstractEventDispatcher::awake, this, &DialogServerSimulator::on_awake);
+}
+
+///
+/// \brief DialogServerSimulator::~DialogServerSimulator
+///
+DialogServerSimulator::~DialogServerSimulator()
+{
+    stopServer();
+    if(_serverThread)
+    {
+        _serverThread->quit();
+        _serverThread->wait();
+    }
+
+    delete ui;
+}
+
+///
+/// \brief DialogServerSimulator::changeEvent
+/// \param event
+///
+void DialogServerSimulator::changeEvent(QEvent* event)
+{
+    if (event->type() == QEvent::LanguageChange)
+    {
+        ui->retranslateUi(this);
+        updateConnectionInfo();
+    }
+
+    QDialog::changeEvent(event);
+}
+
+///
+/// \brief DialogServerSimulator::on_awake
+///
+void DialogServerSimulator::on_awake()
+{
+    const bool running = !_serverThread.isNull();
+    ui->groupBoxServer->setEnabled(!running);
+    ui->groupBoxGenerators->setEnabled(!running);
+    ui->pushButtonRemove->setEnabled(ui->tableGenerators->currentRow() >= 0);
+    ui->pushButtonStart->setText(running ? tr("Stop") : tr("Start"));
+}
+
+///
+/// \brief DialogServerSimulator::on_pushButtonSettings_clicked
+///
+void DialogServerSimulator::on_pushButtonSettings_clicked()
+{
+    DialogConnectionDetails dlg(_connParams, this);
+    if(dlg.exec() == QDialog::Accepted)
+        updateConnectionInfo();
+}
+
+///
+/// \brief DialogServerSimulator::on_pushButtonAdd_clicked
+///
+void DialogServerSimulator::on_pushButtonAdd_clicked()
+{
+    const int row = ui->tableGenerators->rowCount();
+    ui->tableGenerators->insertRow(row);
+
+    auto pointType = new PointTypeComboBox(ui->tableGenerators);
+    pointType->setCurrentPointType(QModbusDataUnit::HoldingRegisters);
+
+    auto address = new QSpinBox(ui->tableGenerators);
+    address->setRange(0, 65535);
+    address->setValue(row);
+
+    auto mode = new SimulationModeComboBox(ui->tableGenerators);
+    mode->setup(QModbusDataUnit::HoldingRegisters);
+
+    auto createSpinBox = [this](double value) {
+        auto spinBox = new QDoubleSpinBox(ui->tableGenerators);
+        spinBox->setDecimals(0);
+        spinBox->setRange(0, 65535);
+        spinBox->setValue(value);
+        return spinBox;
+    };
+    auto from = createSpinBox(0);
+    auto to = createSpinBox(65535);
+    auto step = createSpinBox(1);
+
+    auto interval = new QSpinBox(ui->tableGenerators);
+    interval->setRange(1, 3600);
+    interval->setSuffix(tr(" s"));
+
+    connect(pointType, &PointTypeComboBox::pointTypeChanged, mode, [mode](QModbusDataUnit::RegisterType type) {
+        mode->clear();
+        mode->setup(type);
+    });
+
+    ui->tableGenerators->setCellWidget(row, PointTypeColumn, pointType);
+    ui->tableGenerators->setCellWidget(row, AddressColumn, address);
+    ui->tableGenerators->setCellWidget(row, ModeColumn, mode);
+    ui->tableGenerators->setCellWidget(row, FromColumn, from);
+    ui->tableGenerators->setCellWidget(row, ToColumn, to);
+    ui->tableGenerators->setCellWidget(row, StepColumn, step);
+    ui->tableGenerators->setCellWidget(row, IntervalColumn, interval);
+    ui->tableGenerators->setCurrentCell(row, PointTypeColumn);
+}
+
+///
+/// \brief DialogServerSimulator::on_pushButtonRemove_clicked
+///
+void DialogServerSimulator::on_pushButtonRemove_clicked()
+{
+    const int row = ui->tableGenerators->currentRow();
+    if(row >= 0)
+        ui->tableGenerators->removeRow(row);
+}
+
+///
+/// \brief DialogServerSimulator::on_pushButtonStart_clicked
+///
+void DialogServerSimulator::on_pushButtonStart_clicked()
+{
+    if(_serverThread) stopServer();
+    else startServer();
+}
+
+///
+/// \brief DialogServerSimulator::on_statisticsChanged
+/// \param connections
+/// \param requests
+/// \param exceptions
+/// \param dropped
+///
+void DialogServerSimulator::on_statisticsChanged(int connections, quint64 requests, quint64 exceptions, quint64 dropped)
+{
+    // the simulator reports once a second
+    const quint64 rate = requests - qMin(requests, _lastRequests);
+    _lastRequests = requests;
+
+    ui->labelStatus->setText(tr("Connections: %1, Requests: %2 (%3/s), Exceptions: %4, Dropped: %5").arg(
+                             QString::number(connections), QString::number(requests), QString::number(rate),
+                             QString::number(exceptions), QString::number(dropped)));
+}
+
+///
+/// \brief DialogServerSimulator::on_errorOccurred
+/// \param error
+///
+void DialogServerSimulator::on_errorOccurred(const QString& error)
+{
+    QMessageBox::warning(this, windowTitle(), error);
+}
+
+///
+/// \brief DialogServerSimulator::startServer
+///
+void DialogServerSimulator::startServer()
+{
+    _server = new ModbusServerSimulator(serverParams());
+    _serverThread = new QThread(this);
+    _server->moveToThread(_serverThread);
+
+    connect(_serverThread, &QThread::started, _server, &ModbusServerSimulator::start);
+    connect(_server, &ModbusServerSimulator::statisticsChanged, this, &DialogServerSimulator::on_statisticsChanged);
+    connect(_server, &ModbusServerSimulator::errorOccurred, this, &DialogServerSimulator::on_errorOccurred);
+    connect(_server, &ModbusServerSimulator::finished, _serverThread, &QThread::quit);
+    connect(_serverThread, &QThread::finished, _server, &QObject::deleteLater);
+    connect(_serverThread, &QThread::finished, _serverThread, &QObject::deleteLater);
+
+    on_statisticsChanged(0, 0, 0, 0);
+    _serverThread->start(QThread::TimeCriticalPriority);
+}
+
+///
+/// \brief DialogServerSimulator::stopServer
+///
+void DialogServerSimulator::stopServer()
+{
+    if(_server)
+        QMetaObject::invokeMethod(_server, "stop", Qt::QueuedConnection);
+}
+
+///
+/// \brief DialogServerSimulator::serverParams
+/// \return
+///
+ModbusServerParams DialogServerSimulator::serverParams() const
+{
+    ModbusServerParams params;
+    params.Type = _connParams.Type;
+    params.Port = _connParams.TcpParams.ServicePort;
+    params.SerialParams = _connParams.SerialParams;
+    params.UnitIds = QRange<int>(ui->spinBoxUnitFrom->value(), ui->spinBoxUnitTo->value());
+    params.Latency = ui->spinBoxLatency->value();
+    params.Jitter = ui->spinBoxJitter->value();
+    params.ExceptionRate = ui->spinBoxExceptionRate->value();
+    params.DropRate = ui->spinBoxDropRate->value();
+
+    for(int row = 0; row < ui->tableGenerators->rowCount(); row++)
+    {
+        auto cell = [this, row](int column) { return ui->tableGenerators->cellWidget(row, column); };
+        auto number = [&cell](int column) { return ((QDoubleSpinBox*)cell(column))->value(); };
+
+        const auto type = ((PointTypeComboBox*)cell(PointTypeColumn))->currentPointType();
+        const auto addr = quint16(((QSpinBox*)cell(AddressColumn))->value());
+        const auto range = QRange<double>(number(FromColumn), number(ToColumn));
+
+        ModbusSimulationParams sim;
+        sim.Mode = ((SimulationModeComboBox*)cell(ModeColumn))->currentSimulationMode();
+        sim.Interval = quint32(((QSpinBox*)cell(IntervalColumn))->value());
+        sim.RandomParams.Range = range;
+        sim.IncrementParams.Range = range;
+        sim.IncrementParams.Step = number(StepColumn);
+        sim.DecrementParams.Range = range;
+        sim.DecrementParams.Step = number(StepColumn);
+
+        params.Generators[{ type, addr }] = sim;
+    }
+
+    return params;
+}
+
+///
+/// \brief DialogServerSimulator::updateConnectionInfo
+///
+void DialogServerSimulator::updateConnectionInfo()
+{
+    if(_connParams.Type == ConnectionType::Tcp)
+    {
+        ui->labelConnection->setText(tr("Modbus TCP, port %1").arg(_connParams.TcpParams.ServicePort));
+        return;
+    }
+
+    const auto& sp = _connParams.SerialParams;
+    const auto port = sp.PortName.isEmpty() ? tr("(no port)") : sp.PortName;
+    ui->labelConnection->setText(tr("Modbus RTU, %1: %2 baud").arg(port, QString::number(sp.BaudRate)));
+}
@@ -0,0 +1,52 @@
+#ifndef DIALOGSERVERSIMULATOR_H
+#define DIALOGSERVERSIMULATOR_H
+
+#include <QDialog>
+#include <QThread>
+#include <QPointer>
+#include "connectiondetails.h"
+#include "modbusserversimulator.h"
+
+namespace Ui {
+class DialogServerSimulator;
+}
+
+///
+/// \brief The DialogServerSimulator class
+///
+class DialogServerSimulator : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DialogServerSimulator(const ConnectionDetails& cd, QWidget *parent = nullptr);
+    ~DialogServerSimulator();
+
+protected:
+    void changeEvent(QEvent* event) override;
+
+private slots:
+    void on_awake();
+    void on_pushButtonSettings_clicked();
+    void on_pushButtonAdd_clicked();
+    void on_pushButtonRemove_clicked();
+    void on_pushButtonStart_clicked();
+    void on_statisticsChanged(int connections, quint64 requests, quint64 exceptions, quint64 dropped);
+    void on_errorOccurred(const QString& error);
+
+private:
+    void startServer();
+    void stopServer();
+    void updateConnectionInfo();
+    ModbusServerParams serverParams() const;
+
+private:
+    Ui::DialogServerSimulator *ui;
+    ConnectionDetails _connParams;
+
+    QPointer<QThread> _serverThread;
+    QPointer<ModbusServerSimulator> _server;
+    quint64 _lastRequests = 0;
+};
+
+#endif // DIALOGSERVERSIMULATOR_H
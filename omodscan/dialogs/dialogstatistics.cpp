@@ -0,0 +1,117 @@
+#include <QHeaderView>
+#include "dialogstatistics.h"
+#include "ui_dialogstatistics.h"
+
+///
+/// \brief DialogStatistics::DialogStatistics
+/// \param client
+/// \param parent
+///
+DialogStatistics::DialogStatistics(ModbusClient& client, QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::DialogStatistics)
+    ,_modbusClient(client)
+{
+    ui->setupUi(this);
+
+    setWindowFlags(Qt::Dialog |
+                   Qt::CustomizeWindowHint |
+                   Qt::WindowTitleHint |
+                   Qt::WindowMaximizeButtonHint);
+
+    ui->tableWidget->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+
+    connect(&_timer, &QTimer::timeout, this, &DialogStatistics::updateStatistics);
+    _timer.start(1000);
+
+    updateStatistics();
+}
+
+///
+/// \brief DialogStatistics::~DialogStatistics
+///
+DialogStatistics::~DialogStatistics()
+{
+    delete ui;
+}
+
+///
+/// \brief DialogStatistics::changeEvent
+/// \param event
+///
+void DialogStatistics::changeEvent(QEvent* event)
+{
+    if (event->type() == QEvent::LanguageChange)
+    {
+        ui->retranslateUi(this);
+        updateStatistics();
+    }
+
+    QDialog::changeEvent(event);
+}
+
+///
+/// \brief DialogStatistics::on_pushButtonReset_clicked
+///
+void DialogStatistics::on_pushButtonReset_clicked()
+{
+    _modbusClient.resetStatistics();
+    _lastReplies.clear();
+    updateStatistics();
+}
+
+///
+/// \brief DialogStatistics::updateStatistics
+///
+void DialogStatistics::updateStatistics()
+{
+    const auto& statistics = _modbusClient.statistics();
+    ui->tableWidget->setRowCount(statistics.size());
+
+    auto setText = [&](int row, int column, const QString& text)
+    {
+        auto item = ui->tableWidget->item(row, column);
+        if(!item)
+        {
+            item = new QTableWidgetItem();
+            item->setTextAlignment(Qt::AlignCenter);
+            ui->tableWidget->setItem(row, column, item);
+        }
+        item->setText(text);
+    };
+
+    // a count followed by its share of the requests
+    auto rateText = [](const ModbusStatistics& s, quint64 value)
+    {
+        return value ? QString("%1 (%2%)").arg(QString::number(value), QString::number(s.rate(value), 'f', 1)) : QString("0");
+    };
+
+    // every finished request counts as a poll, whatever its outcome
+    const double elapsed = _lastUpdate.isValid() ? _lastUpdate.restart() / 1000. : 0.;
+    if(!_lastUpdate.isValid()) _lastUpdate.start();
+
+    int row = 0;
+    double totalRate = 0;
+    for(auto it = statistics.cbegin(); it != statistics.cend(); ++it, ++row)
+    {
+        const auto& s = it.value();
+        const quint64 replies = s.Responses + s.Exceptions + s.Timeouts + s.InvalidResponses + s.OtherErrors;
+        const double rate = (elapsed > 0) ? (replies - qMin(replies, _lastReplies.value(it.key()))) / elapsed : 0.;
+        _lastReplies[it.key()] = replies;
+        totalRate += rate;
+
+        setText(row, 0, QString::number(it.key()));
+        setText(row, 1, QString::number(s.Requests));
+        setText(row, 2, QString::number(s.Responses));
+        setText(row, 3, QString::number(rate, 'f', 1));
+        setText(row, 4, rateText(s, s.Timeouts));
+        setText(row, 5, rateText(s, s.Exceptions));
+        setText(row, 6, rateText(s, s.InvalidResponses));
+        setText(row, 7, formatLatency(s.Latency.percentile(50)));
+        setText(row, 8, formatLatency(s.Latency.percentile(95)));
+        setText(row, 9, formatLatency(s.Latency.percentile(99)));
+        setText(row, 10, formatLatency(s.Latency.max()));
+    }
+
+    ui->labelInfo->setText(tr("Total: %1 polls/s. Response times are measured from sending a request to its reply").arg(QString::number(totalRate, 'f', 1)));
+}
@@ -0,0 +1,44 @@
+#ifndef DIALOGSTATISTICS_H
+#define DIALOGSTATISTICS_H
+
+#include <QTimer>
+#include <QDialog>
+#include <QElapsedTimer>
+#include "modbusclient.h"
+
+namespace Ui {
+class DialogStatistics;
+}
+
+///
+/// \brief The DialogStatistics class
+/// Per-device outcome counters, poll rate and response time percentiles of the shared client
+///
+class DialogStatistics : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DialogStatistics(ModbusClient& client, QWidget *parent = nullptr);
+    ~DialogStatistics();
+
+protected:
+    void changeEvent(QEvent* event) override;
+
+private slots:
+    void on_pushButtonReset_clicked();
+
+private:
+    void updateStatistics();
+
+private:
+    Ui::DialogStatistics *ui;
+    ModbusClient& _modbusClient;
+    QTimer _timer;
+
+    // replies at the previous refresh, to turn the counters into a rate
+    QElapsedTimer _lastUpdate;
+    QMap<int, quint64> _lastReplies;
+};
+
+#endif // DIALOGSTATISTICS_H
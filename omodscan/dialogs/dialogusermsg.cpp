@@ -121,7 +121,7 @@ void DialogUserMsg::on_modbusReply(QModbusReply* reply)
     _mm = ModbusMessage::create(reply->rawResult(), protocol, reply->serverAddress(), QDateTime::currentDateTime(), false);
 
     if(protocol == ModbusMessage::Tcp)
-        ((QModbusAduTcp*)_mm->adu())->setTransactionId(reply->property("TransactionId").toInt());
+        ((ModbusMessage*)_mm)->setTransactionId(reply->property("TransactionId").toInt());
 
     ui->responseBuffer->setValue(*_mm);
     ui->responseInfo->setModbusMessage(_mm);
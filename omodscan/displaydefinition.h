@@ -17,6 +17,8 @@ struct DisplayDefinition
     quint16 Length = 50;
     quint16 LogViewLimit = 30;
     bool ZeroBasedAddress = false;
+    bool ReportByException = false;
+    double Deadband = 0;
 
     void normalize()
     {
@@ -26,6 +28,7 @@ struct DisplayDefinition
         PointType = qBound(QModbusDataUnit::DiscreteInputs, PointType, QModbusDataUnit::HoldingRegisters);
         Length = qBound<quint16>(ModbusLimits::lengthRange().from(), Length, ModbusLimits::lengthRange().to());
         LogViewLimit = qBound<quint16>(4, LogViewLimit, 1000);
+        Deadband = qMax(0., Deadband);
     }
 };
 Q_DECLARE_METATYPE(DisplayDefinition)
@@ -39,6 +42,8 @@ inline QSettings& operator <<(QSettings& out, const DisplayDefinition& dd)
     out.setValue("DisplayDefinition/Length",            dd.Length);
     out.setValue("DisplayDefinition/LogViewLimit",      dd.LogViewLimit);
     out.setValue("DisplayDefinition/ZeroBasedAddress",  dd.ZeroBasedAddress);
+    out.setValue("DisplayDefinition/ReportByException", dd.ReportByException);
+    out.setValue("DisplayDefinition/Deadband",          dd.Deadband);
 
     return out;
 }
@@ -58,6 +63,8 @@ inline QSettings& operator >>(QSettings& in, DisplayDefinition& dd)
     dd.Length = in.value("DisplayDefinition/Length", 50).toUInt();
     dd.LogViewLimit = in.value("DisplayDefinition/LogViewLimit", 30).toUInt();
     dd.ZeroBasedAddress = in.value("DisplayDefinition/ZeroBasedAddress").toBool();
+    dd.ReportByException = in.value("DisplayDefinition/ReportByException").toBool();
+    dd.Deadband = in.value("DisplayDefinition/Deadband").toDouble();
 
     dd.normalize();
     return in;
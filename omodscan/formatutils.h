@@ -471,6 +471,89 @@ inline QString formatUInt64Value(QModbusDataUnit::RegisterType pointType, quint1
     return result;
 }
 
+///
+/// \brief valueWidth
+/// \param type
+/// \param mode
+/// \return registers taken by one value
+///
+inline int valueWidth(QModbusDataUnit::RegisterType type, DataDisplayMode mode)
+{
+    if(type == QModbusDataUnit::Coils || type == QModbusDataUnit::DiscreteInputs)
+        return 1;
+
+    switch(mode)
+    {
+        case DataDisplayMode::FloatingPt:
+        case DataDisplayMode::SwappedFP:
+        case DataDisplayMode::Int32:
+        case DataDisplayMode::SwappedInt32:
+        case DataDisplayMode::UInt32:
+        case DataDisplayMode::SwappedUInt32:
+            return 2;
+
+        case DataDisplayMode::DblFloat:
+        case DataDisplayMode::SwappedDbl:
+        case DataDisplayMode::Int64:
+        case DataDisplayMode::SwappedInt64:
+        case DataDisplayMode::UInt64:
+        case DataDisplayMode::SwappedUInt64:
+            return 4;
+
+        default:
+            return 1;
+    }
+}
+
+///
+/// \brief decodeValue
+/// Uses the same decoders as the output window, the byte order is applied to every register
+/// \param type
+/// \param mode
+/// \param order
+/// \param v registers of one value
+/// \return
+///
+inline QVariant decodeValue(QModbusDataUnit::RegisterType type, DataDisplayMode mode, ByteOrder order, const quint16* v)
+{
+    QVariant value;
+    switch(mode)
+    {
+        case DataDisplayMode::Int16: formatInt16Value(type, qint16(v[0]), order, value); break;
+        case DataDisplayMode::FloatingPt: formatFloatValue(type, v[0], v[1], order, false, value); break;
+        case DataDisplayMode::SwappedFP: formatFloatValue(type, v[1], v[0], order, false, value); break;
+        case DataDisplayMode::DblFloat: formatDoubleValue(type, v[0], v[1], v[2], v[3], order, false, value); break;
+        case DataDisplayMode::SwappedDbl: formatDoubleValue(type, v[3], v[2], v[1], v[0], order, false, value); break;
+        case DataDisplayMode::Int32: formatInt32Value(type, v[0], v[1], order, false, value); break;
+        case DataDisplayMode::SwappedInt32: formatInt32Value(type, v[1], v[0], order, false, value); break;
+        case DataDisplayMode::UInt32: formatUInt32Value(type, v[0], v[1], order, false, value); break;
+        case DataDisplayMode::SwappedUInt32: formatUInt32Value(type, v[1], v[0], order, false, value); break;
+        case DataDisplayMode::Int64: formatInt64Value(type, v[0], v[1], v[2], v[3], order, false, value); break;
+        case DataDisplayMode::SwappedInt64: formatInt64Value(type, v[3], v[2], v[1], v[0], order, false, value); break;
+        case DataDisplayMode::UInt64: formatUInt64Value(type, v[0], v[1], v[2], v[3], order, false, value); break;
+        case DataDisplayMode::SwappedUInt64: formatUInt64Value(type, v[3], v[2], v[1], v[0], order, false, value); break;
+        default: formatUInt16Value(type, v[0], order, value); break;
+    }
+    return value;
+}
+
+///
+/// \brief formatPlainValue
+/// Text of a decoded value for files and pipes: no brackets, hex with a 0x prefix and binary with all 16 digits
+/// \param mode
+/// \param value as decodeValue returns it
+/// \return
+///
+inline QString formatPlainValue(DataDisplayMode mode, const QVariant& value)
+{
+    switch(mode)
+    {
+        case DataDisplayMode::Hex: return "0x" + QString("%1").arg(value.toUInt(), 4, 16, QLatin1Char('0')).toUpper();
+        case DataDisplayMode::Binary: return QString("%1").arg(value.toUInt(), 16, 2, QLatin1Char('0'));
+        default: return value.toString();
+    }
+}
+
 ///
 /// \brief formatAddress
 /// \param pointType
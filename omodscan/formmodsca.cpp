@@ -2,7 +2,6 @@
 #include <QPalette>
 #include <QDateTime>
 #include "modbuslimits.h"
-#include "modbusexception.h"
 #include "mainwindow.h"
 #include "dialogwritecoilregister.h"
 #include "dialogwriteholdingregister.h"
@@ -10,21 +9,21 @@
 #include "formmodsca.h"
 #include "ui_formmodsca.h"
 
-QVersionNumber FormModSca::VERSION = QVersionNumber(1, 6);
+QVersionNumber FormModSca::VERSION = QVersionNumber(1, 7);
 
 ///
 /// \brief FormModSca::FormModSca
 /// \param id
 /// \param client
+/// \param scheduler
 /// \param ver
 /// \param parent
 ///
-FormModSca::FormModSca(int id, ModbusClient& client, DataSimulator* simulator, MainWindow* parent)
+FormModSca::FormModSca(int id, ModbusClient& client, PollScheduler& scheduler, DataSimulator* simulator, MainWindow* parent)
     : QWidget(parent)
     , ui(new Ui::FormModSca)
     ,_formId(id)
-    ,_validSlaveResponses(0)
-    ,_noSlaveResponsesCounter(0)
+    ,_pollTask(nullptr)
     ,_modbusClient(client)
     ,_dataSimulator(simulator)
     ,_parent(parent)
@@ -35,8 +34,6 @@ FormModSca::FormModSca(int id, ModbusClient& client, DataSimulator* simulator, M
     ui->setupUi(this);
     setWindowTitle(QString("ModSca%1").arg(_formId));
 
-    _timer.setInterval(1000);
-
     ui->lineEditAddress->setPaddingZeroes(true);
     ui->lineEditAddress->setInputRange(ModbusLimits::addressRange(true));
     ui->lineEditAddress->setValue(0);
@@ -54,13 +51,24 @@ FormModSca::FormModSca(int id, ModbusClient& client, DataSimulator* simulator, M
     ui->outputWidget->setup(dd, protocol, _dataSimulator->simulationMap(dd.DeviceId));
     ui->outputWidget->setFocus();
 
-    connect(ui->statisticWidget, &StatisticWidget::ctrsReseted, ui->outputWidget, &OutputWidget::clearLogView);
-
     connect(&_modbusClient, &ModbusClient::modbusRequest, this, &FormModSca::on_modbusRequest);
     connect(&_modbusClient, &ModbusClient::modbusReply, this, &FormModSca::on_modbusReply);
     connect(&_modbusClient, &ModbusClient::modbusConnected, this, &FormModSca::on_modbusConnected);
     connect(&_modbusClient, &ModbusClient::modbusDisconnected, this, &FormModSca::on_modbusDisconnected);
-    connect(&_timer, &QTimer::timeout, this, &FormModSca::on_timeout);
+
+    // created after the connections above so the traffic log keeps the order of the requests and replies
+    _pollTask = new PollTask(_formId, _modbusClient, scheduler, this);
+    _pollTask->setDefinition(dd);
+    _pollTask->setValueFormat(dataDisplayMode(), byteOrder());
+    connect(_pollTask, &PollTask::dataReceived, ui->outputWidget, &OutputWidget::updateData);
+    connect(_pollTask, &PollTask::statusChanged, this, &FormModSca::on_pollTask_statusChanged);
+    connect(_pollTask, &PollTask::statisticsChanged, this, &FormModSca::on_pollTask_statisticsChanged);
+    connect(_pollTask, &PollTask::numberOfPollsChanged, this, &FormModSca::numberOfPollsChanged);
+    connect(_pollTask, &PollTask::validSlaveResposesChanged, this, &FormModSca::validSlaveResposesChanged);
+
+    ui->statisticWidget->setPollTask(_pollTask);
+    connect(ui->statisticWidget, &StatisticWidget::ctrsReseted, _pollTask, &PollTask::resetStatistics);
+    connect(ui->statisticWidget, &StatisticWidget::ctrsReseted, ui->outputWidget, &OutputWidget::clearLogView);
 
     connect(_dataSimulator, &DataSimulator::simulationStarted, this, &FormModSca::on_simulationStarted);
     connect(_dataSimulator, &DataSimulator::simulationStopped, this, &FormModSca::on_simulationStopped);
@@ -123,7 +131,12 @@ QVector<quint16> FormModSca::data() const
 DisplayDefinition FormModSca::displayDefinition() const
 {
     DisplayDefinition dd;
-    dd.ScanRate = _timer.interval();
+    if(_pollTask)
+    {
+        dd.ScanRate = _pollTask->definition().ScanRate;
+        dd.ReportByException = _pollTask->definition().ReportByException;
+        dd.Deadband = _pollTask->definition().Deadband;
+    }
     dd.DeviceId = ui->lineEditDeviceId->value<int>();
     dd.PointAddress = ui->lineEditAddress->value<int>();
     dd.PointType = ui->comboBoxModbusPointType->currentPointType();
@@ -140,7 +153,7 @@ DisplayDefinition FormModSca::displayDefinition() const
 ///
 void FormModSca::setDisplayDefinition(const DisplayDefinition& dd)
 {
-    _timer.setInterval(dd.ScanRate);
+    _pollTask->setDefinition(dd);
 
     ui->lineEditDeviceId->blockSignals(true);
     ui->lineEditDeviceId->setValue(dd.DeviceId);
@@ -223,6 +236,7 @@ void FormModSca::setDisplayHexAddresses(bool on)
 void FormModSca::setDataDisplayMode(DataDisplayMode mode)
 {
     ui->outputWidget->setDataDisplayMode(mode);
+    _pollTask->setValueFormat(mode, byteOrder());
 }
 
 ///
@@ -241,6 +255,7 @@ ByteOrder FormModSca::byteOrder() const
 void FormModSca::setByteOrder(ByteOrder order)
 {
     ui->outputWidget->setByteOrder(order);
+    _pollTask->setValueFormat(dataDisplayMode(), order);
     emit byteOrderChanged(order);
 }
 
@@ -396,8 +411,8 @@ void FormModSca::print(QPrinter* printer)
     const auto textDevIdType = QString(tr("Device Id: %1\nMODBUS Point Type:\n%2")).arg(ui->lineEditDeviceId->text(), ui->comboBoxModbusPointType->currentText());
     auto rcDevIdType = painter.boundingRect(cx, cy, pageWidth, pageHeight, Qt::TextWordWrap, textDevIdType);
 
-    const auto textStat = QString(tr("Number of Polls: %1\nValid Slave Responses: %2")).arg(QString::number(ui->statisticWidget->numberOfPolls()),
-                                                                                        QString::number(ui->statisticWidget->validSlaveResposes()));
+    const auto textStat = QString(tr("Number of Polls: %1\nValid Slave Responses: %2")).arg(QString::number(_pollTask->numberOfPolls()),
+                                                                                        QString::number(_pollTask->validSlaveResponses()));
     auto rcStat = painter.boundingRect(cx, cy, pageWidth, pageHeight, Qt::TextWordWrap, textStat);
 
     rcTime.moveTopRight({ pageRect.right(), 10 });
@@ -478,7 +493,7 @@ void FormModSca::setDescription(QModbusDataUnit::RegisterType type, quint16 addr
 ///
 void FormModSca::resetCtrs()
 {
-    ui->statisticWidget->resetCtrs();
+    _pollTask->resetStatistics();
 }
 
 ///
@@ -487,7 +502,7 @@ void FormModSca::resetCtrs()
 ///
 uint FormModSca::numberOfPolls() const
 {
-    return ui->statisticWidget->numberOfPolls();
+    return _pollTask->numberOfPolls();
 }
 
 ///
@@ -496,7 +511,7 @@ uint FormModSca::numberOfPolls() const
 ///
 uint FormModSca::validSlaveResposes() const
 {
-    return ui->statisticWidget->validSlaveResposes();
+    return _pollTask->validSlaveResponses();
 }
 
 ///
@@ -508,76 +523,17 @@ void FormModSca::show()
     emit showed();
 }
 
-///
-/// \brief FormModSca::on_timeout
-///
-void FormModSca::on_timeout()
-{
-    if(_modbusClient.state() != QModbusDevice::ConnectedState)
-        return;
-
-    const auto dd = displayDefinition();
-    const auto addr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
-    if(addr + dd.Length <= ModbusLimits::addressRange(dd.ZeroBasedAddress).to())
-    {
-        if(_validSlaveResponses == ui->statisticWidget->validSlaveResposes())
-        {
-            _noSlaveResponsesCounter++;
-            if(_noSlaveResponsesCounter > _modbusClient.numberOfRetries())
-            {
-                ui->outputWidget->setStatus(tr("No Responses from Slave Device"));
-            }
-        }
-
-        _modbusClient.sendReadRequest(dd.PointType, addr, dd.Length, dd.DeviceId, _formId);
-    }
-}
-
 ///
 /// \brief FormModSca::beginUpdate
+/// Hands the current definition to the poll task and restarts it
 ///
 void FormModSca::beginUpdate()
 {
-    if(_modbusClient.state() != QModbusDevice::ConnectedState)
-        return;
+    // the editors report their initial values before the task exists
+    if(!_pollTask) return;
 
-    const auto dd = displayDefinition();
-    const auto addr = dd.PointAddress - (dd.ZeroBasedAddress ?  0 : 1);
-    if(addr + dd.Length <= ModbusLimits::addressRange(dd.ZeroBasedAddress).to())
-        _modbusClient.sendReadRequest(dd.PointType, addr, dd.Length, dd.DeviceId, _formId);
-    else
-        ui->outputWidget->setStatus(tr("No Scan: Invalid Data Length Specified"));
-
-    _timer.start();
-    // _timer.start(100);
-}
-
-///
-/// \brief FormModSca::isValidReply
-/// \param reply
-/// \return
-///
-bool FormModSca::isValidReply(const QModbusReply* reply) const
-{
-    const auto dd = displayDefinition();
-    const auto data = reply->result();
-    const auto response = reply->rawResult();
-    const auto addr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
-
-    switch(response.functionCode())
-    {
-        case QModbusPdu::ReadCoils:
-        case QModbusPdu::ReadDiscreteInputs:
-            return (data.startAddress() == addr) && (data.valueCount() - dd.Length) < 8;
-        break;
-
-        case QModbusPdu::ReadInputRegisters:
-        case QModbusPdu::ReadHoldingRegisters:
-            return (data.valueCount() == dd.Length) && (data.startAddress() == addr);
-
-        default:
-            return true;
-    }
+    _pollTask->setDefinition(displayDefinition());
+    _pollTask->start();
 }
 
 ///
@@ -605,20 +561,6 @@ void FormModSca::logRequest(int requestId, int deviceId, int transactionId, cons
 void FormModSca::on_modbusRequest(int requestId, int deviceId, int transactionId, const QModbusRequest& request)
 {
    logRequest(requestId, deviceId, transactionId, request);
-
-    switch(request.functionCode())
-    {
-        case QModbusPdu::ReadCoils:
-        case QModbusPdu::ReadDiscreteInputs:
-        case QModbusPdu::ReadHoldingRegisters:
-        case QModbusPdu::ReadInputRegisters:
-            if(requestId == _formId)
-                ui->statisticWidget->increaseNumberOfPolls();
-        break;
-
-        default:
-        break;
-    }
 }
 
 ///
@@ -654,52 +596,6 @@ void FormModSca::on_modbusReply(QModbusReply* reply)
     if(!reply) return;
 
     logReply(reply);
-
-    const auto response = reply->rawResult();
-    const bool hasError = reply->error() != QModbusDevice::NoError;
-
-    switch(response.functionCode())
-    {
-        case QModbusRequest::ReadCoils:
-        case QModbusRequest::ReadDiscreteInputs:
-        case QModbusRequest::ReadInputRegisters:
-        case QModbusRequest::ReadHoldingRegisters:
-        break;
-
-        default:
-            if(!hasError) beginUpdate();
-        return;
-    }
-
-    if(reply->property("RequestId").toInt() != _formId)
-    return;
-
-    if (!hasError)
-    {
-        if(!isValidReply(reply))
-        {
-            ui->outputWidget->setStatus(tr("Received Invalid Response MODBUS Query"));
-        }
-        else
-        {
-            ui->outputWidget->updateData(reply->result());
-            ui->outputWidget->setStatus(QString());
-            ui->statisticWidget->increaseValidSlaveResponses();
-        }
-    }
-    else if (reply->error() == QModbusDevice::ProtocolError)
-    {
-        const auto ex = ModbusException(response.exceptionCode());
-        const auto errorString = QString("%1 (%2)").arg(ex, formatUInt8Value(DataDisplayMode::Hex, ex));
-        ui->outputWidget->setStatus(errorString);
-    }
-    else
-    {
-        ui->outputWidget->setStatus(reply->errorString());
-    }
-
-    _noSlaveResponsesCounter = 0;
-    _validSlaveResponses = ui->statisticWidget->validSlaveResposes();
 }
 
 ///
@@ -719,7 +615,7 @@ void FormModSca::on_modbusConnected(const ConnectionDetails&)
 ///
 void FormModSca::on_modbusDisconnected(const ConnectionDetails&)
 {
-    _timer.stop();
+    _pollTask->stop();
     ui->outputWidget->setStatus(tr("Device NOT CONNECTED!"));
 }
 
@@ -853,21 +749,43 @@ void FormModSca::on_outputWidget_itemDoubleClicked(quint16 addr, const QVariant&
 }
 
 ///
-/// \brief FormModSca::on_statisticWidget_numberOfPollsChanged
-/// \param value
+/// \brief FormModSca::on_pollTask_statusChanged
+/// \param status
+/// \param details
 ///
-void FormModSca::on_statisticWidget_numberOfPollsChanged(uint value)
+void FormModSca::on_pollTask_statusChanged(PollTask::Status status, const QString& details)
 {
-    emit numberOfPollsChanged(value);
+    switch(status)
+    {
+        case PollTask::Status::Ok:
+            ui->outputWidget->setStatus(QString());
+        break;
+
+        case PollTask::Status::InvalidLength:
+            ui->outputWidget->setStatus(tr("No Scan: Invalid Data Length Specified"));
+        break;
+
+        case PollTask::Status::NoResponse:
+            ui->outputWidget->setStatus(tr("No Responses from Slave Device"));
+        break;
+
+        case PollTask::Status::InvalidResponse:
+            ui->outputWidget->setStatus(tr("Received Invalid Response MODBUS Query"));
+        break;
+
+        case PollTask::Status::Exception:
+        case PollTask::Status::Error:
+            ui->outputWidget->setStatus(details);
+        break;
+    }
 }
 
 ///
-/// \brief FormModSca::on_statisticWidget_validSlaveResposesChanged
-/// \param value
+/// \brief FormModSca::on_pollTask_statisticsChanged
 ///
-void FormModSca::on_statisticWidget_validSlaveResposesChanged(uint value)
+void FormModSca::on_pollTask_statisticsChanged()
 {
-    emit validSlaveResposesChanged(value);
+    ui->statisticWidget->refresh();
 }
 
 ///
@@ -898,12 +816,11 @@ void FormModSca::on_simulationStopped(QModbusDataUnit::RegisterType type, quint1
 
 ///
 /// \brief FormModSca::on_dataSimulated
-/// \param mode
-/// \param type
-/// \param addr
-/// \param value
+/// The display definition is read once for the whole batch of a simulator tick,
+/// the writes queue with the periodic polls so operator writes still go first
+/// \param values
 ///
-void FormModSca::on_dataSimulated(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId, QVariant value)
+void FormModSca::on_dataSimulated(const QVector<SimulatedValue>& values)
 {
     if(_modbusClient.state() != QModbusDevice::ConnectedState)
     {
@@ -911,15 +828,18 @@ void FormModSca::on_dataSimulated(DataDisplayMode mode, QModbusDataUnit::Registe
     }
 
     const auto dd = displayDefinition();
-    if(dd.DeviceId != deviceId)
-    {
-        return;
-    }
-
     const auto pointAddr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
-    if(type == dd.PointType && addr >= pointAddr && addr <= pointAddr + dd.Length)
+
+    QVector<ModbusWriteParams> params;
+    for(auto&& sv : values)
     {
-        const ModbusWriteParams params = { dd.DeviceId, addr, value, mode, byteOrder(), codepage(), true };
-        _modbusClient.writeRegister(type, params, formId());
+        if(dd.DeviceId != sv.DeviceId)
+            continue;
+
+        if(sv.Type == dd.PointType && sv.Address >= pointAddr && sv.Address <= pointAddr + dd.Length)
+            params.push_back({ dd.DeviceId, sv.Address, sv.Value, sv.Mode, byteOrder(), codepage(), true });
     }
+
+    // adjacent simulated points of one tick share a write multiple request
+    _modbusClient.writeRegisters(dd.PointType, params, formId(), ModbusClient::Priority::PeriodicPoll);
 }
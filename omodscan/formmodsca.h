@@ -2,12 +2,12 @@
 #define FORMMODSCA_H
 
 #include <QWidget>
-#include <QTimer>
 #include <QPrinter>
 #include <QVersionNumber>
 #include "enums.h"
 #include "modbusclient.h"
 #include "datasimulator.h"
+#include "polltask.h"
 #include "displaydefinition.h"
 #include "outputwidget.h"
 #include "modbussimulationparams.h"
@@ -18,6 +18,29 @@ namespace Ui {
 class FormModSca;
 }
 
+///
+/// \brief The FormModScaSettings struct
+/// What a window file holds after the form id, readable without creating the window
+///
+struct FormModScaSettings
+{
+    QVersionNumber Version;     ///< of the file, set before reading
+    bool IsMaximized = false;
+    QSize WindowSize;
+    DisplayMode ViewMode = DisplayMode::Data;
+    DataDisplayMode DataMode = DataDisplayMode::UInt16;
+    bool HexAddresses = false;
+    QColor BackgroundColor;
+    QColor ForegroundColor;
+    QColor StatusColor;
+    QFont Font;
+    DisplayDefinition Definition;
+    ByteOrder Order = ByteOrder::Direct;
+    ModbusSimulationMap SimulationMap;
+    AddressDescriptionMap DescriptionMap;
+    QString Codepage;
+};
+
 ///
 /// \brief The FormModSca class
 ///
@@ -31,7 +54,7 @@ class FormModSca : public QWidget
 public:
     static QVersionNumber VERSION;
 
-    explicit FormModSca(int id, ModbusClient& client, DataSimulator* simulator, MainWindow* parent);
+    explicit FormModSca(int id, ModbusClient& client, PollScheduler& scheduler, DataSimulator* simulator, MainWindow* parent);
     ~FormModSca();
 
     int formId() const {
@@ -107,7 +130,6 @@ protected:
     void changeEvent(QEvent* event) override;
 
 private slots:
-    void on_timeout();
     void on_modbusConnected(const ConnectionDetails& cd);
     void on_modbusDisconnected(const ConnectionDetails& cd);
     void on_modbusReply(QModbusReply* reply);
@@ -118,15 +140,14 @@ private slots:
     void on_comboBoxAddressBase_addressBaseChanged(AddressBase base);
     void on_comboBoxModbusPointType_pointTypeChanged(QModbusDataUnit::RegisterType);
     void on_outputWidget_itemDoubleClicked(quint16 addr, const QVariant& value);
-    void on_statisticWidget_numberOfPollsChanged(uint value);
-    void on_statisticWidget_validSlaveResposesChanged(uint value);
+    void on_pollTask_statusChanged(PollTask::Status status, const QString& details);
+    void on_pollTask_statisticsChanged();
     void on_simulationStarted(QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId);
     void on_simulationStopped(QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId);
-    void on_dataSimulated(DataDisplayMode mode, QModbusDataUnit::RegisterType type, quint16 addr, quint8 deviceId, QVariant value);
+    void on_dataSimulated(const QVector<SimulatedValue>& values);
 
 private:
     void beginUpdate();
-    bool isValidReply(const QModbusReply* reply) const;
 
     void logReply(const QModbusReply* reply);
     void logRequest(int requestId, int deviceId, int transactionId, const QModbusRequest& request);
@@ -134,9 +155,7 @@ private:
 private:
     Ui::FormModSca *ui;
     int _formId;
-    uint _validSlaveResponses;
-    uint _noSlaveResponsesCounter;
-    QTimer _timer;
+    PollTask* _pollTask;
     QString _filename;
     ModbusClient& _modbusClient;
     DataSimulator* _dataSimulator;
@@ -256,6 +275,8 @@ inline QDataStream& operator <<(QDataStream& out, const FormModSca* frm)
     out << dd.Length;
     out << dd.LogViewLimit;
     out << dd.ZeroBasedAddress;
+    out << dd.ReportByException;
+    out << dd.Deadband;
 
     out << frm->byteOrder();
     out << frm->simulationMap();
@@ -268,42 +289,24 @@ inline QDataStream& operator <<(QDataStream& out, const FormModSca* frm)
 ///
 /// \brief operator >>
 /// \param in
-/// \param frm
+/// \param settings
 /// \return
 ///
-inline QDataStream& operator >>(QDataStream& in, FormModSca* frm)
+inline QDataStream& operator >>(QDataStream& in, FormModScaSettings& settings)
 {
-    if(!frm) return in;
-    const auto ver = frm->property("Version").value<QVersionNumber>();
-
-    bool isMaximized;
-    in >> isMaximized;
-
-    QSize windowSize;
-    in >> windowSize;
-
-    DisplayMode displayMode;
-    in >> displayMode;
-
-    DataDisplayMode dataDisplayMode;
-    in >> dataDisplayMode;
-
-    bool hexAddresses;
-    in >> hexAddresses;
-
-    QColor bkgClr;
-    in >> bkgClr;
-
-    QColor fgClr;
-    in >> fgClr;
-
-    QColor stCrl;
-    in >> stCrl;
-
-    QFont font;
-    in >> font;
-
-    DisplayDefinition dd;
+    const auto& ver = settings.Version;
+
+    in >> settings.IsMaximized;
+    in >> settings.WindowSize;
+    in >> settings.ViewMode;
+    in >> settings.DataMode;
+    in >> settings.HexAddresses;
+    in >> settings.BackgroundColor;
+    in >> settings.ForegroundColor;
+    in >> settings.StatusColor;
+    in >> settings.Font;
+
+    auto& dd = settings.Definition;
     in >> dd.ScanRate;
     in >> dd.DeviceId;
     in >> dd.PointType;
@@ -317,51 +320,69 @@ inline QDataStream& operator >>(QDataStream& in, FormModSca* frm)
     {
         in >> dd.ZeroBasedAddress;
     }
+    if(ver >= QVersionNumber(1, 7))
+    {
+        in >> dd.ReportByException;
+        in >> dd.Deadband;
+    }
 
-    ByteOrder byteOrder = ByteOrder::Direct;
-    ModbusSimulationMap simulationMap;
     if(ver >= QVersionNumber(1, 1))
     {
-        in >> byteOrder;
-        in >> simulationMap;
+        in >> settings.Order;
+        in >> settings.SimulationMap;
     }
 
-    AddressDescriptionMap descriptionMap;
     if(ver >= QVersionNumber(1, 2))
     {
-        in >> descriptionMap;
+        in >> settings.DescriptionMap;
     }
 
-    QString codepage;
     if(ver >= QVersionNumber(1, 6))
     {
-        in >> codepage;
+        in >> settings.Codepage;
     }
 
+    return in;
+}
+
+///
+/// \brief operator >>
+/// \param in
+/// \param frm
+/// \return
+///
+inline QDataStream& operator >>(QDataStream& in, FormModSca* frm)
+{
+    if(!frm) return in;
+
+    FormModScaSettings settings;
+    settings.Version = frm->property("Version").value<QVersionNumber>();
+    in >> settings;
+
     if(in.status() != QDataStream::Ok)
         return in;
 
     auto wnd = frm->parentWidget();
-    wnd->resize(windowSize);
+    wnd->resize(settings.WindowSize);
     wnd->setWindowState(Qt::WindowActive);
-    if(isMaximized) wnd->setWindowState(Qt::WindowMaximized);
-
-    frm->setDisplayMode(displayMode);
-    frm->setDataDisplayMode(dataDisplayMode);
-    frm->setDisplayHexAddresses(hexAddresses);
-    frm->setBackgroundColor(bkgClr);
-    frm->setForegroundColor(fgClr);
-    frm->setStatusColor(stCrl);
-    frm->setFont(font);
-    frm->setDisplayDefinition(dd);
-    frm->setByteOrder(byteOrder);
-    frm->setCodepage(codepage);
-
-    for(auto&& k : simulationMap.keys())
-        frm->startSimulation(k.first, k.second,  simulationMap[k]);
-
-    for(auto&& k : descriptionMap.keys())
-        frm->setDescription(k.first, k.second, descriptionMap[k]);
+    if(settings.IsMaximized) wnd->setWindowState(Qt::WindowMaximized);
+
+    frm->setDisplayMode(settings.ViewMode);
+    frm->setDataDisplayMode(settings.DataMode);
+    frm->setDisplayHexAddresses(settings.HexAddresses);
+    frm->setBackgroundColor(settings.BackgroundColor);
+    frm->setForegroundColor(settings.ForegroundColor);
+    frm->setStatusColor(settings.StatusColor);
+    frm->setFont(settings.Font);
+    frm->setDisplayDefinition(settings.Definition);
+    frm->setByteOrder(settings.Order);
+    frm->setCodepage(settings.Codepage);
+
+    for(auto&& k : settings.SimulationMap.keys())
+        frm->startSimulation(k.first, k.second, settings.SimulationMap[k]);
+
+    for(auto&& k : settings.DescriptionMap.keys())
+        frm->setDescription(k.first, k.second, settings.DescriptionMap[k]);
 
     return in;
 }
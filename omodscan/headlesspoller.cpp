@@ -0,0 +1,343 @@
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include "formmodsca.h"
+#include "formatutils.h"
+#include "headlesspoller.h"
+
+namespace {
+const quint8 WindowFileMagic = 0x32;
+const quint8 ConfigFileMagic = 0x33;
+const int ReconnectInterval = 5000;
+}
+
+///
+/// \brief HeadlessPoller::HeadlessPoller
+/// \param parent
+///
+HeadlessPoller::HeadlessPoller(QObject* parent)
+    : QObject(parent)
+    ,_out(stdout)
+    ,_err(stderr)
+{
+    connect(&_modbusClient, &ModbusClient::modbusConnected, this, &HeadlessPoller::on_modbusConnected);
+    connect(&_modbusClient, &ModbusClient::modbusDisconnected, this, &HeadlessPoller::on_modbusDisconnected);
+    connect(&_modbusClient, &ModbusClient::modbusConnectionError, this, &HeadlessPoller::on_modbusConnectionError);
+    connect(&_modbusClient, &ModbusClient::modbusError, this, &HeadlessPoller::on_modbusError);
+}
+
+///
+/// \brief HeadlessPoller::load
+/// \param filename a window (.msd) or a workspace config
+/// \return
+///
+bool HeadlessPoller::load(const QString& filename)
+{
+    QFile file(filename);
+    if(!file.open(QFile::ReadOnly))
+    {
+        _errorString = tr("Cannot open %1. %2").arg(filename, file.errorString());
+        return false;
+    }
+
+    char magic = 0;
+    file.getChar(&magic);
+    file.close();
+
+    switch(quint8(magic))
+    {
+        case WindowFileMagic:
+            return loadWindow(filename);
+
+        case ConfigFileMagic:
+            return loadConfig(filename);
+
+        default:
+            _errorString = tr("%1 is neither a window file nor a configuration").arg(filename);
+            return false;
+    }
+}
+
+///
+/// \brief HeadlessPoller::loadWindow
+/// Reads the window with the reader of FormModSca, the view settings are not used
+/// \param filename
+/// \return
+///
+bool HeadlessPoller::loadWindow(const QString& filename)
+{
+    QFile file(filename);
+    if(!file.open(QFile::ReadOnly))
+    {
+        _errorString = tr("Cannot open %1. %2").arg(filename, file.errorString());
+        return false;
+    }
+
+    QDataStream s(&file);
+    s.setByteOrder(QDataStream::BigEndian);
+    s.setVersion(QDataStream::Version::Qt_5_0);
+
+    quint8 magic = 0;
+    s >> magic;
+
+    QVersionNumber ver;
+    s >> ver;
+
+    if(magic != WindowFileMagic || ver > FormModSca::VERSION)
+    {
+        _errorString = tr("%1 has an unsupported format").arg(filename);
+        return false;
+    }
+
+    int formId;
+    s >> formId;
+
+    FormModScaSettings settings;
+    settings.Version = ver;
+    s >> settings;
+
+    if(s.status() != QDataStream::Ok)
+    {
+        _errorString = tr("%1 is corrupted").arg(filename);
+        return false;
+    }
+
+    auto& dd = settings.Definition;
+    dd.normalize();
+
+    const int index = _windows.size();
+
+    Window wnd;
+    wnd.Name = QFileInfo(filename).fileName();
+    wnd.Task = new PollTask(index + 1, _modbusClient, _scheduler, this);
+    wnd.Task->setDefinition(dd);
+    wnd.Mode = settings.DataMode;
+    wnd.Order = settings.Order;
+    wnd.Task->setValueFormat(wnd.Mode, wnd.Order);
+
+    connect(wnd.Task, &PollTask::dataReceived, this, [this, index](const QModbusDataUnit& data, const QBitArray& changed) { on_dataReceived(index, data, changed); });
+    connect(wnd.Task, &PollTask::statusChanged, this, [this, index](PollTask::Status status, const QString& details) { on_statusChanged(index, status, details); });
+
+    _windows.push_back(wnd);
+    return true;
+}
+
+///
+/// \brief HeadlessPoller::loadConfig
+/// Loads the windows listed in a configuration saved by the main window and takes its connection
+/// \param filename
+/// \return
+///
+bool HeadlessPoller::loadConfig(const QString& filename)
+{
+    QFile file(filename);
+    if(!file.open(QFile::ReadOnly))
+    {
+        _errorString = tr("Cannot open %1. %2").arg(filename, file.errorString());
+        return false;
+    }
+
+    QDataStream s(&file);
+    s.setByteOrder(QDataStream::BigEndian);
+    s.setVersion(QDataStream::Version::Qt_5_0);
+
+    quint8 magic = 0;
+    s >> magic;
+
+    QVersionNumber ver;
+    s >> ver;
+
+    if(magic != ConfigFileMagic || ver != QVersionNumber(1, 0))
+    {
+        _errorString = tr("%1 has an unsupported format").arg(filename);
+        return false;
+    }
+
+    QStringList listFilename;
+    s >> listFilename;
+
+    ConnectionDetails connParams;
+    s >> connParams;
+
+    if(s.status() != QDataStream::Ok)
+    {
+        _errorString = tr("%1 is corrupted").arg(filename);
+        return false;
+    }
+
+    for(auto&& wndFilename : listFilename)
+    {
+        if(!wndFilename.isEmpty() && !loadWindow(wndFilename))
+            return false;
+    }
+
+    _connParams = connParams;
+    return true;
+}
+
+///
+/// \brief HeadlessPoller::start
+///
+void HeadlessPoller::start()
+{
+    _stopped = false;
+
+    const auto& cd = _connParams;
+    const auto target = (cd.Type == ConnectionType::Tcp) ?
+                            QString("%1:%2").arg(cd.TcpParams.IPAddress, QString::number(cd.TcpParams.ServicePort)) :
+                            cd.SerialParams.PortName;
+    _err << tr("Polling %1 window(s) on %2").arg(QString::number(_windows.size()), target) << Qt::endl;
+
+    _modbusClient.connectDevice(_connParams);
+}
+
+///
+/// \brief HeadlessPoller::stop
+///
+void HeadlessPoller::stop()
+{
+    _stopped = true;
+    for(auto&& wnd : _windows)
+        wnd.Task->stop();
+
+    _modbusClient.disconnectDevice();
+}
+
+///
+/// \brief HeadlessPoller::on_reconnect
+///
+void HeadlessPoller::on_reconnect()
+{
+    if(!_stopped)
+        _modbusClient.connectDevice(_connParams);
+}
+
+///
+/// \brief HeadlessPoller::on_modbusConnected
+///
+void HeadlessPoller::on_modbusConnected(const ConnectionDetails&)
+{
+    _err << tr("Connected") << Qt::endl;
+
+    for(auto&& wnd : _windows)
+        wnd.Task->start();
+}
+
+///
+/// \brief HeadlessPoller::on_modbusDisconnected
+/// A gateway keeps trying, the connection is opened again after a pause
+///
+void HeadlessPoller::on_modbusDisconnected(const ConnectionDetails&)
+{
+    for(auto&& wnd : _windows)
+        wnd.Task->stop();
+
+    if(!_stopped)
+    {
+        _err << tr("Disconnected, reconnecting in %1 s").arg(ReconnectInterval / 1000) << Qt::endl;
+        QTimer::singleShot(ReconnectInterval, this, &HeadlessPoller::on_reconnect);
+    }
+}
+
+///
+/// \brief HeadlessPoller::on_modbusConnectionError
+/// \param error
+///
+void HeadlessPoller::on_modbusConnectionError(const QString& error)
+{
+    _err << error << Qt::endl;
+}
+
+///
+/// \brief HeadlessPoller::on_modbusError
+/// \param error
+///
+void HeadlessPoller::on_modbusError(const QString& error, int)
+{
+    _err << error << Qt::endl;
+}
+
+///
+/// \brief HeadlessPoller::on_dataReceived
+/// Values are decoded in the data display mode and byte order of the window, multi-register values
+/// at their first address. A report by exception writes a line for each changed point only
+/// \param index
+/// \param data
+/// \param changed the changed registers, empty when the whole block is new
+///
+void HeadlessPoller::on_dataReceived(int index, const QModbusDataUnit& data, const QBitArray& changed)
+{
+    const auto& wnd = _windows.at(index);
+    const auto& dd = wnd.Task->definition();
+    const auto values = data.values();
+    const int width = valueWidth(dd.PointType, wnd.Mode);
+
+    QStringList block;
+    for(int i = 0; i + width <= values.size(); i += width)
+    {
+        if(!changed.isEmpty() && !changed.testBit(i))
+            continue;
+
+        const auto text = formatPlainValue(wnd.Mode, decodeValue(dd.PointType, wnd.Mode, wnd.Order, values.constData() + i));
+        if(changed.isEmpty())
+            block << text;
+        else
+            print(index, dd.PointAddress + i, { text });
+    }
+
+    if(changed.isEmpty())
+        print(index, dd.PointAddress, block);
+}
+
+///
+/// \brief HeadlessPoller::on_statusChanged
+/// Failed replies are written in place of the values, a missing one shows up as a timeout already
+/// \param index
+/// \param status
+/// \param details
+///
+void HeadlessPoller::on_statusChanged(int index, PollTask::Status status, const QString& details)
+{
+    const auto& dd = _windows.at(index).Task->definition();
+    switch(status)
+    {
+        case PollTask::Status::Ok:
+        case PollTask::Status::NoResponse:
+        break;
+
+        case PollTask::Status::InvalidLength:
+            print(index, dd.PointAddress, { QStringLiteral("ERROR"), tr("Invalid Data Length Specified") });
+        break;
+
+        case PollTask::Status::InvalidResponse:
+            print(index, dd.PointAddress, { QStringLiteral("ERROR"), tr("Invalid Response") });
+        break;
+
+        case PollTask::Status::Exception:
+        case PollTask::Status::Error:
+            print(index, dd.PointAddress, { QStringLiteral("ERROR"), details });
+        break;
+    }
+}
+
+///
+/// \brief HeadlessPoller::print
+/// Writes time, window, device id, address and the values or the error
+/// \param index
+/// \param address of the first value
+/// \param values
+///
+void HeadlessPoller::print(int index, int address, const QStringList& values)
+{
+    const auto& wnd = _windows.at(index);
+    const auto& dd = wnd.Task->definition();
+
+    QStringList fields;
+    fields << QDateTime::currentDateTime().toString(Qt::ISODateWithMs);
+    fields << wnd.Name;
+    fields << QString::number(dd.DeviceId);
+    fields << formatAddress(dd.PointType, address, false);
+    fields << values;
+
+    _out << fields.join(';') << Qt::endl;
+}
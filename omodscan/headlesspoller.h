@@ -0,0 +1,75 @@
+#ifndef HEADLESSPOLLER_H
+#define HEADLESSPOLLER_H
+
+#include <QVector>
+#include <QTextStream>
+#include "modbusclient.h"
+#include "polltask.h"
+
+///
+/// \brief The HeadlessPoller class
+/// Polls the windows saved in .msd files or a workspace config without creating any widget,
+/// every reply is written to stdout as a line of semicolon separated values
+///
+class HeadlessPoller : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit HeadlessPoller(QObject* parent = nullptr);
+
+    bool load(const QString& filename);
+    QString errorString() const {
+        return _errorString;
+    }
+
+    ConnectionDetails connectionDetails() const {
+        return _connParams;
+    }
+    void setConnectionDetails(const ConnectionDetails& cd) {
+        _connParams = cd;
+    }
+
+    int windowCount() const {
+        return _windows.size();
+    }
+
+public slots:
+    void start();
+    void stop();
+
+private slots:
+    void on_reconnect();
+    void on_modbusConnected(const ConnectionDetails& cd);
+    void on_modbusDisconnected(const ConnectionDetails& cd);
+    void on_modbusConnectionError(const QString& error);
+    void on_modbusError(const QString& error, int requestId);
+    void on_dataReceived(int index, const QModbusDataUnit& data, const QBitArray& changed);
+    void on_statusChanged(int index, PollTask::Status status, const QString& details);
+
+private:
+    bool loadWindow(const QString& filename);
+    bool loadConfig(const QString& filename);
+    void print(int index, int address, const QStringList& values);
+
+private:
+    struct Window
+    {
+        QString Name;
+        PollTask* Task = nullptr;
+        DataDisplayMode Mode = DataDisplayMode::UInt16;
+        ByteOrder Order = ByteOrder::Direct;
+    };
+
+    ModbusClient _modbusClient;
+    PollScheduler _scheduler;
+    ConnectionDetails _connParams;
+    QVector<Window> _windows;
+
+    bool _stopped = false;
+    QString _errorString;
+    QTextStream _out;
+    QTextStream _err;
+};
+
+#endif // HEADLESSPOLLER_H
@@ -1,5 +1,100 @@
 #include <QApplication>
+#include <QCommandLineParser>
 #include "mainwindow.h"
+#include "headlesspoller.h"
+
+///
+/// \brief isHeadless
+/// \param argc
+/// \param argv
+/// \return true when the widgets must not be created
+///
+static bool isHeadless(int argc, char *argv[])
+{
+    for(int i = 1; i < argc; i++)
+    {
+        if(qstrcmp(argv[i], "--headless") == 0)
+            return true;
+    }
+    return false;
+}
+
+///
+/// \brief runHeadless
+/// Polls the given windows without a GUI, the connection comes from a configuration or the command line
+/// \param argc
+/// \param argv
+/// \return
+///
+static int runHeadless(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationName(APP_NAME);
+    a.setApplicationVersion(APP_VERSION);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QCoreApplication::translate("main", "Polls saved windows and writes every reply to stdout."));
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption headlessOption("headless", QCoreApplication::translate("main", "Run without the GUI."));
+    const QCommandLineOption tcpOption("tcp", QCoreApplication::translate("main", "Modbus TCP server to poll."), "host[:port]");
+    const QCommandLineOption serialOption("serial", QCoreApplication::translate("main", "Serial port to poll over Modbus RTU."), "port");
+    const QCommandLineOption baudOption("baud", QCoreApplication::translate("main", "Baud rate of the serial port."), "rate", "9600");
+    const QCommandLineOption timeoutOption("timeout", QCoreApplication::translate("main", "Response timeout."), "ms");
+    parser.addOptions({ headlessOption, tcpOption, serialOption, baudOption, timeoutOption });
+    parser.addPositionalArgument("files", QCoreApplication::translate("main", "Window files (.msd) or a workspace configuration."), "files...");
+    parser.process(a);
+
+    QTextStream err(stderr);
+    if(parser.positionalArguments().isEmpty())
+    {
+        err << QCoreApplication::translate("main", "No window file or configuration given") << Qt::endl;
+        return 1;
+    }
+
+    HeadlessPoller poller;
+    for(auto&& filename : parser.positionalArguments())
+    {
+        if(!poller.load(filename))
+        {
+            err << poller.errorString() << Qt::endl;
+            return 1;
+        }
+    }
+
+    auto cd = poller.connectionDetails();
+    if(parser.isSet(tcpOption))
+    {
+        const auto target = parser.value(tcpOption).split(':');
+        cd.Type = ConnectionType::Tcp;
+        cd.TcpParams.IPAddress = target.value(0);
+        cd.TcpParams.ServicePort = quint16(target.value(1, "502").toUInt());
+        cd.TcpParams.normalize();
+    }
+    else if(parser.isSet(serialOption))
+    {
+        cd.Type = ConnectionType::Serial;
+        cd.SerialParams.PortName = parser.value(serialOption);
+        cd.SerialParams.BaudRate = QSerialPort::BaudRate(parser.value(baudOption).toInt());
+        cd.SerialParams.normalize();
+    }
+    if(parser.isSet(timeoutOption))
+    {
+        cd.ModbusParams.SlaveResponseTimeOut = parser.value(timeoutOption).toUInt();
+        cd.ModbusParams.normalize();
+    }
+    poller.setConnectionDetails(cd);
+
+    if(poller.windowCount() == 0)
+    {
+        err << QCoreApplication::translate("main", "Nothing to poll") << Qt::endl;
+        return 1;
+    }
+
+    poller.start();
+    return a.exec();
+}
 
 ///
 /// \brief main
@@ -9,6 +104,9 @@
 ///
 int main(int argc, char *argv[])
 {
+    if(isHeadless(argc, argv))
+        return runHeadless(argc, argv);
+
     QApplication a(argc, argv);
     a.setApplicationName(APP_NAME);
     a.setApplicationVersion(APP_VERSION);
@@ -13,6 +13,9 @@
 #include "dialogusermsg.h"
 #include "dialogmsgparser.h"
 #include "dialogaddressscan.h"
+#include "dialogrtusniffer.h"
+#include "dialogstatistics.h"
+#include "dialogserversimulator.h"
 #include "dialogmodbusscanner.h"
 #include "dialogwindowsmanager.h"
 #include "dialogabout.h"
@@ -847,6 +850,39 @@ void MainWindow::on_actionAddressScan_triggered()
     dlg->show();
 }
 
+///
+/// \brief MainWindow::on_actionRtuSniffer_triggered
+///
+void MainWindow::on_actionRtuSniffer_triggered()
+{
+    auto frm = currentMdiChild();
+    const auto mode = frm ? frm->dataDisplayMode() : DataDisplayMode::Hex;
+
+    auto dlg = new DialogRtuSniffer(_connParams, mode, this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose, true);
+    dlg->show();
+}
+
+///
+/// \brief MainWindow::on_actionStatistics_triggered
+///
+void MainWindow::on_actionStatistics_triggered()
+{
+    auto dlg = new DialogStatistics(_modbusClient, this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose, true);
+    dlg->show();
+}
+
+///
+/// \brief MainWindow::on_actionServerSimulator_triggered
+///
+void MainWindow::on_actionServerSimulator_triggered()
+{
+    auto dlg = new DialogServerSimulator(_connParams, this);
+    dlg->setAttribute(Qt::WA_DeleteOnClose, true);
+    dlg->show();
+}
+
 ///
 /// \brief MainWindow::on_actionTextCapture_triggered
 ///
@@ -1119,7 +1155,7 @@ void MainWindow::updateDataDisplayMode(DataDisplayMode mode)
 ///
 FormModSca* MainWindow::createMdiChild(int id)
 {
-    auto frm = new FormModSca(id, _modbusClient, _dataSimulator, this);
+    auto frm = new FormModSca(id, _modbusClient, _pollScheduler, _dataSimulator, this);
     auto wnd = ui->mdiArea->addSubWindow(frm);
     wnd->installEventFilter(this);
     wnd->setAttribute(Qt::WA_DeleteOnClose, true);
@@ -83,6 +83,9 @@ private slots:
     void on_actionUserMsg_triggered();
     void on_actionMsgParser_triggered();
     void on_actionAddressScan_triggered();
+    void on_actionRtuSniffer_triggered();
+    void on_actionStatistics_triggered();
+    void on_actionServerSimulator_triggered();
     void on_actionTextCapture_triggered();
     void on_actionCaptureOff_triggered();
     void on_actionResetCtrs_triggered();
@@ -152,6 +155,7 @@ private:
     QString _fileAutoStart;
     ConnectionDetails _connParams;
     ModbusClient _modbusClient;
+    PollScheduler _pollScheduler;
 
     AnsiMenu* _ansiMenu;
     WindowActionList* _windowActionList;
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <QModbusTcpClient>
 
 #if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
@@ -12,6 +13,13 @@ typedef QModbusRtuSerialMaster QModbusRtuSerialClient;
 #include "modbusexception.h"
 #include "modbusclient.h"
 
+namespace {
+const int MaxTcpInFlight = 4;
+const int StarvationLimit = 8;
+const int MaxWriteRegisters = 123;  ///< per write multiple registers request
+const int MaxWriteCoils = 1968;     ///< per write multiple coils request
+}
+
 ///
 /// \brief ModbusClient::ModbusClient
 /// \param parent
@@ -21,6 +29,7 @@ ModbusClient::ModbusClient(QObject *parent)
     ,_modbusClient(nullptr)
     ,_connectionType(ConnectionType::Serial)
 {
+    _clock.start();
 }
 
 ///
@@ -38,6 +47,8 @@ ModbusClient::~ModbusClient()
 ///
 void ModbusClient::connectDevice(const ConnectionDetails& cd)
 {
+    clearQueue();
+
     if(_modbusClient != nullptr)
     {
         delete _modbusClient;
@@ -124,30 +135,16 @@ QModbusRequest createReadRequest(const QModbusDataUnit& data)
 /// \param request
 /// \param server
 /// \param requestId
+/// \param priority
 ///
-void ModbusClient::sendRawRequest(const QModbusRequest& request, int server, int requestId)
+void ModbusClient::sendRawRequest(const QModbusRequest& request, int server, int requestId, Priority priority)
 {
     if(_modbusClient == nullptr || state() != QModbusDevice::ConnectedState)
     {
         return;
     }
 
-    emit modbusRequest(requestId, server, ++_transactionId, request);
-    if(auto reply = _modbusClient->sendRawRequest(request, server))
-    {
-        reply->setProperty("RequestId", requestId);
-        reply->setProperty("TransactionId", _transactionId);
-        if (!reply->isFinished())
-        {
-            connect(reply, &QModbusReply::finished, this, &ModbusClient::on_readReply);
-        }
-        else
-        {
-            delete reply; // broadcast replies return immediately
-        }
-    }
-    else
-        emit modbusError(tr("Invalid Modbus Request"), requestId);
+    enqueue(priority, { PendingRequest::Raw, request, QModbusDataUnit(), server, requestId });
 }
 
 ///
@@ -157,8 +154,9 @@ void ModbusClient::sendRawRequest(const QModbusRequest& request, int server, int
 /// \param valueCount
 /// \param server
 /// \param requestId
+/// \param priority
 ///
-void ModbusClient::sendReadRequest(QModbusDataUnit::RegisterType pointType, int startAddress, quint16 valueCount, int server, int requestId)
+void ModbusClient::sendReadRequest(QModbusDataUnit::RegisterType pointType, int startAddress, quint16 valueCount, int server, int requestId, Priority priority)
 {
     if(_modbusClient == nullptr || state() != QModbusDevice::ConnectedState)
     {
@@ -169,23 +167,137 @@ void ModbusClient::sendReadRequest(QModbusDataUnit::RegisterType pointType, int
     const auto request = createReadRequest(dataUnit);
     if(!request.isValid()) return;
 
-    emit modbusRequest(requestId, server, ++_transactionId, request);
-    if(auto reply = _modbusClient->sendReadRequest(dataUnit, server))
+    enqueue(priority, { PendingRequest::Read, request, dataUnit, server, requestId });
+}
+
+///
+/// \brief ModbusClient::enqueue
+/// A periodic poll still waiting for its turn is replaced by the newer one of the same window,
+/// periodic writes (simulated values) are all kept
+/// \param priority
+/// \param pending
+///
+void ModbusClient::enqueue(Priority priority, const PendingRequest& pending)
+{
+    auto& queue = _queues[int(priority)];
+    if(priority == Priority::PeriodicPoll && pending.Type == PendingRequest::Read)
     {
-        reply->setProperty("RequestId", requestId);
-        reply->setProperty("TransactionId", _transactionId);
-        reply->setProperty("RequestData", QVariant::fromValue(dataUnit));
-        if (!reply->isFinished())
+        for(auto&& waiting : queue)
+        {
+            if(waiting.Type == PendingRequest::Read && waiting.RequestId == pending.RequestId)
+            {
+                waiting = pending;
+                return;
+            }
+        }
+    }
+
+    queue.enqueue(pending);
+    dispatch();
+}
+
+///
+/// \brief ModbusClient::dispatch
+/// Sends from the highest non-empty class while the link has room. A class passed over
+/// StarvationLimit times in a row is served next, so polls and scans still progress under load
+///
+void ModbusClient::dispatch()
+{
+    const int window = (_connectionType == ConnectionType::Serial) ? 1 : MaxTcpInFlight;
+    while(_inFlight < window && state() == QModbusDevice::ConnectedState)
+    {
+        int next = -1;
+        for(int i = 0; i < PriorityCount && next < 0; i++)
+        {
+            if(!_queues[i].isEmpty() && _bypassed[i] >= StarvationLimit)
+                next = i;
+        }
+        for(int i = 0; i < PriorityCount && next < 0; i++)
         {
-            connect(reply, &QModbusReply::finished, this, &ModbusClient::on_readReply);
+            if(!_queues[i].isEmpty())
+                next = i;
         }
-        else
+
+        if(next < 0)
+            return;
+
+        for(int i = 0; i < PriorityCount; i++)
         {
-            delete reply; // broadcast replies return immediately
+            if(i != next && !_queues[i].isEmpty())
+                _bypassed[i]++;
         }
+        _bypassed[next] = 0;
+
+        send(_queues[next].dequeue());
     }
 }
 
+///
+/// \brief ModbusClient::send
+/// \param pending
+///
+void ModbusClient::send(const PendingRequest& pending)
+{
+    emit modbusRequest(pending.RequestId, pending.Server, ++_transactionId, pending.Request);
+
+    auto reply = (pending.Type == PendingRequest::Read) ?
+                     _modbusClient->sendReadRequest(pending.Data, pending.Server) :
+                     _modbusClient->sendRawRequest(pending.Request, pending.Server);
+    if(!reply)
+    {
+        if(pending.Type == PendingRequest::Raw)
+            emit modbusError(tr("Invalid Modbus Request"), pending.RequestId);
+        return;
+    }
+
+    reply->setProperty("RequestId", pending.RequestId);
+    reply->setProperty("TransactionId", _transactionId);
+    reply->setProperty("Generation", _generation);
+    if(pending.Type == PendingRequest::Read)
+        reply->setProperty("RequestData", QVariant::fromValue(pending.Data));
+
+    if (!reply->isFinished())
+    {
+        _inFlight++;
+        trackRequest(reply, pending.Server);
+        connect(reply, &QModbusReply::finished, this, (pending.Type == PendingRequest::Write) ?
+                                                          &ModbusClient::on_writeReply : &ModbusClient::on_readReply);
+    }
+    else
+    {
+        // broadcast replies return immediately
+        reply->deleteLater();
+    }
+}
+
+///
+/// \brief ModbusClient::clearQueue
+/// Replies still outstanding belong to the previous generation and no longer count as in flight
+///
+void ModbusClient::clearQueue()
+{
+    for(auto&& queue : _queues)
+        queue.clear();
+
+    _bypassed.fill(0);
+    _inFlight = 0;
+    _generation++;
+}
+
+///
+/// \brief ModbusClient::releaseSlot
+/// Frees the slot of a reply sent since the queue was last cleared and sends the next request
+/// \param reply
+///
+void ModbusClient::releaseSlot(const QModbusReply* reply)
+{
+    if(reply->property("Generation").toUInt() != _generation)
+        return;
+
+    _inFlight = qMax(0, _inFlight - 1);
+    dispatch();
+}
+
 ///
 /// \brief createWriteRequest
 /// \param data
@@ -398,12 +510,12 @@ QModbusDataUnit createHoldingRegistersDataUnit(int newStartAddress, const QVecto
 }
 
 ///
-/// \brief ModbusClient::writeRegister
+/// \brief createWriteDataUnit
 /// \param pointType
 /// \param params
-/// \param requestId
+/// \return the registers or coils to write, with the address of the protocol
 ///
-void ModbusClient::writeRegister(QModbusDataUnit::RegisterType pointType, const ModbusWriteParams& params, int requestId)
+QModbusDataUnit createWriteDataUnit(QModbusDataUnit::RegisterType pointType, const ModbusWriteParams& params)
 {
     QModbusDataUnit data;
     const auto addr = params.ZeroBasedAddress ? params.Address : params.Address - 1;
@@ -482,6 +594,35 @@ void ModbusClient::writeRegister(QModbusDataUnit::RegisterType pointType, const
         }
     }
 
+    return data;
+}
+
+///
+/// \brief ModbusClient::writeRegister
+/// \param pointType
+/// \param params
+/// \param requestId
+/// \param priority operator writes go first, periodic ones (simulation) queue with the polls
+///
+void ModbusClient::writeRegister(QModbusDataUnit::RegisterType pointType, const ModbusWriteParams& params, int requestId, Priority priority)
+{
+    writeRegisters(pointType, { params }, requestId, priority);
+}
+
+///
+/// \brief ModbusClient::writeRegisters
+/// Values at adjacent addresses go out together as one write multiple request, a value is never split
+/// between two requests
+/// \param pointType
+/// \param params values of one node in any order
+/// \param requestId
+/// \param priority
+///
+void ModbusClient::writeRegisters(QModbusDataUnit::RegisterType pointType, const QVector<ModbusWriteParams>& params, int requestId, Priority priority)
+{
+    if(params.isEmpty())
+        return;
+
     if(_modbusClient == nullptr ||
        _modbusClient->state() != QModbusDevice::ConnectedState)
     {
@@ -504,33 +645,55 @@ void ModbusClient::writeRegister(QModbusDataUnit::RegisterType pointType, const
         return;
     }
 
+    QVector<QModbusDataUnit> units;
+    for(auto&& p : params)
+    {
+        const auto data = createWriteDataUnit(pointType, p);
+        if(data.valueCount() > 0)
+            units.push_back(data);
+    }
+
+    std::stable_sort(units.begin(), units.end(), [](const QModbusDataUnit& a, const QModbusDataUnit& b) {
+        return a.startAddress() < b.startAddress();
+    });
+
     const bool useMultipleWriteFunc = _modbusClient->property("ForceModbus15And16Func").toBool();
-    const auto request = createWriteRequest(data, useMultipleWriteFunc);
-    if(!request.isValid()) return;
+    const uint maxCount = (pointType == QModbusDataUnit::Coils) ? MaxWriteCoils : MaxWriteRegisters;
+    const int node = params.first().Node;
+
+    QModbusDataUnit run;
+    auto flush = [&]() {
+        const auto request = createWriteRequest(run, useMultipleWriteFunc);
+        if(request.isValid())
+            enqueue(priority, { PendingRequest::Write, request, QModbusDataUnit(), node, requestId });
+    };
 
-    emit modbusRequest(requestId, params.Node, ++_transactionId, request);
-    if(auto reply = _modbusClient->sendRawRequest(request, params.Node))
+    for(auto&& data : units)
     {
-        reply->setProperty("RequestId", requestId);
-        reply->setProperty("TransactionId", _transactionId);
-        if (!reply->isFinished())
-        {
-            connect(reply, &QModbusReply::finished, this, &ModbusClient::on_writeReply);
-        }
-        else
+        if(run.valueCount() > 0 &&
+           data.startAddress() == run.startAddress() + int(run.valueCount()) &&
+           run.valueCount() + data.valueCount() <= maxCount)
         {
-            // broadcast replies return immediately
-            reply->deleteLater();
+            run.setValues(run.values() + data.values());
+            continue;
         }
+
+        if(run.valueCount() > 0)
+            flush();
+
+        run = data;
     }
+
+    flush();
 }
 
 ///
 /// \brief ModbusClient::maskWriteRegister
 /// \param params
 /// \param requestId
+/// \param priority
 ///
-void ModbusClient::maskWriteRegister(const ModbusMaskWriteParams& params, int requestId)
+void ModbusClient::maskWriteRegister(const ModbusMaskWriteParams& params, int requestId, Priority priority)
 {
     if(_modbusClient == nullptr ||
        _modbusClient->state() != QModbusDevice::ConnectedState)
@@ -541,22 +704,7 @@ void ModbusClient::maskWriteRegister(const ModbusMaskWriteParams& params, int re
 
     const auto addr = params.ZeroBasedAddress ? params.Address : params.Address - 1;
     QModbusRequest request(QModbusRequest::MaskWriteRegister, quint16(addr), params.AndMask, params.OrMask);
-    emit modbusRequest(requestId, params.Node, ++_transactionId, request);
-
-    if(auto reply = _modbusClient->sendRawRequest(request, params.Node))
-    {
-        reply->setProperty("RequestId", requestId);
-        reply->setProperty("TransactionId", _transactionId);
-        if (!reply->isFinished())
-        {
-            connect(reply, &QModbusReply::finished, this, &ModbusClient::on_writeReply);
-        }
-        else
-        {
-            // broadcast replies return immediately
-            reply->deleteLater();
-        }
-    }
+    enqueue(priority, { PendingRequest::Write, request, QModbusDataUnit(), params.Node, requestId });
 }
 
 ///
@@ -632,6 +780,8 @@ void ModbusClient::on_readReply()
     auto reply = qobject_cast<QModbusReply*>(sender());
     if (!reply) return;
 
+    trackReply(reply);
+
     QModbusDataUnit unit = reply->result();
     int startAddr = unit.startAddress();
     const auto values = unit.values();  // QVector<quint16>
@@ -641,6 +791,7 @@ void ModbusClient::on_readReply()
 
     emit modbusReply(reply);
     reply->deleteLater();
+    releaseSlot(reply);
 }
 
 ///
@@ -651,6 +802,8 @@ void ModbusClient::on_writeReply()
     auto reply = qobject_cast<QModbusReply*>(sender());
     if (!reply) return;
 
+    trackReply(reply);
+
     const auto raw  = reply->rawResult();
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 4, 0)
@@ -698,6 +851,34 @@ void ModbusClient::on_writeReply()
     }
 
     reply->deleteLater();
+    releaseSlot(reply);
+}
+
+///
+/// \brief ModbusClient::trackRequest
+/// \param reply
+/// \param server
+///
+void ModbusClient::trackRequest(QModbusReply* reply, int server)
+{
+    reply->setProperty("SendTime", _clock.nsecsElapsed());
+    _statistics[server].Requests++;
+}
+
+///
+/// \brief ModbusClient::trackReply
+/// Stores the response time in usecs as the Latency property of the reply
+/// \param reply
+///
+void ModbusClient::trackReply(QModbusReply* reply)
+{
+    const auto sendTime = reply->property("SendTime");
+    if(!sendTime.isValid()) return;
+
+    const qint64 latency = (_clock.nsecsElapsed() - sendTime.toLongLong()) / 1000;
+    reply->setProperty("Latency", latency);
+
+    _statistics[reply->serverAddress()].addReply(reply->error(), latency);
 }
 
 ///
@@ -747,6 +928,7 @@ void ModbusClient::on_stateChanged(QModbusDevice::State state)
         break;
 
         case QModbusDevice::UnconnectedState:
+            clearQueue();
             emit modbusDisconnected(cd);
         break;
 
@@ -1,19 +1,34 @@
 #ifndef MODBUSCLIENT_H
 #define MODBUSCLIENT_H
 
+#include <array>
+#include <QMap>
+#include <QQueue>
 #include <QModbusClient>
+#include <QElapsedTimer>
 #include "connectiondetails.h"
 #include "modbuswriteparams.h"
+#include "modbusstatistics.h"
 
 Q_DECLARE_METATYPE(QModbusDataUnit)
 
 ///
 /// \brief The ModbusClient class
+/// Requests wait in one queue per priority class and only a few are handed to the link at a time,
+/// so operator actions overtake the periodic polls that are already waiting
 ///
 class ModbusClient : public QObject
 {
     Q_OBJECT
 public:
+    enum class Priority
+    {
+        InteractiveWrite = 0,
+        InteractiveRead,
+        PeriodicPoll,
+        BackgroundScan
+    };
+
     explicit ModbusClient(QObject *parent = nullptr);
     ~ModbusClient() override;
 
@@ -33,10 +48,21 @@ public:
     uint numberOfRetries() const;
     void setNumberOfRetries(uint number);
 
-    void sendRawRequest(const QModbusRequest& request, int server, int requestId);
-    void sendReadRequest(QModbusDataUnit::RegisterType pointType, int startAddress, quint16 valueCount, int server, int requestId);
-    void writeRegister(QModbusDataUnit::RegisterType pointType, const ModbusWriteParams& params, int requestId);
-    void maskWriteRegister(const ModbusMaskWriteParams& params, int requestId);
+    void sendRawRequest(const QModbusRequest& request, int server, int requestId, Priority priority = Priority::InteractiveRead);
+    void sendReadRequest(QModbusDataUnit::RegisterType pointType, int startAddress, quint16 valueCount, int server, int requestId,
+                         Priority priority = Priority::PeriodicPoll);
+    void writeRegister(QModbusDataUnit::RegisterType pointType, const ModbusWriteParams& params, int requestId,
+                       Priority priority = Priority::InteractiveWrite);
+    void writeRegisters(QModbusDataUnit::RegisterType pointType, const QVector<ModbusWriteParams>& params, int requestId,
+                        Priority priority = Priority::InteractiveWrite);
+    void maskWriteRegister(const ModbusMaskWriteParams& params, int requestId, Priority priority = Priority::InteractiveWrite);
+
+    const QMap<int, ModbusStatistics>& statistics() const {
+        return _statistics;
+    }
+    void resetStatistics() {
+        _statistics.clear();
+    }
 
 signals:
     void modbusRequest(int requestId, int deviceId, int transactionId, const QModbusRequest& request);
@@ -55,9 +81,45 @@ private slots:
     void on_stateChanged(QModbusDevice::State state);
 
 private:
+    struct PendingRequest
+    {
+        enum Kind
+        {
+            Read,
+            Raw,
+            Write
+        };
+
+        Kind Type;
+        QModbusRequest Request;
+        QModbusDataUnit Data;
+        int Server;
+        int RequestId;
+    };
+
+    void enqueue(Priority priority, const PendingRequest& pending);
+    void dispatch();
+    void send(const PendingRequest& pending);
+    void clearQueue();
+    void releaseSlot(const QModbusReply* reply);
+
+    void trackRequest(QModbusReply* reply, int server);
+    void trackReply(QModbusReply* reply);
+
+private:
+    static constexpr int PriorityCount = int(Priority::BackgroundScan) + 1;
+
+    std::array<QQueue<PendingRequest>, PriorityCount> _queues;
+    std::array<int, PriorityCount> _bypassed = {};
+    int _inFlight = 0;
+    uint _generation = 0;   ///< counts clearQueue() calls, replies carry the one they were sent in
+
     int _transactionId = -1;
     QModbusClient* _modbusClient;
     ConnectionType _connectionType;
+
+    QElapsedTimer _clock;
+    QMap<int, ModbusStatistics> _statistics;
 };
 
 #endif // MODBUSCLIENT_H
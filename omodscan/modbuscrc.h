@@ -0,0 +1,79 @@
+#ifndef MODBUSCRC_H
+#define MODBUSCRC_H
+
+#include <array>
+#include <QtGlobal>
+
+namespace ModbusCrc {
+
+using Table = std::array<std::array<quint16, 256>, 8>;
+
+///
+/// \brief makeTable
+/// Table[0] is the reflected CRC-16/MODBUS (poly 0xA001) byte table,
+/// Table[k] advances Table[k - 1] by one more zero byte for slicing-by-8
+/// \return
+///
+constexpr Table makeTable()
+{
+    Table t{};
+    for(int n = 0; n < 256; n++)
+    {
+        quint16 crc = quint16(n);
+        for(int i = 0; i < 8; i++)
+            crc = (crc & 1) ? quint16((crc >> 1) ^ 0xA001) : quint16(crc >> 1);
+        t[0][n] = crc;
+    }
+
+    for(int k = 1; k < 8; k++)
+    {
+        for(int n = 0; n < 256; n++)
+            t[k][n] = quint16((t[k - 1][n] >> 8) ^ t[0][t[k - 1][n] & 0xFF]);
+    }
+
+    return t;
+}
+
+inline constexpr Table table = makeTable();
+
+///
+/// \brief update
+/// Continues a CRC-16/MODBUS over the buffer in place, eight bytes per step
+/// \param crc
+/// \param data
+/// \param len
+/// \return
+///
+inline quint16 update(quint16 crc, const quint8* data, qint64 len)
+{
+    while(len >= 8)
+    {
+        const quint16 x = crc ^ quint16(data[0] | (data[1] << 8));
+        crc = table[7][x & 0xFF] ^ table[6][x >> 8] ^
+              table[5][data[2]] ^ table[4][data[3]] ^
+              table[3][data[4]] ^ table[2][data[5]] ^
+              table[1][data[6]] ^ table[0][data[7]];
+        data += 8;
+        len -= 8;
+    }
+
+    while(len-- > 0)
+        crc = quint16((crc >> 8) ^ table[0][(crc ^ *data++) & 0xFF]);
+
+    return crc;
+}
+
+///
+/// \brief calculate
+/// \param data
+/// \param len
+/// \return CRC-16/MODBUS, low byte is transmitted first
+///
+inline quint16 calculate(const char* data, qint64 len)
+{
+    return update(0xFFFF, reinterpret_cast<const quint8*>(data), len);
+}
+
+}
+
+#endif // MODBUSCRC_H
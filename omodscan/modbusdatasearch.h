@@ -0,0 +1,176 @@
+#ifndef MODBUSDATASEARCH_H
+#define MODBUSDATASEARCH_H
+
+#include <cmath>
+#include <QVector>
+#include "enums.h"
+#include "numericutils.h"
+#include "modbusdataunit.h"
+
+///
+/// \brief The ModbusSearchParams class
+/// Mask is ANDed with every register as it was received, before the byte order is applied,
+/// for 16-bit values as well as for the registers of 32 and 64-bit ones
+///
+struct ModbusSearchParams
+{
+    DataDisplayMode Mode = DataDisplayMode::UInt16;
+    ByteOrder Order = ByteOrder::Direct;
+    double From = 0;
+    double To = 0;
+    quint16 Mask = 0xFFFF;    ///< applied to the raw registers
+};
+
+///
+/// \brief findUInt16Values
+/// Branch-free range test over each contiguous page, the inner loop is auto-vectorized
+/// \param data
+/// \param params
+/// \param bias 0x8000 to compare as signed values
+/// \return
+///
+inline QVector<int> findUInt16Values(const ModbusDataUnit& data, const ModbusSearchParams& params, quint16 bias)
+{
+    QVector<int> result;
+
+    const double lo = bias ? qMax(params.From, -32768.0) : qMax(params.From, 0.0);
+    const double hi = bias ? qMin(params.To, 32767.0) : qMin(params.To, 65535.0);
+    if(lo > hi) return result;
+
+    const quint16 from = quint16(qint32(std::ceil(lo))) ^ bias;
+    const quint16 width = quint16((quint16(qint32(std::floor(hi))) ^ bias) - from);
+    const quint16 mask = params.Mask;
+    const bool swap = toByteOrderValue<quint16>(0x0102, params.Order) != 0x0102;
+
+    quint8 hits[ModbusDataUnit::PageSize];
+    for(int p = 0; p < data.pageCount(); p++)
+    {
+        const auto values = data.pageValues(p);
+        if(!values) continue;
+
+        const int base = p * ModbusDataUnit::PageSize;
+        const int count = qMin<int>(ModbusDataUnit::PageSize, data.valueCount() - base);
+        for(int i = 0; i < count; i++)
+        {
+            quint16 v = values[i] & mask;
+            v = swap ? quint16((v << 8) | (v >> 8)) : v;
+            v = quint16((v ^ bias) - from);
+            hits[i] = v <= width;
+        }
+
+        for(int i = 0; i < count; i++)
+        {
+            if(hits[i] && data.pageHasValue(p, i))
+                result.push_back(base + i);
+        }
+    }
+
+    return result;
+}
+
+///
+/// \brief findValues
+/// \param data
+/// \param params
+/// \return indexes of the first register of each matching value
+///
+inline QVector<int> findValues(const ModbusDataUnit& data, const ModbusSearchParams& params)
+{
+    switch(params.Mode)
+    {
+        case DataDisplayMode::Binary:
+        case DataDisplayMode::UInt16:
+        case DataDisplayMode::Hex:
+        case DataDisplayMode::Ansi:
+            return findUInt16Values(data, params, 0);
+
+        case DataDisplayMode::Int16:
+            return findUInt16Values(data, params, 0x8000);
+
+        default:
+        break;
+    }
+
+    int words = 2;
+    switch(params.Mode)
+    {
+        case DataDisplayMode::DblFloat:
+        case DataDisplayMode::SwappedDbl:
+        case DataDisplayMode::Int64:
+        case DataDisplayMode::SwappedInt64:
+        case DataDisplayMode::UInt64:
+        case DataDisplayMode::SwappedUInt64:
+            words = 4;
+        break;
+
+        default:
+        break;
+    }
+
+    QVector<int> result;
+    const int count = data.valueCount();
+    const quint16 mask = params.Mask;
+
+    quint16 w[4];
+    for(int i = 0; i + words <= count; i++)
+    {
+        bool present = true;
+        for(int k = 0; k < words && present; k++)
+        {
+            present = data.hasValue(i + k);
+            w[k] = data.value(i + k) & mask;
+        }
+
+        if(!present) continue;
+
+        double value = 0;
+        switch(params.Mode)
+        {
+            case DataDisplayMode::FloatingPt:
+                value = makeFloat(w[0], w[1], params.Order);
+            break;
+            case DataDisplayMode::SwappedFP:
+                value = makeFloat(w[1], w[0], params.Order);
+            break;
+            case DataDisplayMode::Int32:
+                value = makeInt32(w[0], w[1], params.Order);
+            break;
+            case DataDisplayMode::SwappedInt32:
+                value = makeInt32(w[1], w[0], params.Order);
+            break;
+            case DataDisplayMode::UInt32:
+                value = makeUInt32(w[0], w[1], params.Order);
+            break;
+            case DataDisplayMode::SwappedUInt32:
+                value = makeUInt32(w[1], w[0], params.Order);
+            break;
+            case DataDisplayMode::DblFloat:
+                value = makeDouble(w[0], w[1], w[2], w[3], params.Order);
+            break;
+            case DataDisplayMode::SwappedDbl:
+                value = makeDouble(w[3], w[2], w[1], w[0], params.Order);
+            break;
+            case DataDisplayMode::Int64:
+                value = makeInt64(w[0], w[1], w[2], w[3], params.Order);
+            break;
+            case DataDisplayMode::SwappedInt64:
+                value = makeInt64(w[3], w[2], w[1], w[0], params.Order);
+            break;
+            case DataDisplayMode::UInt64:
+                value = (quint64)makeUInt64(w[0], w[1], w[2], w[3], params.Order);
+            break;
+            case DataDisplayMode::SwappedUInt64:
+                value = (quint64)makeUInt64(w[3], w[2], w[1], w[0], params.Order);
+            break;
+            default:
+            break;
+        }
+
+        if(value >= params.From && value <= params.To)
+            result.push_back(i);
+    }
+
+    return result;
+}
+
+#endif // MODBUSDATASEARCH_H
@@ -5,7 +5,7 @@
 /// \param type
 ///
 ModbusDataUnit::ModbusDataUnit(RegisterType type)
-    : QModbusDataUnit(type)
+    : _type(type)
 {
 }
 
@@ -16,9 +16,24 @@ ModbusDataUnit::ModbusDataUnit(RegisterType type)
 /// \param newValueCount
 ///
 ModbusDataUnit::ModbusDataUnit(RegisterType type, int newStartAddress, quint16 newValueCount)
-    : QModbusDataUnit(type, newStartAddress, newValueCount)
+    : _type(type)
+    ,_startAddress(newStartAddress)
+    ,_valueCount(newValueCount)
 {
-    _hasValues.resize(newValueCount);
+    _pages.resize((newValueCount + PageSize - 1) / PageSize);
+}
+
+///
+/// \brief ModbusDataUnit::value
+/// \param index
+/// \return
+///
+quint16 ModbusDataUnit::value(qsizetype index) const
+{
+    if(index < 0 || index >= _valueCount) return 0;
+
+    const auto p = _pages.at(index / PageSize).constData();
+    return p ? p->Values[index % PageSize] : 0;
 }
 
 ///
@@ -28,8 +43,10 @@ ModbusDataUnit::ModbusDataUnit(RegisterType type, int newStartAddress, quint16 n
 ///
 bool ModbusDataUnit::hasValue(qsizetype index) const
 {
-    if(index < 0 || index >= _hasValues.count()) return false;
-    return _hasValues.at(index);
+    if(index < 0 || index >= _valueCount) return false;
+
+    const auto p = _pages.at(index / PageSize).constData();
+    return p && p->Presence.test(index % PageSize);
 }
 
 ///
@@ -39,6 +56,69 @@ bool ModbusDataUnit::hasValue(qsizetype index) const
 ///
 void ModbusDataUnit::setValue(qsizetype index, quint16 newValue)
 {
-    QModbusDataUnit::setValue(index, newValue);
-    if(index >=0 && index < _hasValues.count()) _hasValues[index] = true;
+    if(index < 0 || index >= _valueCount) return;
+
+    auto p = page(index);
+    p->Values[index % PageSize] = newValue;
+    p->Presence.set(index % PageSize);
+}
+
+///
+/// \brief ModbusDataUnit::setValues
+/// \param index
+/// \param newValues
+///
+void ModbusDataUnit::setValues(qsizetype index, const QVector<quint16>& newValues)
+{
+    const qsizetype last = qMin<qsizetype>(index + newValues.size(), _valueCount);
+    for(qsizetype i = qMax<qsizetype>(0, index); i < last; )
+    {
+        auto p = page(i);
+        const qsizetype pageEnd = qMin<qsizetype>(last, (i / PageSize + 1) * PageSize);
+        for(; i < pageEnd; i++)
+        {
+            p->Values[i % PageSize] = newValues.at(i - index);
+            p->Presence.set(i % PageSize);
+        }
+    }
+}
+
+///
+/// \brief ModbusDataUnit::pageValues
+/// \param page
+/// \return contiguous page values or nullptr when the page was never written
+///
+const quint16* ModbusDataUnit::pageValues(int page) const
+{
+    if(page < 0 || page >= _pages.size()) return nullptr;
+
+    const auto p = _pages.at(page).constData();
+    return p ? p->Values : nullptr;
+}
+
+///
+/// \brief ModbusDataUnit::pageHasValue
+/// \param page
+/// \param offset
+/// \return
+///
+bool ModbusDataUnit::pageHasValue(int page, int offset) const
+{
+    if(page < 0 || page >= _pages.size()) return false;
+
+    const auto p = _pages.at(page).constData();
+    return p && p->Presence.test(offset);
+}
+
+///
+/// \brief ModbusDataUnit::page
+/// \param index
+/// \return the page holding index, allocated on first write
+///
+ModbusDataUnit::Page* ModbusDataUnit::page(qsizetype index)
+{
+    auto& p = _pages[index / PageSize];
+    if(!p) p = new Page;
+
+    return p.data();
 }
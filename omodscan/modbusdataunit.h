@@ -1,23 +1,53 @@
 #ifndef MODBUSDATAUNIT_H
 #define MODBUSDATAUNIT_H
 
+#include <bitset>
+#include <QVector>
+#include <QSharedData>
 #include <QModbusDataUnit>
 
 ///
 /// \brief The ModbusDataUnit class
+/// Sparse register store: values are kept in fixed-size pages
+/// that are allocated on first write, so memory tracks the populated address space
 ///
-class ModbusDataUnit : public QModbusDataUnit
+class ModbusDataUnit
 {
 public:
+    using RegisterType = QModbusDataUnit::RegisterType;
+    static constexpr int PageSize = 256;
+
     ModbusDataUnit() = default;
     explicit ModbusDataUnit(RegisterType type);
     explicit ModbusDataUnit(RegisterType type, int newStartAddress, quint16 newValueCount);
 
+    RegisterType registerType() const { return _type; }
+    int startAddress() const { return _startAddress; }
+    uint valueCount() const { return _valueCount; }
+
+    quint16 value(qsizetype index) const;
     bool hasValue(qsizetype index) const;
     void setValue(qsizetype index, quint16 newValue);
+    void setValues(qsizetype index, const QVector<quint16>& newValues);
+
+    int pageCount() const { return _pages.size(); }
+    const quint16* pageValues(int page) const;
+    bool pageHasValue(int page, int offset) const;
+
+private:
+    struct Page : public QSharedData
+    {
+        quint16 Values[PageSize] = {};
+        std::bitset<PageSize> Presence;
+    };
+
+    Page* page(qsizetype index);
 
 private:
-    QVector<bool> _hasValues;
+    RegisterType _type = QModbusDataUnit::Invalid;
+    int _startAddress = 0;
+    uint _valueCount = 0;
+    QVector<QSharedDataPointer<Page>> _pages;
 };
 
 #endif // MODBUSDATAUNIT_H
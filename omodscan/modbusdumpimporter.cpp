@@ -0,0 +1,101 @@
+#include <limits>
+#include <QFile>
+#include <QThread>
+#include "modbusdumpimporter.h"
+
+namespace {
+const qint64 ReadChunkSize = 1024 * 1024;
+const int ReadProgress = 40;
+const int HexDumpProgress = 50;
+}
+
+///
+/// \brief ModbusDumpImporter::ModbusDumpImporter
+/// \param protocol
+/// \param parent
+///
+ModbusDumpImporter::ModbusDumpImporter(ModbusMessage::ProtocolType protocol, QObject* parent)
+    : QObject(parent)
+    ,_protocol(protocol)
+{
+    qRegisterMetaType<QVector<qint64>>();
+    qRegisterMetaType<QVector<ModbusFrameRef>>();
+}
+
+///
+/// \brief ModbusDumpImporter::importFile
+/// A text file is read as a hex dump with one frame per line, anything else as raw bytes
+/// \param filename
+///
+void ModbusDumpImporter::importFile(const QString& filename)
+{
+    QFile file(filename);
+    if(!file.open(QFile::ReadOnly))
+    {
+        emit finished(QByteArray(), QVector<qint64>(), QVector<ModbusFrameRef>(), tr("Failed to open file!"));
+        return;
+    }
+
+    const qint64 size = qMax<qint64>(1, file.size());
+    QByteArray data;
+    data.reserve(int(qMin<qint64>(file.size(), std::numeric_limits<int>::max())));
+
+    int lastProgress = -1;
+    while(!file.atEnd())
+    {
+        const auto chunk = file.read(ReadChunkSize);
+        if(chunk.isEmpty())
+            break;
+
+        data.append(chunk);
+
+        if(QThread::currentThread()->isInterruptionRequested())
+        {
+            emit finished(QByteArray(), QVector<qint64>(), QVector<ModbusFrameRef>(), QString());
+            return;
+        }
+
+        const int value = int(file.pos() * ReadProgress / size);
+        if(value != lastProgress)
+            emit progress(lastProgress = value);
+    }
+
+    if(file.error() != QFile::NoError)
+    {
+        emit finished(QByteArray(), QVector<qint64>(), QVector<ModbusFrameRef>(), file.errorString());
+        return;
+    }
+
+    QVector<qint64> gaps;
+    if(ModbusFrameParser::isHexDump(data))
+    {
+        data = ModbusFrameParser::fromHexDump(data, &gaps);
+        emit progress(HexDumpProgress);
+    }
+
+    _progressBase = HexDumpProgress;
+    parseData(data, gaps);
+}
+
+///
+/// \brief ModbusDumpImporter::parseData
+/// Cancelling keeps the frames found so far
+/// \param data
+/// \param gaps
+///
+void ModbusDumpImporter::parseData(const QByteArray& data, const QVector<qint64>& gaps)
+{
+    const qint64 size = qMax<qint64>(1, data.size());
+    int lastProgress = -1;
+
+    const auto frames = ModbusFrameParser(_protocol).parse(data, gaps, [&](qint64 pos)
+    {
+        const int value = _progressBase + int(pos * (100 - _progressBase) / size);
+        if(value != lastProgress)
+            emit progress(lastProgress = value);
+
+        return !QThread::currentThread()->isInterruptionRequested();
+    });
+
+    emit finished(data, gaps, frames, QString());
+}
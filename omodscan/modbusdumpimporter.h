@@ -0,0 +1,32 @@
+#ifndef MODBUSDUMPIMPORTER_H
+#define MODBUSDUMPIMPORTER_H
+
+#include <QObject>
+#include "modbusframeparser.h"
+
+///
+/// \brief The ModbusDumpImporter class
+/// Loads a raw or hex dump capture and splits it into frames, meant to run on a worker thread.
+/// The split can be repeated for another protocol without reading the file again
+///
+class ModbusDumpImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ModbusDumpImporter(ModbusMessage::ProtocolType protocol, QObject* parent = nullptr);
+
+public slots:
+    void importFile(const QString& filename);
+    void parseData(const QByteArray& data, const QVector<qint64>& gaps);
+
+signals:
+    void progress(int value);
+    void finished(const QByteArray& data, const QVector<qint64>& gaps, const QVector<ModbusFrameRef>& frames, const QString& error);
+
+private:
+    const ModbusMessage::ProtocolType _protocol;
+    int _progressBase = 0;
+};
+
+#endif // MODBUSDUMPIMPORTER_H
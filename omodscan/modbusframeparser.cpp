@@ -0,0 +1,269 @@
+#include "modbuscrc.h"
+#include "modbusframeparser.h"
+
+namespace {
+const qint64 ProgressStep = 64 * 1024;
+}
+
+///
+/// \brief ModbusFrameParser::ModbusFrameParser
+/// \param protocol
+///
+ModbusFrameParser::ModbusFrameParser(ModbusMessage::ProtocolType protocol)
+    : _protocol(protocol)
+{
+}
+
+///
+/// \brief ModbusFrameParser::parse
+/// \param data
+/// \param gaps sorted offsets where a new frame likely starts, such as the line starts of a hex dump.
+/// A frame ends there when the bytes before it form one, otherwise the search goes on across it,
+/// so frames wrapped over several lines are found
+/// \param progress called every 64 KB with the current offset, parsing stops when it returns false
+/// \return frames in order; bytes that do not form a frame are returned as invalid ones
+///
+QVector<ModbusFrameRef> ModbusFrameParser::parse(const QByteArray& data, const QVector<qint64>& gaps, const ProgressCallback& progress) const
+{
+    QVector<ModbusFrameRef> frames;
+
+    const qint64 size = data.size();
+    auto gap = gaps.cbegin();
+
+    qint64 pos = 0;
+    qint64 junk = -1;
+    qint64 nextProgress = ProgressStep;
+    while(pos < size)
+    {
+        if(progress && pos >= nextProgress)
+        {
+            if(!progress(pos))
+                break;
+
+            nextProgress = pos + ProgressStep;
+        }
+
+        while(gap != gaps.cend() && *gap <= pos)
+            ++gap;
+
+        const qint64 end = (gap != gaps.cend()) ? *gap : size;
+        int length = findFrame(data, pos, end);
+        if(length == 0 && end < size)
+            length = findFrame(data, pos, size);
+
+        if(length > 0)
+        {
+            if(junk >= 0)
+            {
+                frames.push_back({ junk, int(pos - junk), false });
+                junk = -1;
+            }
+
+            frames.push_back({ pos, length, true });
+            pos += length;
+        }
+        else
+        {
+            if(junk < 0) junk = pos;
+
+            // noise ends at a gap
+            if(++pos == end && gap != gaps.cend())
+            {
+                frames.push_back({ junk, int(pos - junk), false });
+                junk = -1;
+            }
+        }
+    }
+
+    if(junk >= 0)
+        frames.push_back({ junk, int(pos - junk), false });
+
+    return frames;
+}
+
+///
+/// \brief ModbusFrameParser::findFrame
+/// \param data
+/// \param pos
+/// \param end
+/// \return frame length or zero
+///
+int ModbusFrameParser::findFrame(const QByteArray& data, qint64 pos, qint64 end) const
+{
+    return (_protocol == ModbusMessage::Rtu) ? findRtuFrame(data, pos, end) : findTcpFrame(data, pos, end);
+}
+
+///
+/// \brief ModbusFrameParser::findRtuFrame
+/// Extends a running CRC byte by byte and stops at the first length whose trailing two bytes match
+/// \param data
+/// \param pos
+/// \param end
+/// \return frame length or zero
+///
+int ModbusFrameParser::findRtuFrame(const QByteArray& data, qint64 pos, qint64 end) const
+{
+    const auto p = reinterpret_cast<const quint8*>(data.constData()) + pos;
+    const int maxLength = int(qMin<qint64>(256, end - pos));
+    if(maxLength < 4 || (p[1] & ~QModbusPdu::ExceptionByte) == 0)
+        return 0;
+
+    quint16 crc = ModbusCrc::update(0xFFFF, p, 2);
+    for(int len = 2; len + 2 <= maxLength; len++)
+    {
+        if((crc & 0xFF) == p[len] && (crc >> 8) == p[len + 1])
+            return len + 2;
+
+        crc = quint16((crc >> 8) ^ ModbusCrc::table[0][(crc ^ p[len]) & 0xFF]);
+    }
+
+    return 0;
+}
+
+///
+/// \brief ModbusFrameParser::findTcpFrame
+/// \param data
+/// \param pos
+/// \param end
+/// \return frame length or zero
+///
+int ModbusFrameParser::findTcpFrame(const QByteArray& data, qint64 pos, qint64 end) const
+{
+    if(end - pos < 8)
+        return 0;
+
+    const auto p = reinterpret_cast<const quint8*>(data.constData()) + pos;
+    const quint16 protocolId = quint16(p[2] << 8 | p[3]);
+    const quint16 length = quint16(p[4] << 8 | p[5]);
+    if(protocolId != 0 || length < 2 || length > 254 || (p[7] & ~QModbusPdu::ExceptionByte) == 0)
+        return 0;
+
+    return (pos + 6 + length <= end) ? 6 + length : 0;
+}
+
+///
+/// \brief ModbusFrameParser::createMessage
+/// Captures do not record the direction, so the frame is decoded as the preferred
+/// direction first and as the other one when it is not valid that way
+/// \param frame
+/// \param protocol
+/// \param timestamp
+/// \param preferResponse
+/// \return
+///
+const ModbusMessage* ModbusFrameParser::createMessage(const QByteArray& frame, ModbusMessage::ProtocolType protocol, const QDateTime& timestamp, bool preferResponse)
+{
+    auto msg = ModbusMessage::create(frame, protocol, timestamp, !preferResponse);
+    if(msg->isValid())
+        return msg;
+
+    delete msg;
+    return ModbusMessage::create(frame, protocol, timestamp, preferResponse);
+}
+
+///
+/// \brief ModbusFrameParser::isHexDump
+/// \param data
+/// \return true when the leading part of data is printable text
+///
+bool ModbusFrameParser::isHexDump(const QByteArray& data)
+{
+    const int count = int(qMin<qint64>(data.size(), 4096));
+    for(int i = 0; i < count; i++)
+    {
+        const quint8 c = data[i];
+        if(c < 0x20 && c != '\t' && c != '\n' && c != '\r')
+            return false;
+        if(c > 0x7E)
+            return false;
+    }
+
+    return count > 0;
+}
+
+///
+/// \brief ModbusFrameParser::fromHexDump
+/// Reads hex byte tokens separated by spaces, commas or semicolons with an optional 0x prefix;
+/// runs of hex digits are split into pairs and tokens with other characters (timestamps, labels) are skipped.
+/// A line's leading offset column, as hexdump -C writes it, is skipped when it matches the bytes read so far
+/// \param text
+/// \param gaps receives the offset of each line start, a hint where a frame starts
+/// \return
+///
+QByteArray ModbusFrameParser::fromHexDump(const QByteArray& text, QVector<qint64>* gaps)
+{
+    QByteArray result;
+    result.reserve(text.size() / 3 + 1);
+
+    auto hexDigit = [](char c) -> int {
+        if(c >= '0' && c <= '9') return c - '0';
+        if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    };
+
+    auto isSeparator = [](char c) {
+        return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '\r' || c == '\n';
+    };
+
+    const char* p = text.constData();
+    const qint64 size = text.size();
+
+    qint64 i = 0;
+    bool lineStart = true;
+    while(i < size)
+    {
+        if(p[i] == '\n')
+        {
+            if(gaps && !result.isEmpty() && (gaps->isEmpty() || gaps->last() != result.size()))
+                gaps->push_back(result.size());
+            lineStart = true;
+            i++;
+            continue;
+        }
+
+        if(isSeparator(p[i]))
+        {
+            i++;
+            continue;
+        }
+
+        qint64 start = i;
+        while(i < size && !isSeparator(p[i]))
+            i++;
+
+        const bool firstToken = lineStart;
+        lineStart = false;
+
+        if(i - start > 2 && p[start] == '0' && (p[start + 1] == 'x' || p[start + 1] == 'X'))
+            start += 2;
+
+        const qint64 len = i - start;
+        bool hex = len > 0 && (len <= 2 || len % 2 == 0);
+        for(qint64 k = start; k < i && hex; k++)
+            hex = hexDigit(p[k]) >= 0;
+
+        if(!hex) continue;
+
+        if(firstToken && len == 8)
+        {
+            qint64 offset = 0;
+            for(qint64 k = start; k < i; k++)
+                offset = offset << 4 | hexDigit(p[k]);
+
+            if(offset == result.size())
+                continue;
+        }
+
+        if(len == 1)
+        {
+            result.append(char(hexDigit(p[start])));
+            continue;
+        }
+
+        for(qint64 k = start; k < i; k += 2)
+            result.append(char(hexDigit(p[k]) << 4 | hexDigit(p[k + 1])));
+    }
+
+    return result;
+}
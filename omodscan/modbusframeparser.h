@@ -0,0 +1,61 @@
+#ifndef MODBUSFRAMEPARSER_H
+#define MODBUSFRAMEPARSER_H
+
+#include <functional>
+#include <QVector>
+#include <QMetaType>
+#include <QByteArray>
+#include "modbusmessage.h"
+
+///
+/// \brief The ModbusFrameRef struct
+/// Location of one frame inside a capture buffer
+///
+struct ModbusFrameRef
+{
+    enum Direction : qint8
+    {
+        Unknown = 0,
+        Request,
+        Response
+    };
+
+    qint64 Offset = 0;
+    int Length = 0;
+    bool Valid = false;
+    Direction Dir = Unknown;
+    int Pair = -1;          ///< index of the matching request or response
+    qint64 Timestamp = -1;  ///< msecs since epoch, -1 when not captured
+};
+Q_DECLARE_METATYPE(ModbusFrameRef)
+
+///
+/// \brief The ModbusFrameParser class
+/// Splits a raw capture into frames. RTU boundaries are found by CRC, TCP boundaries
+/// come from the MBAP header. Known gaps are preferred as boundaries, frames only cross
+/// one when the bytes before it do not form a frame
+///
+class ModbusFrameParser
+{
+public:
+    explicit ModbusFrameParser(ModbusMessage::ProtocolType protocol);
+
+    typedef std::function<bool(qint64 pos)> ProgressCallback;
+
+    QVector<ModbusFrameRef> parse(const QByteArray& data, const QVector<qint64>& gaps = QVector<qint64>(),
+                                  const ProgressCallback& progress = nullptr) const;
+
+    static bool isHexDump(const QByteArray& data);
+    static const ModbusMessage* createMessage(const QByteArray& frame, ModbusMessage::ProtocolType protocol, const QDateTime& timestamp, bool preferResponse = false);
+    static QByteArray fromHexDump(const QByteArray& text, QVector<qint64>* gaps = nullptr);
+
+private:
+    int findFrame(const QByteArray& data, qint64 pos, qint64 end) const;
+    int findRtuFrame(const QByteArray& data, qint64 pos, qint64 end) const;
+    int findTcpFrame(const QByteArray& data, qint64 pos, qint64 end) const;
+
+private:
+    const ModbusMessage::ProtocolType _protocol;
+};
+
+#endif // MODBUSFRAMEPARSER_H
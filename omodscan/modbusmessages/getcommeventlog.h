@@ -73,7 +73,7 @@ public:
     bool isValid() const override {
         return ModbusMessage::isValid() &&
                byteCount() > 0 &&
-               byteCount() == events().size() - 6;
+               byteCount() == dataSize(7) - 6;
     }
 
     ///
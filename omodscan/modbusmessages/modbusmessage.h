@@ -38,29 +38,27 @@ public:
         {
             case Rtu:
             {
-                QByteArray data;
-                QDataStream dataStream(&data, QIODevice::Append);
-                dataStream << quint8(deviceId);
-                dataStream << funcCode;
-                dataStream.writeRawData(pdu.data(), pdu.dataSize());
-                dataStream << QModbusAduRtu::calculateCRC(data, data.length());
-
-                _adu = new QModbusAduRtu(data);
+                _data.reserve(pdu.dataSize() + 4);
+                _data.append(char(deviceId));
+                _data.append(char(funcCode));
+                _data.append(pdu.data());
+
+                const quint16 crc = ModbusCrc::calculate(_data.constData(), _data.size());
+                _data.append(char(crc & 0xFF));
+                _data.append(char(crc >> 8));
             }
             break;
 
             case Tcp:
             {
-                QByteArray data;
-                QDataStream dataStream(&data, QIODevice::Append);
-                dataStream << quint16(0);
-                dataStream << quint16(0);
-                dataStream << quint16(pdu.size() + 1);
-                dataStream << quint8(deviceId);
-                dataStream << funcCode;
-                dataStream.writeRawData(pdu.data(), pdu.dataSize());
-
-                _adu = new QModbusAduTcp(data);
+                const quint16 length = pdu.size() + 1;
+                _data.reserve(pdu.dataSize() + 8);
+                _data.append(4, '\0');
+                _data.append(char(length >> 8));
+                _data.append(char(length & 0xFF));
+                _data.append(char(deviceId));
+                _data.append(char(funcCode));
+                _data.append(pdu.data());
             }
             break;
         }
@@ -74,28 +72,17 @@ public:
     /// \param request
     ///
     explicit ModbusMessage(const QByteArray& data, ProtocolType protocol, const QDateTime& timestamp, bool request)
-        :_protocol(protocol)
+        :_data(data)
+        ,_protocol(protocol)
         ,_request(request)
         ,_timestamp(timestamp)
     {
-        switch(protocol)
-        {
-            case Rtu:
-                _adu = new QModbusAduRtu(data);
-            break;
-
-            case Tcp:
-                _adu = new QModbusAduTcp(data);
-            break;
-        }
     }
 
     ///
     /// \brief ~ModbusMessage
     ///
-    virtual ~ModbusMessage() {
-        delete _adu;
-    };
+    virtual ~ModbusMessage() = default;
 
     ///
     /// \brief create
@@ -132,7 +119,12 @@ public:
     /// \return
     ///
     virtual bool isValid() const {
-        return _adu->isValid();
+        switch(_protocol)
+        {
+            case Rtu: return aduRtu().isValid();
+            case Tcp: return aduTcp().isValid();
+        }
+        return false;
     }
 
     ///
@@ -156,7 +148,7 @@ public:
     /// \return
     ///
     bool isException() const {
-        return _adu->isException();
+        return adu().isException();
     }
 
     ///
@@ -164,7 +156,12 @@ public:
     /// \return
     ///
     int deviceId() const {
-        return _adu->serverAddress();
+        switch(_protocol)
+        {
+            case Rtu: return aduRtu().serverAddress();
+            case Tcp: return aduTcp().serverAddress();
+        }
+        return 0;
     }
 
     ///
@@ -172,7 +169,7 @@ public:
     /// \return
     ///
     ModbusFunction function() const {
-        return ModbusFunction(_adu->functionCode());
+        return ModbusFunction(adu().functionCode());
     }
 
     ///
@@ -180,7 +177,7 @@ public:
     /// \return
     ///
     QModbusPdu::FunctionCode functionCode() const {
-        return (QModbusPdu::FunctionCode)(_adu->functionCode() & ~QModbusPdu::ExceptionByte);
+        return adu().functionCode();
     }
 
     ///
@@ -188,15 +185,46 @@ public:
     /// \return
     ///
     ModbusException exception() const {
-        return ModbusException(_adu->exceptionCode());
+        return ModbusException(adu().exceptionCode());
     }
 
     ///
-    /// \brief deviceId
+    /// \brief adu
+    /// \return view over the frame, valid while the message is alive
+    ///
+    QModbusAdu adu() const {
+        switch(_protocol)
+        {
+            case Rtu: return aduRtu();
+            case Tcp: return aduTcp();
+        }
+        return QModbusAdu(nullptr, 0, 0, 0);
+    }
+
+    ///
+    /// \brief aduRtu
     /// \return
     ///
-    const QModbusAdu* adu() const {
-        return _adu;
+    QModbusAduRtu aduRtu() const {
+        return QModbusAduRtu(_data);
+    }
+
+    ///
+    /// \brief aduTcp
+    /// \return
+    ///
+    QModbusAduTcp aduTcp() const {
+        return QModbusAduTcp(_data);
+    }
+
+    ///
+    /// \brief setTransactionId
+    /// \param id
+    ///
+    void setTransactionId(quint16 id) {
+        if(_protocol != Tcp || _data.size() < 2) return;
+        _data[0] = char(id >> 8);
+        _data[1] = char(id & 0xFF);
     }
 
     ///
@@ -214,32 +242,34 @@ public:
     ///
     QByteArray rawData() const
     {
-        return _adu->rawData();
+        return _data;
     }
 
     ///
     /// \brief operator QByteArray
     ///
     operator QByteArray() const {
-        return _adu->rawData();
+        return _data;
     }
 
 protected:
-    int dataSize() const {
-        return _adu->pdu().dataSize();
+    int dataSize(int idx = 0) const {
+        return qMax(0, adu().pduDataSize() - idx);
     }
 
     quint8 at(int idx) const {
-        const auto data =  _adu->pdu().data();
-        return idx < data.size() ? data.at(idx) : 0;
+        return adu().pduAt(idx);
     }
 
     QByteArray data(int idx, int len = -1) const {
-        return _adu->pdu().data().mid(idx, len);
+        const auto adu = this->adu();
+        if(idx < 0 || idx >= adu.pduDataSize()) return QByteArray();
+        const int size = adu.pduDataSize() - idx;
+        return QByteArray(adu.pduData() + idx, (len < 0 || len > size) ? size : len);
     }
 
 private:
-    QModbusAdu* _adu;
+    QByteArray _data;
     ProtocolType _protocol;
     const bool _request;
     const QDateTime _timestamp;
@@ -99,7 +99,7 @@ public:
     bool isValid() const override {
         return ModbusMessage::isValid() &&
                byteCount() > 0 &&
-               (byteCount() == coilStatus().size() || byteCount() == coilStatus().size() - 1);
+               (byteCount() == dataSize(1) || byteCount() == dataSize(1) - 1);
     }
 
     ///
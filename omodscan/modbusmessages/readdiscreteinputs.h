@@ -98,7 +98,7 @@ public:
     bool isValid() const override {
         return ModbusMessage::isValid() &&
                byteCount() > 0 &&
-               (byteCount() == inputStatus().size() || byteCount() == inputStatus().size() - 1);
+               (byteCount() == dataSize(1) || byteCount() == dataSize(1) - 1);
     }
 
     ///
@@ -98,7 +98,7 @@ public:
     bool isValid() const override {
         return ModbusMessage::isValid() &&
                byteCount() > 0 &&
-               byteCount() == registerValue().size();
+               byteCount() == dataSize(1);
     }
 
     ///
@@ -43,7 +43,7 @@ public:
                readLength() >= 1 && readLength() <= 0x7D &&
                writeLength() >= 1 && writeLength() <= 0x79 &&
                writeByteCount() > 0 &&
-               writeByteCount() == writeValues().size();
+               writeByteCount() == dataSize(9);
     }
 
     ///
@@ -133,7 +133,7 @@ public:
     bool isValid() const override {
         return ModbusMessage::isValid() &&
                byteCount() > 0 &&
-               byteCount() == values().size();
+               byteCount() == dataSize(1);
     }
 
     ///
@@ -41,7 +41,7 @@ public:
     bool isValid() const override {
         return ModbusMessage::isValid() &&
                byteCount() > 0 &&
-               byteCount() == values().size();
+               byteCount() == dataSize(5);
     }
 
     ///
@@ -0,0 +1,505 @@
+#include <QFile>
+#include <QThread>
+#include "modbuspcapimporter.h"
+
+namespace {
+const quint8 TcpFin = 0x01;
+const quint8 TcpSyn = 0x02;
+const quint8 TcpRst = 0x04;
+
+// a hole that is not filled within this much data was lost by the capture
+const int MaxOutOfOrderSize = 64 * 1024;
+const int MaxOutOfOrderSegments = 16;
+
+const int MaxConnections = 4096;
+const qint64 ConnectionTimeout = 10 * 60 * 1000;
+}
+
+///
+/// \brief ModbusPcapImporter::ModbusPcapImporter
+/// \param port server port
+/// \param maxFrames the import stops when this many frames are loaded
+/// \param parent
+///
+ModbusPcapImporter::ModbusPcapImporter(quint16 port, int maxFrames, QObject* parent)
+    : QObject(parent)
+    ,_port(port)
+    ,_maxFrames(maxFrames)
+{
+    qRegisterMetaType<QVector<ModbusFrameRef>>();
+}
+
+///
+/// \brief ModbusPcapImporter::isPcapFile
+/// \param filename
+/// \return
+///
+bool ModbusPcapImporter::isPcapFile(const QString& filename)
+{
+    QFile file(filename);
+    if(!file.open(QFile::ReadOnly))
+        return false;
+
+    return PcapReader::isPcapFile(file.read(4));
+}
+
+///
+/// \brief ModbusPcapImporter::importFile
+/// \param filename
+///
+void ModbusPcapImporter::importFile(const QString& filename)
+{
+    QFile file(filename);
+    if(!file.open(QFile::ReadOnly))
+    {
+        emit finished(QByteArray(), QVector<ModbusFrameRef>(), tr("Failed to open file!"));
+        return;
+    }
+
+    PcapReader reader(&file);
+    if(!reader.open())
+    {
+        emit finished(QByteArray(), QVector<ModbusFrameRef>(), reader.errorString());
+        return;
+    }
+
+    const qint64 size = qMax<qint64>(1, file.size());
+    int lastProgress = -1;
+    quint64 packets = 0;
+    QString error;
+
+    PcapPacket packet;
+    Segment segment;
+    while(reader.readPacket(packet))
+    {
+        if(parsePacket(packet, segment))
+            processSegment(segment, packet.Timestamp);
+
+        if(_frames.size() >= _maxFrames)
+        {
+            error = tr("Only the first %1 frames are loaded").arg(_maxFrames);
+            break;
+        }
+
+        if((++packets & 0x3FF) == 0)
+        {
+            if(QThread::currentThread()->isInterruptionRequested())
+                break;
+
+            if(_connections.size() > MaxConnections)
+                removeStaleConnections(packet.Timestamp);
+
+            const int value = int(file.pos() * 100 / size);
+            if(value != lastProgress)
+                emit progress(lastProgress = value);
+        }
+    }
+
+    if(error.isEmpty())
+        error = reader.errorString();
+
+    for(auto it = _connections.begin(); it != _connections.end(); ++it)
+    {
+        flush(*it, true, it->LastSeen);
+        flush(*it, false, it->LastSeen);
+    }
+    _connections.clear();
+    emit finished(_data, _frames, error);
+}
+
+///
+/// \brief ModbusPcapImporter::parsePacket
+/// Finds the TCP header under the link and IP layers
+/// \param packet
+/// \param segment
+/// \return false when the packet is not TCP to or from the server port
+///
+bool ModbusPcapImporter::parsePacket(const PcapPacket& packet, Segment& segment) const
+{
+    const auto p = reinterpret_cast<const quint8*>(packet.Data.constData());
+    const int size = packet.Data.size();
+
+    int pos = 0;
+    int etherType = -1;
+    switch(packet.LinkType)
+    {
+        case PcapReader::LinkNull:
+            pos = 4;
+        break;
+
+        case PcapReader::LinkEthernet:
+            pos = 14;
+            if(size < pos) return false;
+
+            etherType = p[12] << 8 | p[13];
+            while((etherType == 0x8100 || etherType == 0x88A8) && size >= pos + 4)
+            {
+                etherType = p[pos + 2] << 8 | p[pos + 3];
+                pos += 4;
+            }
+        break;
+
+        case PcapReader::LinkRaw:
+        case PcapReader::LinkIPv4:
+        case PcapReader::LinkIPv6:
+        break;
+
+        case PcapReader::LinkLinuxSll:
+            pos = 16;
+            if(size < pos) return false;
+            etherType = p[14] << 8 | p[15];
+        break;
+
+        case PcapReader::LinkLinuxSll2:
+            pos = 20;
+            if(size < pos) return false;
+            etherType = p[0] << 8 | p[1];
+        break;
+
+        default:
+            return false;
+    }
+
+    if(size <= pos || (etherType != -1 && etherType != 0x0800 && etherType != 0x86DD))
+        return false;
+
+    int src, dst, addrSize, tcp, end;
+    switch(p[pos] >> 4)
+    {
+        case 4:
+        {
+            if(size < pos + 20) return false;
+
+            const int headerSize = (p[pos] & 0x0F) * 4;
+            const int totalSize = p[pos + 2] << 8 | p[pos + 3];
+            const int fragment = (p[pos + 6] << 8 | p[pos + 7]) & 0x3FFF;
+            if(headerSize < 20 || p[pos + 9] != 6 || fragment != 0)
+                return false;
+
+            // zero total length comes from segmentation offload
+            end = totalSize ? qMin(size, pos + totalSize) : size;
+            src = pos + 12;
+            dst = pos + 16;
+            addrSize = 4;
+            tcp = pos + headerSize;
+        }
+        break;
+
+        case 6:
+        {
+            if(size < pos + 40) return false;
+
+            const int payloadSize = p[pos + 4] << 8 | p[pos + 5];
+            end = payloadSize ? qMin(size, pos + 40 + payloadSize) : size;
+            src = pos + 8;
+            dst = pos + 24;
+            addrSize = 16;
+            tcp = pos + 40;
+
+            // hop-by-hop, routing and destination options
+            int next = p[pos + 6];
+            while((next == 0 || next == 43 || next == 60) && tcp + 8 <= end)
+            {
+                next = p[tcp];
+                tcp += (p[tcp + 1] + 1) * 8;
+            }
+
+            if(next != 6) return false;
+        }
+        break;
+
+        default:
+            return false;
+    }
+
+    if(end < tcp + 20)
+        return false;
+
+    const int headerSize = (p[tcp + 12] >> 4) * 4;
+    if(headerSize < 20 || tcp + headerSize > end)
+        return false;
+
+    const quint16 srcPort = quint16(p[tcp] << 8 | p[tcp + 1]);
+    const quint16 dstPort = quint16(p[tcp + 2] << 8 | p[tcp + 3]);
+    if(dstPort == _port) segment.ToServer = true;
+    else if(srcPort == _port) segment.ToServer = false;
+    else return false;
+
+    // client address and port, then server address and port
+    const char* data = packet.Data.constData();
+    segment.Key.resize(0);
+    segment.Key.append(data + (segment.ToServer ? src : dst), addrSize);
+    segment.Key.append(data + tcp + (segment.ToServer ? 0 : 2), 2);
+    segment.Key.append(data + (segment.ToServer ? dst : src), addrSize);
+    segment.Key.append(data + tcp + (segment.ToServer ? 2 : 0), 2);
+
+    segment.Seq = quint32(p[tcp + 4]) << 24 | quint32(p[tcp + 5]) << 16 | quint32(p[tcp + 6]) << 8 | p[tcp + 7];
+    segment.Flags = p[tcp + 13];
+    segment.Payload = data + tcp + headerSize;
+    segment.PayloadSize = end - tcp - headerSize;
+
+    return true;
+}
+
+///
+/// \brief ModbusPcapImporter::processSegment
+/// \param segment
+/// \param timestamp
+///
+void ModbusPcapImporter::processSegment(const Segment& segment, qint64 timestamp)
+{
+    if(segment.Flags & TcpRst)
+    {
+        _connections.remove(segment.Key);
+        return;
+    }
+
+    auto& conn = _connections[segment.Key];
+    conn.LastSeen = timestamp;
+
+    auto& stream = segment.ToServer ? conn.ToServer : conn.ToClient;
+    if(segment.Flags & TcpSyn)
+    {
+        // a new connection may reuse the addresses and ports of a closed one
+        stream = Stream();
+        stream.Synced = true;
+        stream.NextSeq = segment.Seq + 1;
+        if(segment.ToServer) conn.Requests.clear();
+        return;
+    }
+
+    if(segment.PayloadSize > 0)
+        appendData(conn, segment.ToServer, segment.Seq, segment.Payload, segment.PayloadSize, timestamp);
+
+    if(segment.Flags & TcpFin)
+    {
+        flush(conn, segment.ToServer, timestamp);
+        stream.Closed = true;
+        if(conn.ToServer.Closed && conn.ToClient.Closed)
+            _connections.remove(segment.Key);
+    }
+}
+
+///
+/// \brief ModbusPcapImporter::appendData
+/// Puts the segment in sequence order, trimming retransmitted bytes
+/// \param conn
+/// \param toServer
+/// \param seq
+/// \param data
+/// \param size
+/// \param timestamp
+///
+void ModbusPcapImporter::appendData(Connection& conn, bool toServer, quint32 seq, const char* data, int size, qint64 timestamp)
+{
+    auto& stream = toServer ? conn.ToServer : conn.ToClient;
+
+    // the capture started after the handshake
+    if(!stream.Synced)
+    {
+        stream.Synced = true;
+        stream.NextSeq = seq;
+    }
+
+    const qint32 diff = qint32(seq - stream.NextSeq);
+    if(diff > 0)
+    {
+        auto& held = stream.OutOfOrder[seq];
+        if(size > held.size())
+        {
+            stream.OutOfOrderSize += size - held.size();
+            held = QByteArray(data, size);
+        }
+
+        if(stream.OutOfOrderSize <= MaxOutOfOrderSize && stream.OutOfOrder.size() <= MaxOutOfOrderSegments)
+            return;
+
+        // the missing bytes never came
+        skipHole(conn, toServer, timestamp);
+    }
+    else if(-qint64(diff) < size)
+    {
+        stream.Pending.append(data - diff, size + diff);
+        stream.NextSeq += quint32(size + diff);
+    }
+
+    drainHeld(stream);
+    splitFrames(conn, toServer, timestamp);
+}
+
+///
+/// \brief ModbusPcapImporter::skipHole
+/// Resumes the stream from the earliest held segment, a frame cut by the hole is dropped as invalid
+/// \param conn
+/// \param toServer
+/// \param timestamp
+///
+void ModbusPcapImporter::skipHole(Connection& conn, bool toServer, qint64 timestamp)
+{
+    auto& stream = toServer ? conn.ToServer : conn.ToClient;
+    if(stream.OutOfOrder.isEmpty())
+        return;
+
+    if(!stream.Pending.isEmpty())
+    {
+        addFrame(conn, toServer, stream.Pending.constData(), stream.Pending.size(), false, timestamp);
+        stream.Pending.clear();
+    }
+
+    quint32 next = stream.OutOfOrder.begin().key();
+    for(auto it = stream.OutOfOrder.begin(); it != stream.OutOfOrder.end(); ++it)
+    {
+        if(qint32(it.key() - next) < 0)
+            next = it.key();
+    }
+    stream.NextSeq = next;
+}
+
+///
+/// \brief ModbusPcapImporter::drainHeld
+/// Appends held segments that continue the stream
+/// \param stream
+///
+void ModbusPcapImporter::drainHeld(Stream& stream)
+{
+    bool drained = true;
+    while(drained && !stream.OutOfOrder.isEmpty())
+    {
+        drained = false;
+        for(auto it = stream.OutOfOrder.begin(); it != stream.OutOfOrder.end(); ++it)
+        {
+            const qint32 gap = qint32(it.key() - stream.NextSeq);
+            if(gap > 0) continue;
+
+            if(-qint64(gap) < it->size())
+            {
+                stream.Pending.append(it->constData() - gap, it->size() + gap);
+                stream.NextSeq += quint32(it->size() + gap);
+            }
+
+            stream.OutOfOrderSize -= it->size();
+            stream.OutOfOrder.erase(it);
+            drained = true;
+            break;
+        }
+    }
+}
+
+///
+/// \brief ModbusPcapImporter::flush
+/// Gives up on missing segments when a stream ends, an unfinished frame is dropped as invalid
+/// \param conn
+/// \param toServer
+/// \param timestamp
+///
+void ModbusPcapImporter::flush(Connection& conn, bool toServer, qint64 timestamp)
+{
+    auto& stream = toServer ? conn.ToServer : conn.ToClient;
+    while(!stream.OutOfOrder.isEmpty())
+    {
+        skipHole(conn, toServer, timestamp);
+        drainHeld(stream);
+        splitFrames(conn, toServer, timestamp);
+    }
+
+    if(!stream.Pending.isEmpty())
+    {
+        addFrame(conn, toServer, stream.Pending.constData(), stream.Pending.size(), false, timestamp);
+        stream.Pending.clear();
+    }
+}
+
+///
+/// \brief ModbusPcapImporter::splitFrames
+/// Takes complete MBAP frames off the stream, an unfinished one stays pending
+/// \param conn
+/// \param toServer
+/// \param timestamp
+///
+void ModbusPcapImporter::splitFrames(Connection& conn, bool toServer, qint64 timestamp)
+{
+    auto& pending = (toServer ? conn.ToServer : conn.ToClient).Pending;
+
+    int pos = 0;
+    while(pending.size() - pos >= 8)
+    {
+        const auto p = reinterpret_cast<const quint8*>(pending.constData()) + pos;
+        const quint16 protocolId = quint16(p[2] << 8 | p[3]);
+        const quint16 length = quint16(p[4] << 8 | p[5]);
+        if(protocolId != 0 || length < 2 || length > 254)
+        {
+            // frame boundaries are lost, the next segment most likely starts a new frame
+            addFrame(conn, toServer, pending.constData() + pos, pending.size() - pos, false, timestamp);
+            pos = pending.size();
+            break;
+        }
+
+        if(pending.size() - pos < 6 + length)
+            break;
+
+        addFrame(conn, toServer, pending.constData() + pos, 6 + length, true, timestamp);
+        pos += 6 + length;
+    }
+
+    pending.remove(0, pos);
+}
+
+///
+/// \brief ModbusPcapImporter::addFrame
+/// Responses are paired with the last request having the same transaction id
+/// \param conn
+/// \param toServer
+/// \param data
+/// \param size
+/// \param valid
+/// \param timestamp
+///
+void ModbusPcapImporter::addFrame(Connection& conn, bool toServer, const char* data, int size, bool valid, qint64 timestamp)
+{
+    if(_frames.size() >= _maxFrames)
+        return;
+
+    ModbusFrameRef frame;
+    frame.Offset = _data.size();
+    frame.Length = size;
+    frame.Valid = valid;
+    frame.Dir = toServer ? ModbusFrameRef::Request : ModbusFrameRef::Response;
+    frame.Timestamp = timestamp;
+
+    if(valid)
+    {
+        const quint16 transactionId = quint16(quint8(data[0]) << 8 | quint8(data[1]));
+        if(toServer)
+        {
+            conn.Requests[transactionId] = _frames.size();
+        }
+        else
+        {
+            const auto it = conn.Requests.find(transactionId);
+            if(it != conn.Requests.end())
+            {
+                frame.Pair = it.value();
+                _frames[it.value()].Pair = _frames.size();
+                conn.Requests.erase(it);
+            }
+        }
+    }
+
+    _data.append(data, size);
+    _frames.push_back(frame);
+}
+
+///
+/// \brief ModbusPcapImporter::removeStaleConnections
+/// \param timestamp
+///
+void ModbusPcapImporter::removeStaleConnections(qint64 timestamp)
+{
+    for(auto it = _connections.begin(); it != _connections.end();)
+    {
+        if(timestamp - it->LastSeen > ConnectionTimeout)
+            it = _connections.erase(it);
+        else
+            ++it;
+    }
+}
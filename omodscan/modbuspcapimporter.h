@@ -0,0 +1,81 @@
+#ifndef MODBUSPCAPIMPORTER_H
+#define MODBUSPCAPIMPORTER_H
+
+#include <QMap>
+#include <QHash>
+#include <QObject>
+#include "pcapreader.h"
+#include "modbusframeparser.h"
+
+///
+/// \brief The ModbusPcapImporter class
+/// Reassembles Modbus TCP streams from a pcap/pcapng capture. The file is read one packet
+/// at a time and only the unfinished frame and a few out-of-order segments are kept per connection,
+/// so memory depends on the number of frames loaded rather than on the capture size
+///
+class ModbusPcapImporter : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ModbusPcapImporter(quint16 port = 502, int maxFrames = 1000000, QObject* parent = nullptr);
+
+    static bool isPcapFile(const QString& filename);
+
+public slots:
+    void importFile(const QString& filename);
+
+signals:
+    void progress(int value);
+    void finished(const QByteArray& data, const QVector<ModbusFrameRef>& frames, const QString& error);
+
+private:
+    struct Stream
+    {
+        bool Synced = false;
+        bool Closed = false;
+        quint32 NextSeq = 0;
+        QByteArray Pending;
+        QMap<quint32, QByteArray> OutOfOrder;
+        int OutOfOrderSize = 0;
+    };
+
+    struct Connection
+    {
+        Stream ToServer;
+        Stream ToClient;
+        QHash<quint16, int> Requests; ///< transaction id -> frame index
+        qint64 LastSeen = 0;
+    };
+
+    struct Segment
+    {
+        QByteArray Key;
+        bool ToServer = false;
+        quint32 Seq = 0;
+        quint8 Flags = 0;
+        const char* Payload = nullptr;
+        int PayloadSize = 0;
+    };
+
+    bool parsePacket(const PcapPacket& packet, Segment& segment) const;
+    void processSegment(const Segment& segment, qint64 timestamp);
+    void appendData(Connection& conn, bool toServer, quint32 seq, const char* data, int size, qint64 timestamp);
+    void skipHole(Connection& conn, bool toServer, qint64 timestamp);
+    void drainHeld(Stream& stream);
+    void flush(Connection& conn, bool toServer, qint64 timestamp);
+    void splitFrames(Connection& conn, bool toServer, qint64 timestamp);
+    void addFrame(Connection& conn, bool toServer, const char* data, int size, bool valid, qint64 timestamp);
+    void removeStaleConnections(qint64 timestamp);
+
+private:
+    const quint16 _port;
+    const int _maxFrames;
+
+    QHash<QByteArray, Connection> _connections;
+
+    QByteArray _data;
+    QVector<ModbusFrameRef> _frames;
+};
+
+#endif // MODBUSPCAPIMPORTER_H
@@ -0,0 +1,129 @@
+#include <cmath>
+#include "modbusframeparser.h"
+#include "modbusrtusniffer.h"
+
+///
+/// \brief ModbusRtuSniffer::ModbusRtuSniffer
+/// \param params
+/// \param parent
+///
+ModbusRtuSniffer::ModbusRtuSniffer(const SerialConnectionParams& params, QObject* parent)
+    : QObject(parent)
+    ,_params(params)
+    ,_gapUs(interFrameDelay(params.BaudRate))
+{
+}
+
+///
+/// \brief ModbusRtuSniffer::interFrameDelay
+/// \param baudRate
+/// \return t3.5 in microseconds, fixed at 1750 above 19200 baud as the spec recommends
+///
+int ModbusRtuSniffer::interFrameDelay(int baudRate)
+{
+    if(baudRate <= 0 || baudRate > 19200)
+        return 1750;
+
+    return int(std::ceil(3.5 * 11 * 1000000.0 / baudRate));
+}
+
+///
+/// \brief ModbusRtuSniffer::start
+///
+void ModbusRtuSniffer::start()
+{
+    _serialPort = new QSerialPort(this);
+    _serialPort->setPortName(_params.PortName);
+    _serialPort->setBaudRate(_params.BaudRate);
+    _serialPort->setDataBits(_params.WordLength);
+    _serialPort->setParity(_params.Parity);
+    _serialPort->setStopBits(_params.StopBits);
+    _serialPort->setFlowControl(QSerialPort::NoFlowControl);
+
+    // the timer only has millisecond resolution, gaps are measured on read
+    _gapTimer = new QTimer(this);
+    _gapTimer->setTimerType(Qt::PreciseTimer);
+    _gapTimer->setSingleShot(true);
+    _gapTimer->setInterval(qMax(2, (_gapUs + 999) / 1000));
+
+    connect(_gapTimer, &QTimer::timeout, this, &ModbusRtuSniffer::flush);
+    connect(_serialPort, &QSerialPort::readyRead, this, &ModbusRtuSniffer::on_readyRead);
+    connect(_serialPort, &QSerialPort::errorOccurred, this, &ModbusRtuSniffer::on_errorOccurred);
+
+    if(!_serialPort->open(QIODevice::ReadOnly))
+    {
+        emit errorOccurred(_serialPort->errorString());
+        emit finished();
+        return;
+    }
+
+    _serialPort->setReadBufferSize(0);
+}
+
+///
+/// \brief ModbusRtuSniffer::stop
+///
+void ModbusRtuSniffer::stop()
+{
+    if(_serialPort && _serialPort->isOpen())
+    {
+        on_readyRead();
+        flush();
+        _serialPort->close();
+    }
+
+    emit finished();
+}
+
+///
+/// \brief ModbusRtuSniffer::on_readyRead
+///
+void ModbusRtuSniffer::on_readyRead()
+{
+    const auto data = _serialPort->readAll();
+    if(data.isEmpty()) return;
+
+    if(!_buffer.isEmpty() && _lastRead.isValid() && _lastRead.nsecsElapsed() / 1000 >= _gapUs)
+        flush();
+
+    if(_buffer.isEmpty())
+        _bufferTime = QDateTime::currentDateTime();
+
+    _buffer.append(data);
+    _lastRead.start();
+    _gapTimer->start();
+}
+
+///
+/// \brief ModbusRtuSniffer::on_errorOccurred
+/// \param error
+///
+void ModbusRtuSniffer::on_errorOccurred(QSerialPort::SerialPortError error)
+{
+    if(error == QSerialPort::NoError || error == QSerialPort::TimeoutError)
+        return;
+
+    emit errorOccurred(_serialPort->errorString());
+
+    if(error == QSerialPort::ResourceError)
+        stop();
+}
+
+///
+/// \brief ModbusRtuSniffer::flush
+/// Splits the bytes received since the last gap by CRC, so frames merged by a coarse driver are still separated
+///
+void ModbusRtuSniffer::flush()
+{
+    _gapTimer->stop();
+    if(_buffer.isEmpty()) return;
+
+    const double charTimeMs = 11 * 1000.0 / qMax(1, int(_params.BaudRate));
+    for(auto&& f : ModbusFrameParser(ModbusMessage::Rtu).parse(_buffer))
+    {
+        const auto timestamp = _bufferTime.addMSecs(qint64(f.Offset * charTimeMs));
+        emit frameReceived(_buffer.mid(f.Offset, f.Length), timestamp, f.Valid);
+    }
+
+    _buffer.clear();
+}
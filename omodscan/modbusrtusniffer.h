@@ -0,0 +1,52 @@
+#ifndef MODBUSRTUSNIFFER_H
+#define MODBUSRTUSNIFFER_H
+
+#include <QTimer>
+#include <QDateTime>
+#include <QSerialPort>
+#include <QElapsedTimer>
+#include "connectiondetails.h"
+
+///
+/// \brief The ModbusRtuSniffer class
+/// Listens on a serial line without transmitting and splits the traffic into frames.
+/// Meant to live in its own thread, the port and timer are created in start()
+///
+class ModbusRtuSniffer : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ModbusRtuSniffer(const SerialConnectionParams& params, QObject* parent = nullptr);
+
+    static int interFrameDelay(int baudRate);
+
+public slots:
+    void start();
+    void stop();
+
+signals:
+    void frameReceived(const QByteArray& frame, const QDateTime& timestamp, bool valid);
+    void errorOccurred(const QString& error);
+    void finished();
+
+private slots:
+    void on_readyRead();
+    void on_errorOccurred(QSerialPort::SerialPortError error);
+
+private:
+    void flush();
+
+private:
+    const SerialConnectionParams _params;
+    const int _gapUs;
+
+    QSerialPort* _serialPort = nullptr;
+    QTimer* _gapTimer = nullptr;
+
+    QByteArray _buffer;
+    QDateTime _bufferTime;
+    QElapsedTimer _lastRead;
+};
+
+#endif // MODBUSRTUSNIFFER_H
@@ -0,0 +1,619 @@
+#include <QtEndian>
+#include <QModbusPdu>
+#include <QRandomGenerator>
+#include "modbuscrc.h"
+#include "modbusrtusniffer.h"
+#include "modbusframeparser.h"
+#include "modbusserversimulator.h"
+
+namespace {
+const int MbapHeaderSize = 7;
+
+///
+/// \brief exceptionResponse
+/// \param functionCode
+/// \param code
+/// \return
+///
+QByteArray exceptionResponse(quint8 functionCode, QModbusPdu::ExceptionCode code)
+{
+    QByteArray pdu(2, 0);
+    pdu[0] = char(functionCode | QModbusPdu::ExceptionByte);
+    pdu[1] = char(code);
+    return pdu;
+}
+
+///
+/// \brief appendUInt16
+/// \param data
+/// \param value
+///
+void appendUInt16(QByteArray& data, quint16 value)
+{
+    data.append(char(value >> 8));
+    data.append(char(value & 0xFF));
+}
+
+///
+/// \brief chance
+/// \param percent
+/// \return
+///
+bool chance(double percent)
+{
+    return percent > 0 && QRandomGenerator::global()->bounded(100.) < percent;
+}
+}
+
+///
+/// \brief ModbusServerSimulator::ModbusServerSimulator
+/// \param params
+/// \param parent
+///
+ModbusServerSimulator::ModbusServerSimulator(const ModbusServerParams& params, QObject* parent)
+    : QObject(parent)
+    ,_params(params)
+{
+}
+
+///
+/// \brief ModbusServerSimulator::start
+/// Opens the listening socket or the serial port, runs on the thread the simulator was moved to
+///
+void ModbusServerSimulator::start()
+{
+    const bool opened = (_params.Type == ConnectionType::Serial) ? openSerialPort() : listen();
+    if(!opened)
+    {
+        emit finished();
+        return;
+    }
+
+    // initial values of the generators, as the data simulator does
+    for(auto it = _params.Generators.cbegin(); it != _params.Generators.cend(); ++it)
+    {
+        quint16 initial = 0;
+        switch(it->Mode)
+        {
+            case SimulationMode::Increment: initial = quint16(it->IncrementParams.Range.from()); break;
+            case SimulationMode::Decrement: initial = quint16(it->DecrementParams.Range.to()); break;
+            default: break;
+        }
+
+        for(int unitId = _params.UnitIds.from(); unitId <= _params.UnitIds.to(); unitId++)
+            setValue(it.key().first, quint8(unitId), it.key().second, initial);
+    }
+
+    _timer = new QTimer(this);
+    connect(_timer, &QTimer::timeout, this, &ModbusServerSimulator::on_timeout);
+    _timer->start(1000);
+
+    _clock.start();
+}
+
+///
+/// \brief ModbusServerSimulator::stop
+///
+void ModbusServerSimulator::stop()
+{
+    if(_timer)
+        _timer->stop();
+
+    if(_server)
+        _server->close();
+
+    for(auto&& socket : _connections.keys())
+        socket->abort();
+
+    if(_serialPort)
+        _serialPort->close();
+
+    emit finished();
+}
+
+///
+/// \brief ModbusServerSimulator::listen
+/// \return
+///
+bool ModbusServerSimulator::listen()
+{
+    _server = new QTcpServer(this);
+    connect(_server, &QTcpServer::newConnection, this, &ModbusServerSimulator::on_newConnection);
+
+    if(!_server->listen(QHostAddress::Any, _params.Port))
+    {
+        emit errorOccurred(tr("Failed to listen on port %1. %2").arg(QString::number(_params.Port), _server->errorString()));
+        return false;
+    }
+
+    return true;
+}
+
+///
+/// \brief ModbusServerSimulator::openSerialPort
+/// \return
+///
+bool ModbusServerSimulator::openSerialPort()
+{
+    const auto& sp = _params.SerialParams;
+
+    _serialPort = new QSerialPort(this);
+    _serialPort->setPortName(sp.PortName);
+    _serialPort->setBaudRate(sp.BaudRate);
+    _serialPort->setDataBits(sp.WordLength);
+    _serialPort->setParity(sp.Parity);
+    _serialPort->setStopBits(sp.StopBits);
+    _serialPort->setFlowControl(sp.FlowControl);
+
+    // a frame ends after t3.5 of silence, the timer only has millisecond resolution
+    _gapTimer = new QTimer(this);
+    _gapTimer->setTimerType(Qt::PreciseTimer);
+    _gapTimer->setSingleShot(true);
+    _gapTimer->setInterval(qMax(2, (ModbusRtuSniffer::interFrameDelay(sp.BaudRate) + 999) / 1000));
+
+    connect(_gapTimer, &QTimer::timeout, this, &ModbusServerSimulator::flushSerial);
+    connect(_serialPort, &QSerialPort::readyRead, this, &ModbusServerSimulator::on_serialReadyRead);
+    connect(_serialPort, &QSerialPort::errorOccurred, this, &ModbusServerSimulator::on_serialErrorOccurred);
+
+    if(!_serialPort->open(QIODevice::ReadWrite))
+    {
+        emit errorOccurred(tr("Failed to open %1. %2").arg(sp.PortName, _serialPort->errorString()));
+        return false;
+    }
+
+    _serialPort->setReadBufferSize(0);
+    return true;
+}
+
+///
+/// \brief ModbusServerSimulator::on_newConnection
+///
+void ModbusServerSimulator::on_newConnection()
+{
+    while(auto socket = _server->nextPendingConnection())
+    {
+        socket->setSocketOption(QAbstractSocket::LowDelayOption, 1);
+        _connections.insert(socket, Connection());
+
+        connect(socket, &QTcpSocket::readyRead, this, &ModbusServerSimulator::on_readyRead);
+        connect(socket, &QTcpSocket::disconnected, this, &ModbusServerSimulator::on_disconnected);
+    }
+}
+
+///
+/// \brief ModbusServerSimulator::on_readyRead
+/// Splits the stream into MBAP frames, a malformed header closes the connection
+///
+void ModbusServerSimulator::on_readyRead()
+{
+    auto socket = qobject_cast<QTcpSocket*>(sender());
+    if(!socket || !_connections.contains(socket))
+        return;
+
+    auto& buffer = _connections[socket].Buffer;
+    buffer.append(socket->readAll());
+
+    int pos = 0;
+    while(buffer.size() - pos >= MbapHeaderSize + 1)
+    {
+        const auto p = buffer.constData() + pos;
+        const quint16 protocolId = qFromBigEndian<quint16>(p + 2);
+        const quint16 length = qFromBigEndian<quint16>(p + 4);
+        if(protocolId != 0 || length < 2 || length > 254)
+        {
+            socket->abort();
+            return;
+        }
+
+        if(buffer.size() - pos < 6 + length)
+            break;
+
+        processFrame(socket, buffer.mid(pos, 6 + length));
+        pos += 6 + length;
+    }
+
+    buffer.remove(0, pos);
+}
+
+///
+/// \brief ModbusServerSimulator::on_disconnected
+///
+void ModbusServerSimulator::on_disconnected()
+{
+    auto socket = qobject_cast<QTcpSocket*>(sender());
+    if(!socket) return;
+
+    _connections.remove(socket);
+    socket->deleteLater();
+}
+
+///
+/// \brief ModbusServerSimulator::on_serialReadyRead
+///
+void ModbusServerSimulator::on_serialReadyRead()
+{
+    const auto data = _serialPort->readAll();
+    if(data.isEmpty()) return;
+
+    const int gapUs = ModbusRtuSniffer::interFrameDelay(_params.SerialParams.BaudRate);
+    if(!_serialConnection.Buffer.isEmpty() && _lastRead.isValid() && _lastRead.nsecsElapsed() / 1000 >= gapUs)
+        flushSerial();
+
+    _serialConnection.Buffer.append(data);
+    _lastRead.start();
+    _gapTimer->start();
+}
+
+///
+/// \brief ModbusServerSimulator::on_serialErrorOccurred
+/// \param error
+///
+void ModbusServerSimulator::on_serialErrorOccurred(QSerialPort::SerialPortError error)
+{
+    if(error == QSerialPort::NoError || error == QSerialPort::TimeoutError)
+        return;
+
+    emit errorOccurred(_serialPort->errorString());
+
+    if(error == QSerialPort::ResourceError)
+        stop();
+}
+
+///
+/// \brief ModbusServerSimulator::flushSerial
+/// Splits the bytes received since the last gap by CRC, frames failing the check are ignored as a device would
+///
+void ModbusServerSimulator::flushSerial()
+{
+    _gapTimer->stop();
+
+    const auto buffer = _serialConnection.Buffer;
+    _serialConnection.Buffer.clear();
+
+    for(auto&& f : ModbusFrameParser(ModbusMessage::Rtu).parse(buffer))
+    {
+        if(f.Valid && f.Length >= 4)
+            processRtuFrame(buffer.mid(f.Offset, f.Length));
+    }
+}
+
+///
+/// \brief ModbusServerSimulator::on_timeout
+/// Advances the value generators and reports the counters
+///
+void ModbusServerSimulator::on_timeout()
+{
+    _elapsed++;
+    for(auto it = _params.Generators.cbegin(); it != _params.Generators.cend(); ++it)
+    {
+        if(it->Mode == SimulationMode::No || _elapsed % qMax(1u, it->Interval))
+            continue;
+
+        const auto type = it.key().first;
+        const auto addr = it.key().second;
+        for(int unitId = _params.UnitIds.from(); unitId <= _params.UnitIds.to(); unitId++)
+            setValue(type, quint8(unitId), addr, generateValue(type, *it, value(type, quint8(unitId), addr)));
+    }
+
+    const int connections = _serialPort ? int(_serialPort->isOpen()) : _connections.size();
+    emit statisticsChanged(connections, _requests, _exceptions, _dropped);
+}
+
+///
+/// \brief ModbusServerSimulator::processFrame
+/// \param socket
+/// \param frame MBAP header and pdu
+///
+void ModbusServerSimulator::processFrame(QTcpSocket* socket, const QByteArray& frame)
+{
+    const quint8 unitId = quint8(frame[6]);
+    if(!_params.UnitIds.contains(unitId))
+        return;
+
+    const auto response = processPdu(unitId, frame.mid(MbapHeaderSize));
+    if(response.isEmpty())
+        return;
+
+    QByteArray adu = frame.left(4);
+    appendUInt16(adu, quint16(response.size() + 1));
+    adu.append(char(unitId));
+    adu.append(response);
+
+    send(socket, _connections[socket].LastDue, adu);
+}
+
+///
+/// \brief ModbusServerSimulator::processRtuFrame
+/// A broadcast is executed by every unit id and never answered
+/// \param frame address, pdu and crc
+///
+void ModbusServerSimulator::processRtuFrame(const QByteArray& frame)
+{
+    const quint8 unitId = quint8(frame[0]);
+    const auto pdu = frame.mid(1, frame.size() - 3);
+
+    if(unitId == 0)
+    {
+        _requests++;
+        for(int id = _params.UnitIds.from(); id <= _params.UnitIds.to(); id++)
+            processRequest(quint8(id), pdu);
+        return;
+    }
+
+    if(!_params.UnitIds.contains(unitId))
+        return;
+
+    const auto response = processPdu(unitId, pdu);
+    if(response.isEmpty())
+        return;
+
+    QByteArray adu;
+    adu.append(char(unitId));
+    adu.append(response);
+
+    const quint16 crc = ModbusCrc::calculate(adu.constData(), adu.size());
+    adu.append(char(crc & 0xFF));
+    adu.append(char(crc >> 8));
+
+    send(_serialPort, _serialConnection.LastDue, adu);
+}
+
+///
+/// \brief ModbusServerSimulator::processPdu
+/// Applies the configured drop and exception rates
+/// \param unitId
+/// \param pdu
+/// \return response pdu, empty when the request is dropped
+///
+QByteArray ModbusServerSimulator::processPdu(quint8 unitId, const QByteArray& pdu)
+{
+    _requests++;
+    if(chance(_params.DropRate))
+    {
+        _dropped++;
+        return QByteArray();
+    }
+
+    QByteArray response;
+    if(chance(_params.ExceptionRate))
+        response = exceptionResponse(quint8(pdu[0]), QModbusPdu::ServerDeviceBusy);
+    else
+        response = processRequest(unitId, pdu);
+
+    if(quint8(response[0]) & QModbusPdu::ExceptionByte)
+        _exceptions++;
+
+    return response;
+}
+
+///
+/// \brief ModbusServerSimulator::send
+/// Writes the response after the configured latency, never ahead of an earlier one
+/// \param device
+/// \param lastDue
+/// \param adu
+///
+void ModbusServerSimulator::send(QIODevice* device, qint64& lastDue, const QByteArray& adu)
+{
+    const int delay = _params.Latency + (_params.Jitter > 0 ? QRandomGenerator::global()->bounded(_params.Jitter + 1) : 0);
+    const qint64 now = _clock.elapsed();
+
+    lastDue = qMax(now + delay, lastDue);
+
+    if(lastDue <= now)
+        device->write(adu);
+    else
+        QTimer::singleShot(int(lastDue - now), Qt::PreciseTimer, device, [device, adu]{ device->write(adu); });
+}
+
+///
+/// \brief ModbusServerSimulator::processRequest
+/// \param unitId
+/// \param pdu function code and data
+/// \return response pdu
+///
+QByteArray ModbusServerSimulator::processRequest(quint8 unitId, const QByteArray& pdu)
+{
+    const quint8 functionCode = quint8(pdu[0]);
+    const auto data = pdu.constData() + 1;
+    const int size = pdu.size() - 1;
+
+    auto u16 = [data](int offset) { return qFromBigEndian<quint16>(data + offset); };
+    auto inRange = [](int addr, int count) { return addr + count <= 0x10000; };
+
+    QByteArray response;
+    response.append(char(functionCode));
+
+    switch(functionCode)
+    {
+        case QModbusPdu::ReadCoils:
+        case QModbusPdu::ReadDiscreteInputs:
+        {
+            if(size != 4) return exceptionResponse(functionCode, QModbusPdu::IllegalDataValue);
+
+            const auto type = (functionCode == QModbusPdu::ReadCoils) ? QModbusDataUnit::Coils : QModbusDataUnit::DiscreteInputs;
+            const int addr = u16(0), count = u16(2);
+            if(count < 1 || count > 2000) return exceptionResponse(functionCode, QModbusPdu::IllegalDataValue);
+            if(!inRange(addr, count)) return exceptionResponse(functionCode, QModbusPdu::IllegalDataAddress);
+
+            QByteArray bits((count + 7) / 8, 0);
+            for(int i = 0; i < count; i++)
+                if(value(type, unitId, quint16(addr + i))) bits[i / 8] = char(bits[i / 8] | (1 << (i % 8)));
+
+            response.append(char(bits.size()));
+            response.append(bits);
+        }
+        break;
+
+        case QModbusPdu::ReadHoldingRegisters:
+        case QModbusPdu::ReadInputRegisters:
+        {
+            if(size != 4) return exceptionResponse(functionCode, QModbusPdu::IllegalDataValue);
+
+            const auto type = (functionCode == QModbusPdu::ReadHoldingRegisters) ? QModbusDataUnit::HoldingRegisters : QModbusDataUnit::InputRegisters;
+            const int addr = u16(0), count = u16(2);
+            if(count < 1 || count > 125) return exceptionResponse(functionCode, QModbusPdu::IllegalDataValue);
+            if(!inRange(addr, count)) return exceptionResponse(functionCode, QModbusPdu::IllegalDataAddress);
+
+            response.append(char(count * 2));
+            for(int i = 0; i < count; i++)
+                appendUInt16(response, value(type, unitId, quint16(addr + i)));
+        }
+        break;
+
+        case QModbusPdu::WriteSingleCoil:
+        {
+            if(size != 4 || (u16(2) != 0xFF00 && u16(2) != 0x0000))
+                return exceptionResponse(functionCode, QModbusPdu::IllegalDataValue);
+
+            setValue(QModbusDataUnit::Coils, unitId, u16(0), u16(2) ? 1 : 0);
+            response = pdu;
+        }
+        break;
+
+        case QModbusPdu::WriteSingleRegister:
+        {
+            if(size != 4) return exceptionResponse(functionCode, QModbusPdu::IllegalDataValue);
+
+            setValue(QModbusDataUnit::HoldingRegisters, unitId, u16(0), u16(2));
+            response = pdu;
+        }
+        break;
+
+        case QModbusPdu::WriteMultipleCoils:
+        {
+            if(size < 6) return exceptionResponse(functionCode, QModbusPdu::IllegalDataValue);
+
+            const int addr = u16(0), count = u16(2), bytes = quint8(data[4]);
+            if(count < 1 || count > 1968 || bytes != (count + 7) / 8 || size != 5 + bytes)
+                return exceptionResponse(functionCode, QModbusPdu::IllegalDataValue);
+            if(!inRange(addr, count)) return exceptionResponse(functionCode, QModbusPdu::IllegalDataAddress);
+
+            for(int i = 0; i < count; i++)
+                setValue(QModbusDataUnit::Coils, unitId, quint16(addr + i), (quint8(data[5 + i / 8]) >> (i % 8)) & 1);
+
+            response.append(pdu.mid(1, 4));
+        }
+        break;
+
+        case QModbusPdu::WriteMultipleRegisters:
+        {
+            if(size < 6) return exceptionResponse(functionCode, QModbusPdu::IllegalDataValue);
+
+            const int addr = u16(0), count = u16(2), bytes = quint8(data[4]);
+            if(count < 1 || count > 123 || bytes != count * 2 || size != 5 + bytes)
+                return exceptionResponse(functionCode, QModbusPdu::IllegalDataValue);
+            if(!inRange(addr, count)) return exceptionResponse(functionCode, QModbusPdu::IllegalDataAddress);
+
+            for(int i = 0; i < count; i++)
+                setValue(QModbusDataUnit::HoldingRegisters, unitId, quint16(addr + i), u16(5 + i * 2));
+
+            response.append(pdu.mid(1, 4));
+        }
+        break;
+
+        case QModbusPdu::MaskWriteRegister:
+        {
+            if(size != 6) return exceptionResponse(functionCode, QModbusPdu::IllegalDataValue);
+
+            const quint16 addr = u16(0), andMask = u16(2), orMask = u16(4);
+            const quint16 current = value(QModbusDataUnit::HoldingRegisters, unitId, addr);
+            setValue(QModbusDataUnit::HoldingRegisters, unitId, addr, quint16((current & andMask) | (orMask & ~andMask)));
+            response = pdu;
+        }
+        break;
+
+        case QModbusPdu::ReadWriteMultipleRegisters:
+        {
+            if(size < 10) return exceptionResponse(functionCode, QModbusPdu::IllegalDataValue);
+
+            const int readAddr = u16(0), readCount = u16(2);
+            const int writeAddr = u16(4), writeCount = u16(6), bytes = quint8(data[8]);
+            if(readCount < 1 || readCount > 125 || writeCount < 1 || writeCount > 121 ||
+               bytes != writeCount * 2 || size != 9 + bytes)
+                return exceptionResponse(functionCode, QModbusPdu::IllegalDataValue);
+            if(!inRange(readAddr, readCount) || !inRange(writeAddr, writeCount))
+                return exceptionResponse(functionCode, QModbusPdu::IllegalDataAddress);
+
+            // the write happens before the read
+            for(int i = 0; i < writeCount; i++)
+                setValue(QModbusDataUnit::HoldingRegisters, unitId, quint16(writeAddr + i), u16(9 + i * 2));
+
+            response.append(char(readCount * 2));
+            for(int i = 0; i < readCount; i++)
+                appendUInt16(response, value(QModbusDataUnit::HoldingRegisters, unitId, quint16(readAddr + i)));
+        }
+        break;
+
+        default:
+            return exceptionResponse(functionCode, QModbusPdu::IllegalFunction);
+    }
+
+    return response;
+}
+
+///
+/// \brief ModbusServerSimulator::value
+/// \param type
+/// \param unitId
+/// \param addr
+/// \return zero for a value never written
+///
+quint16 ModbusServerSimulator::value(QModbusDataUnit::RegisterType type, quint8 unitId, quint16 addr) const
+{
+    return _tables[type].value(quint32(unitId) << 16 | addr);
+}
+
+///
+/// \brief ModbusServerSimulator::setValue
+/// \param type
+/// \param unitId
+/// \param addr
+/// \param value
+///
+void ModbusServerSimulator::setValue(QModbusDataUnit::RegisterType type, quint8 unitId, quint16 addr, quint16 value)
+{
+    _tables[type][quint32(unitId) << 16 | addr] = value;
+}
+
+///
+/// \brief ModbusServerSimulator::generateValue
+/// \param type
+/// \param params
+/// \param value current value
+/// \return next value of a 16-bit register or a coil
+///
+quint16 ModbusServerSimulator::generateValue(QModbusDataUnit::RegisterType type, const ModbusSimulationParams& params, quint16 value)
+{
+    const bool isBit = (type == QModbusDataUnit::Coils || type == QModbusDataUnit::DiscreteInputs);
+    auto bound = [isBit](double v) { return quint16(qBound(0., v, isBit ? 1. : 65535.)); };
+
+    switch(params.Mode)
+    {
+        case SimulationMode::Random:
+        {
+            const auto& range = params.RandomParams.Range;
+            return bound(range.from() + QRandomGenerator::global()->bounded(range.to() - range.from() + 1));
+        }
+
+        case SimulationMode::Increment:
+        {
+            const auto& p = params.IncrementParams;
+            const double next = value + p.Step;
+            return bound(p.Range.contains(next) ? next : p.Range.from());
+        }
+
+        case SimulationMode::Decrement:
+        {
+            const auto& p = params.DecrementParams;
+            const double next = value - p.Step;
+            return bound(p.Range.contains(next) ? next : p.Range.to());
+        }
+
+        case SimulationMode::Toggle:
+            return value ? 0 : 1;
+
+        default:
+            return value;
+    }
+}
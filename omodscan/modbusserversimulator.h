@@ -0,0 +1,104 @@
+#ifndef MODBUSSERVERSIMULATOR_H
+#define MODBUSSERVERSIMULATOR_H
+
+#include <array>
+#include <QHash>
+#include <QTimer>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QSerialPort>
+#include <QElapsedTimer>
+#include "datasimulator.h"
+#include "connectiondetails.h"
+
+///
+/// \brief The ModbusServerParams struct
+///
+struct ModbusServerParams
+{
+    ConnectionType Type = ConnectionType::Tcp;
+    quint16 Port = 502;
+    SerialConnectionParams SerialParams;
+    QRange<int> UnitIds = QRange<int>(1, 247);
+    int Latency = 0;            ///< ms
+    int Jitter = 0;             ///< ms, a random 0..Jitter is added to the latency
+    double ExceptionRate = 0.;  ///< percent of requests answered with Server Device Busy
+    double DropRate = 0.;       ///< percent of requests left unanswered
+    ModbusSimulationMap Generators;  ///< applied to every unit id
+};
+
+///
+/// \brief The ModbusServerSimulator class
+/// Modbus TCP server or RTU slave for load testing the client on one machine. Every unit id in the
+/// range has its own sparse register tables, responses can be delayed, failed or dropped.
+/// In RTU mode it can sit on one end of a virtual serial pair (socat, com0com) with the client on the other
+///
+class ModbusServerSimulator : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit ModbusServerSimulator(const ModbusServerParams& params, QObject* parent = nullptr);
+
+public slots:
+    void start();
+    void stop();
+
+signals:
+    void errorOccurred(const QString& error);
+    void statisticsChanged(int connections, quint64 requests, quint64 exceptions, quint64 dropped);
+    void finished();
+
+private slots:
+    void on_newConnection();
+    void on_readyRead();
+    void on_disconnected();
+    void on_serialReadyRead();
+    void on_serialErrorOccurred(QSerialPort::SerialPortError error);
+    void on_timeout();
+
+private:
+    bool listen();
+    bool openSerialPort();
+    void flushSerial();
+
+    void processFrame(QTcpSocket* socket, const QByteArray& frame);
+    void processRtuFrame(const QByteArray& frame);
+    QByteArray processPdu(quint8 unitId, const QByteArray& pdu);
+    QByteArray processRequest(quint8 unitId, const QByteArray& pdu);
+    void send(QIODevice* device, qint64& lastDue, const QByteArray& adu);
+
+    quint16 value(QModbusDataUnit::RegisterType type, quint8 unitId, quint16 addr) const;
+    void setValue(QModbusDataUnit::RegisterType type, quint8 unitId, quint16 addr, quint16 value);
+
+    static quint16 generateValue(QModbusDataUnit::RegisterType type, const ModbusSimulationParams& params, quint16 value);
+
+private:
+    const ModbusServerParams _params;
+
+    QTcpServer* _server = nullptr;
+    QTimer* _timer = nullptr;
+    QElapsedTimer _clock;
+    quint32 _elapsed = 0;
+
+    struct Connection
+    {
+        QByteArray Buffer;
+        qint64 LastDue = 0;  ///< responses leave in request order
+    };
+    QHash<QTcpSocket*, Connection> _connections;
+
+    QSerialPort* _serialPort = nullptr;
+    QTimer* _gapTimer = nullptr;
+    QElapsedTimer _lastRead;
+    Connection _serialConnection;
+
+    // indexed by QModbusDataUnit::RegisterType, keyed by unit id and address
+    std::array<QHash<quint32, quint16>, 5> _tables;
+
+    quint64 _requests = 0;
+    quint64 _exceptions = 0;
+    quint64 _dropped = 0;
+};
+
+#endif // MODBUSSERVERSIMULATOR_H
@@ -0,0 +1,121 @@
+#include <cmath>
+#include <QtAlgorithms>
+#include "modbusstatistics.h"
+
+///
+/// \brief LatencyHistogram::record
+/// \param usecs
+///
+void LatencyHistogram::record(qint64 usecs)
+{
+    usecs = qMax<qint64>(0, usecs);
+
+    _counts[bucketIndex(quint64(usecs))]++;
+    _min = _count ? qMin(_min, usecs) : usecs;
+    _max = qMax(_max, usecs);
+    _sum += usecs;
+    _count++;
+}
+
+///
+/// \brief LatencyHistogram::reset
+///
+void LatencyHistogram::reset()
+{
+    *this = LatencyHistogram();
+}
+
+///
+/// \brief LatencyHistogram::percentile
+/// \param p percent in 0..100
+/// \return the highest value equivalent to the bucket holding the percentile, clamped to the recorded range
+///
+qint64 LatencyHistogram::percentile(double p) const
+{
+    if(_count == 0)
+        return 0;
+
+    const quint64 target = qMax<quint64>(1, quint64(std::ceil(qBound(0., p, 100.) / 100. * _count)));
+
+    quint64 total = 0;
+    for(int i = 0; i < BucketCount; i++)
+    {
+        total += _counts[i];
+        if(total >= target)
+            return (i < BucketCount - 1) ? qBound(_min, bucketValue(i), _max) : _max;
+    }
+
+    return _max;
+}
+
+///
+/// \brief LatencyHistogram::bucketIndex
+/// Values below 32 have a bucket each, above that the bucket is
+/// the power of two and the next five bits of the value
+/// \param value
+/// \return
+///
+int LatencyHistogram::bucketIndex(quint64 value)
+{
+    if(value < SubBucketCount)
+        return int(value);
+
+    const int exp = 63 - qCountLeadingZeroBits(value);
+    const int index = (exp - SubBucketBits + 1) * SubBucketCount + int((value >> (exp - SubBucketBits)) & (SubBucketCount - 1));
+    return qMin(index, BucketCount - 1);
+}
+
+///
+/// \brief LatencyHistogram::bucketValue
+/// \param index
+/// \return the largest value counted in the bucket
+///
+qint64 LatencyHistogram::bucketValue(int index)
+{
+    if(index < SubBucketCount)
+        return index;
+
+    const int shift = index / SubBucketCount - 1;
+    const quint64 base = quint64(SubBucketCount | (index % SubBucketCount)) << shift;
+    return qint64(base + (Q_UINT64_C(1) << shift) - 1);
+}
+
+///
+/// \brief ModbusStatistics::addReply
+/// An exception is a response too, so its time is recorded
+/// \param error
+/// \param latency usecs from sending the request
+///
+void ModbusStatistics::addReply(QModbusDevice::Error error, qint64 latency)
+{
+    switch(error)
+    {
+        case QModbusDevice::NoError:
+            Responses++;
+            Latency.record(latency);
+        break;
+
+        case QModbusDevice::ProtocolError:
+            Exceptions++;
+            Latency.record(latency);
+        break;
+
+        case QModbusDevice::TimeoutError:
+            Timeouts++;
+        break;
+
+        // a response that failed the checksum or could not be decoded
+        case QModbusDevice::InvalidResponseError:
+            InvalidResponses++;
+        break;
+
+        // disconnecting aborts the pending requests, that says nothing about the device
+        case QModbusDevice::ReplyAbortedError:
+            Requests = Requests ? Requests - 1 : 0;
+        break;
+
+        default:
+            OtherErrors++;
+        break;
+    }
+}
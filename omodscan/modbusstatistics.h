@@ -0,0 +1,75 @@
+#ifndef MODBUSSTATISTICS_H
+#define MODBUSSTATISTICS_H
+
+#include <array>
+#include <QString>
+#include <QModbusDevice>
+
+///
+/// \brief The LatencyHistogram class
+/// Log-linear buckets in the style of HdrHistogram: every power of two is split into 32 buckets,
+/// so any percentile is reported within about 3% of the recorded value using a fixed amount of memory
+///
+class LatencyHistogram
+{
+public:
+    void record(qint64 usecs);
+    void reset();
+
+    quint64 count() const { return _count; }
+    qint64 min() const { return _count ? _min : 0; }
+    qint64 max() const { return _max; }
+    qint64 mean() const { return _count ? qint64(_sum / _count) : 0; }
+    qint64 percentile(double p) const;
+
+private:
+    static int bucketIndex(quint64 value);
+    static qint64 bucketValue(int index);
+
+private:
+    static constexpr int SubBucketBits = 5;
+    static constexpr int SubBucketCount = 1 << SubBucketBits;
+
+    // values up to 2^32 usecs (over an hour), larger ones land in the last bucket
+    static constexpr int BucketCount = (32 - SubBucketBits + 1) * SubBucketCount;
+
+    std::array<quint32, BucketCount> _counts = {};
+    quint64 _count = 0;
+    qint64 _min = 0;
+    qint64 _max = 0;
+    double _sum = 0;
+};
+
+///
+/// \brief The ModbusStatistics struct
+/// Outcome counters and response times of the requests sent to one device or from one window
+///
+struct ModbusStatistics
+{
+    quint64 Requests = 0;
+    quint64 Responses = 0;
+    quint64 Exceptions = 0;
+    quint64 Timeouts = 0;
+    quint64 InvalidResponses = 0;
+    quint64 OtherErrors = 0;
+    LatencyHistogram Latency;
+
+    void addReply(QModbusDevice::Error error, qint64 latency);
+    void reset() { *this = ModbusStatistics(); }
+
+    double rate(quint64 value) const {
+        return Requests ? 100. * value / Requests : 0.;
+    }
+};
+
+///
+/// \brief formatLatency
+/// \param usecs
+/// \return milliseconds, with a decimal below 10 ms
+///
+inline QString formatLatency(qint64 usecs)
+{
+    return QString::number(usecs / 1000., 'f', usecs < 10000 ? 1 : 0);
+}
+
+#endif // MODBUSSTATISTICS_H
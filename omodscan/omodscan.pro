@@ -28,6 +28,14 @@ INCLUDEPATH += controls \
                dialogs \
                modbusmessages \
 
+# the polling engine is the core library, build it first through omodscan-all.pro
+include(core/core.pri)
+
+# the core sources are compiled by core/core.pro, lupdate still reads them from here
+lupdate_only {
+    include(core/sources.pri)
+}
+
 SOURCES += \
     ChartDock.cpp \
     ansimenu.cpp \
@@ -67,22 +75,32 @@ SOURCES += \
     dialogs/dialogmodbusscanner.cpp \
     dialogs/dialogprintsettings.cpp \
     dialogs/dialogprotocolselections.cpp \
+    dialogs/dialogrtusniffer.cpp \
+    dialogs/dialogserversimulator.cpp \
     dialogs/dialogsetuppresetdata.cpp \
+    dialogs/dialogstatistics.cpp \
     dialogs/dialogusermsg.cpp \
     dialogs/dialogwindowsmanager.cpp \
     dialogs/dialogwritecoilregister.cpp \
     dialogs/dialogwriteholdingregister.cpp \
     dialogs/dialogwriteholdingregisterbits.cpp \
     formmodsca.cpp \
+    headlesspoller.cpp \
     htmldelegate.cpp \
     main.cpp \
     mainwindow.cpp \
-    modbusclient.cpp \
     modbusdataunit.cpp \
+    modbusdumpimporter.cpp \
+    modbusframeparser.cpp \
     modbusmessages/modbusmessage.cpp \
+    modbuspcapimporter.cpp \
     modbusrtuscanner.cpp \
+    modbusrtusniffer.cpp \
     modbusscanner.cpp \
+    modbusserversimulator.cpp \
     modbustcpscanner.cpp \
+    parquetwriter.cpp \
+    pcapreader.cpp \
     qfixedsizedialog.cpp \
     qhexvalidator.cpp \
     qint64validator.cpp \
@@ -132,7 +150,10 @@ HEADERS += \
     dialogs/dialogmodbusscanner.h \
     dialogs/dialogprintsettings.h \
     dialogs/dialogprotocolselections.h \
+    dialogs/dialogrtusniffer.h \
+    dialogs/dialogserversimulator.h \
     dialogs/dialogsetuppresetdata.h \
+    dialogs/dialogstatistics.h \
     dialogs/dialogusermsg.h \
     dialogs/dialogwindowsmanager.h \
     dialogs/dialogwritecoilregister.h \
@@ -142,11 +163,15 @@ HEADERS += \
     enums.h \
     formatutils.h \
     formmodsca.h \
+    headlesspoller.h \
     htmldelegate.h \
     mainwindow.h \
-    modbusclient.h \
+    modbuscrc.h \
+    modbusdatasearch.h \
     modbusdataunit.h \
+    modbusdumpimporter.h \
     modbusexception.h \
+    modbusframeparser.h \
     modbusfunction.h \
     modbusmessages/diagnostics.h \
     modbusmessages/getcommeventcounter.h \
@@ -169,12 +194,17 @@ HEADERS += \
     modbusmessages/writemultipleregisters.h \
     modbusmessages/writesinglecoil.h \
     modbusmessages/writesingleregister.h \
+    modbuspcapimporter.h \
     modbusrtuscanner.h \
+    modbusrtusniffer.h \
     modbusscanner.h \
+    modbusserversimulator.h \
     modbussimulationparams.h \
     modbustcpscanner.h \
     modbuswriteparams.h \
     numericutils.h \
+    parquetwriter.h \
+    pcapreader.h \
     qfixedsizedialog.h \
     qhexvalidator.h \
     qint64validator.h \
@@ -204,7 +234,10 @@ FORMS += \
     dialogs/dialogmodbusscanner.ui \
     dialogs/dialogprintsettings.ui \
     dialogs/dialogprotocolselections.ui \
+    dialogs/dialogrtusniffer.ui \
+    dialogs/dialogserversimulator.ui \
     dialogs/dialogsetuppresetdata.ui \
+    dialogs/dialogstatistics.ui \
     dialogs/dialogusermsg.ui \
     dialogs/dialogwindowsmanager.ui \
     dialogs/dialogwritecoilregister.ui \
@@ -0,0 +1,585 @@
+#include <cstring>
+#include <QtEndian>
+#include "parquetwriter.h"
+
+namespace {
+
+///
+/// \brief Parquet format constants
+///
+enum : int
+{
+    PageData = 0,
+    PageDictionary = 2,
+    EncodingPlain = 0,
+    EncodingPlainDictionary = 2,
+    EncodingRle = 3,
+    RepetitionRequired = 0,
+    RepetitionOptional = 1,
+    CodecUncompressed = 0
+};
+
+///
+/// \brief The ThriftWriter class
+/// Thrift compact protocol encoder for the Parquet metadata structures
+///
+class ThriftWriter
+{
+public:
+    enum Type
+    {
+        I32 = 5,
+        I64 = 6,
+        Binary = 8,
+        List = 9,
+        Struct = 12
+    };
+
+    QByteArray& data() { return _data; }
+
+    void beginStruct() {
+        _lastField.push_back(0);
+    }
+
+    void endStruct() {
+        _data.append('\0');
+        _lastField.pop_back();
+    }
+
+    void fieldHeader(int id, Type type) {
+        const int delta = id - _lastField.back();
+        if(delta > 0 && delta <= 15)
+        {
+            _data.append(char((delta << 4) | type));
+        }
+        else
+        {
+            _data.append(char(type));
+            writeVarint(zigzag(id));
+        }
+        _lastField.back() = id;
+    }
+
+    void listHeader(int size, Type type) {
+        if(size < 15)
+        {
+            _data.append(char((size << 4) | type));
+        }
+        else
+        {
+            _data.append(char(0xF0 | type));
+            writeVarint(size);
+        }
+    }
+
+    void fieldI32(int id, qint32 value) {
+        fieldHeader(id, I32);
+        writeVarint(zigzag(value));
+    }
+
+    void fieldI64(int id, qint64 value) {
+        fieldHeader(id, I64);
+        writeVarint(zigzag(value));
+    }
+
+    void fieldString(int id, const QString& value) {
+        fieldHeader(id, Binary);
+        writeString(value);
+    }
+
+    void writeString(const QString& value) {
+        const auto utf8 = value.toUtf8();
+        writeVarint(utf8.size());
+        _data.append(utf8);
+    }
+
+    void writeI32(qint32 value) {
+        writeVarint(zigzag(value));
+    }
+
+    void writeVarint(quint64 value) {
+        while(value >= 0x80)
+        {
+            _data.append(char(value | 0x80));
+            value >>= 7;
+        }
+        _data.append(char(value));
+    }
+
+private:
+    static quint64 zigzag(qint64 value) {
+        return (quint64(value) << 1) ^ quint64(value >> 63);
+    }
+
+private:
+    QByteArray _data;
+    QVector<int> _lastField;
+};
+
+///
+/// \brief valueSize
+/// \param type
+/// \return
+///
+int valueSize(ParquetWriter::PhysicalType type)
+{
+    switch(type)
+    {
+        case ParquetWriter::Int32:
+        case ParquetWriter::Float:
+            return 4;
+
+        default:
+            return 8;
+    }
+}
+
+///
+/// \brief bitWidth
+/// \param maxValue
+/// \return
+///
+int bitWidth(quint32 maxValue)
+{
+    int width = 0;
+    while(maxValue) { width++; maxValue >>= 1; }
+    return qMax(1, width);
+}
+
+///
+/// \brief appendPlain
+/// \param out
+/// \param bits
+/// \param size
+///
+void appendPlain(QByteArray& out, quint64 bits, int size)
+{
+    char buf[8];
+    qToLittleEndian<quint64>(bits, buf);
+    out.append(buf, size);
+}
+
+///
+/// \brief appendVarint
+/// \param out
+/// \param value
+///
+void appendVarint(QByteArray& out, quint64 value)
+{
+    while(value >= 0x80)
+    {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+///
+/// \brief encodeHybrid
+/// RLE/bit-packed hybrid encoding; runs of 8+ equal values become RLE runs,
+/// everything else is bit-packed in groups of 8
+/// \param values
+/// \param width
+/// \return
+///
+QByteArray encodeHybrid(const QVector<quint32>& values, int width)
+{
+    QByteArray out;
+    QVector<quint32> literals;
+
+    const auto flushLiterals = [&]
+    {
+        if(literals.isEmpty()) return;
+
+        while(literals.size() % 8)
+            literals.push_back(0);
+
+        appendVarint(out, quint64(literals.size() / 8) << 1 | 1);
+
+        quint64 acc = 0;
+        int bits = 0;
+        for(auto&& v : literals)
+        {
+            acc |= quint64(v) << bits;
+            bits += width;
+            while(bits >= 8)
+            {
+                out.append(char(acc & 0xFF));
+                acc >>= 8;
+                bits -= 8;
+            }
+        }
+        literals.clear();
+    };
+
+    const int byteWidth = (width + 7) / 8;
+    for(int i = 0; i < values.size(); )
+    {
+        int j = i + 1;
+        while(j < values.size() && values[j] == values[i]) j++;
+
+        if(j - i >= 8 && literals.size() % 8 == 0)
+        {
+            flushLiterals();
+            appendVarint(out, quint64(j - i) << 1);
+            appendPlain(out, values[i], byteWidth);
+            i = j;
+        }
+        else
+        {
+            literals.push_back(values[i]);
+            i++;
+        }
+    }
+    flushLiterals();
+
+    return out;
+}
+
+///
+/// \brief pageHeader
+/// \param type
+/// \param size
+/// \param numValues
+/// \param encoding
+/// \return
+///
+QByteArray pageHeader(int type, int size, int numValues, int encoding)
+{
+    ThriftWriter w;
+    w.beginStruct();
+    w.fieldI32(1, type);
+    w.fieldI32(2, size);
+    w.fieldI32(3, size);
+    if(type == PageDictionary)
+    {
+        w.fieldHeader(7, ThriftWriter::Struct);
+        w.beginStruct();
+        w.fieldI32(1, numValues);
+        w.fieldI32(2, encoding);
+        w.endStruct();
+    }
+    else
+    {
+        w.fieldHeader(5, ThriftWriter::Struct);
+        w.beginStruct();
+        w.fieldI32(1, numValues);
+        w.fieldI32(2, encoding);
+        w.fieldI32(3, EncodingRle);
+        w.fieldI32(4, EncodingRle);
+        w.endStruct();
+    }
+    w.endStruct();
+
+    return w.data();
+}
+
+}
+
+///
+/// \brief ParquetWriter::addColumn
+/// \param name
+/// \param type
+/// \param converted
+/// \param nullable
+/// \return column index
+///
+int ParquetWriter::addColumn(const QString& name, PhysicalType type, ConvertedType converted, bool nullable)
+{
+    Column column;
+    column.Name = name;
+    column.Type = type;
+    column.Converted = converted;
+    column.Nullable = nullable;
+    _columns.push_back(column);
+
+    return _columns.size() - 1;
+}
+
+///
+/// \brief ParquetWriter::setMetadata
+/// \param key
+/// \param value
+///
+void ParquetWriter::setMetadata(const QString& key, const QString& value)
+{
+    _metadata.push_back({ key, value });
+}
+
+///
+/// \brief ParquetWriter::append
+/// \param column
+/// \param value
+///
+void ParquetWriter::append(int column, qint64 value)
+{
+    switch(_columns[column].Type)
+    {
+        case Float:
+        case Double:
+            append(column, double(value));
+        break;
+
+        case Int32:
+            appendBits(column, quint32(qint32(value)));
+        break;
+
+        default:
+            appendBits(column, quint64(value));
+        break;
+    }
+}
+
+///
+/// \brief ParquetWriter::append
+/// \param column
+/// \param value
+///
+void ParquetWriter::append(int column, double value)
+{
+    switch(_columns[column].Type)
+    {
+        case Float:
+        {
+            const float f = float(value);
+            quint32 bits;
+            memcpy(&bits, &f, sizeof(bits));
+            appendBits(column, bits);
+        }
+        break;
+
+        case Double:
+        {
+            quint64 bits;
+            memcpy(&bits, &value, sizeof(bits));
+            appendBits(column, bits);
+        }
+        break;
+
+        default:
+            append(column, qint64(value));
+        break;
+    }
+}
+
+///
+/// \brief ParquetWriter::appendNull
+/// \param column
+///
+void ParquetWriter::appendNull(int column)
+{
+    auto& c = _columns[column];
+    Q_ASSERT(c.Nullable);
+
+    c.NumRows++;
+    c.Defined.push_back(false);
+}
+
+///
+/// \brief ParquetWriter::appendBits
+/// \param column
+/// \param bits
+///
+void ParquetWriter::appendBits(int column, quint64 bits)
+{
+    auto& c = _columns[column];
+
+    auto it = c.Lookup.constFind(bits);
+    if(it == c.Lookup.constEnd())
+    {
+        it = c.Lookup.insert(bits, c.Dictionary.size());
+        c.Dictionary.push_back(bits);
+    }
+
+    c.NumRows++;
+    c.Indexes.push_back(it.value());
+    if(c.Nullable) c.Defined.push_back(true);
+}
+
+///
+/// \brief ParquetWriter::write
+/// \param device
+/// \return
+///
+bool ParquetWriter::write(QIODevice* device) const
+{
+    if(!device || _columns.isEmpty())
+        return false;
+
+    qint64 numRows = _columns.first().NumRows;
+    for(auto&& c : _columns)
+    {
+        if(c.NumRows != numRows)
+            return false;
+    }
+
+    struct ChunkInfo
+    {
+        qint64 DictionaryOffset = -1;
+        qint64 DataOffset = 0;
+        qint64 Size = 0;
+        bool UseDictionary = false;
+    };
+
+    QVector<ChunkInfo> chunks;
+    qint64 offset = 4;
+
+    if(device->write("PAR1", 4) != 4)
+        return false;
+
+    for(auto&& c : _columns)
+    {
+        ChunkInfo info;
+        const int size = valueSize(c.Type);
+        const int width = bitWidth(c.Dictionary.size() - 1);
+
+        // dictionary pays off when the dictionary plus packed indexes beat plain values
+        const qint64 plainSize = qint64(c.Indexes.size()) * size;
+        const qint64 dictSize = qint64(c.Dictionary.size()) * size + qint64(c.Indexes.size()) * width / 8;
+        info.UseDictionary = !c.Dictionary.isEmpty() && dictSize < plainSize;
+
+        QByteArray page;
+        if(c.Nullable)
+        {
+            QVector<quint32> levels(c.Defined.size());
+            for(int i = 0; i < levels.size(); i++)
+                levels[i] = c.Defined[i] ? 1 : 0;
+
+            const auto encoded = encodeHybrid(levels, 1);
+            char len[4];
+            qToLittleEndian<quint32>(encoded.size(), len);
+            page.append(len, 4);
+            page.append(encoded);
+        }
+
+        if(info.UseDictionary)
+        {
+            QByteArray dict;
+            for(auto&& bits : c.Dictionary)
+                appendPlain(dict, bits, size);
+
+            const auto header = pageHeader(PageDictionary, dict.size(), c.Dictionary.size(), EncodingPlainDictionary);
+            info.DictionaryOffset = offset;
+            if(device->write(header) != header.size() || device->write(dict) != dict.size())
+                return false;
+            offset += header.size() + dict.size();
+
+            page.append(char(width));
+            page.append(encodeHybrid(c.Indexes, width));
+        }
+        else
+        {
+            for(auto&& idx : c.Indexes)
+                appendPlain(page, c.Dictionary[idx], size);
+        }
+
+        const auto header = pageHeader(PageData, page.size(), c.NumRows, info.UseDictionary ? EncodingPlainDictionary : EncodingPlain);
+        info.DataOffset = offset;
+        if(device->write(header) != header.size() || device->write(page) != page.size())
+            return false;
+        offset += header.size() + page.size();
+
+        info.Size = offset - (info.UseDictionary ? info.DictionaryOffset : info.DataOffset);
+        chunks.push_back(info);
+    }
+
+    ThriftWriter w;
+    w.beginStruct();
+    w.fieldI32(1, 1);
+
+    // schema
+    w.fieldHeader(2, ThriftWriter::List);
+    w.listHeader(_columns.size() + 1, ThriftWriter::Struct);
+    w.beginStruct();
+    w.fieldString(4, "schema");
+    w.fieldI32(5, _columns.size());
+    w.endStruct();
+    for(auto&& c : _columns)
+    {
+        w.beginStruct();
+        w.fieldI32(1, c.Type);
+        w.fieldI32(3, c.Nullable ? RepetitionOptional : RepetitionRequired);
+        w.fieldString(4, c.Name);
+        if(c.Converted != NoConvertedType)
+            w.fieldI32(6, c.Converted);
+        w.endStruct();
+    }
+
+    w.fieldI64(3, numRows);
+
+    // row groups
+    qint64 totalSize = 0;
+    for(auto&& info : chunks)
+        totalSize += info.Size;
+
+    w.fieldHeader(4, ThriftWriter::List);
+    w.listHeader(1, ThriftWriter::Struct);
+    w.beginStruct();
+    w.fieldHeader(1, ThriftWriter::List);
+    w.listHeader(_columns.size(), ThriftWriter::Struct);
+    for(int i = 0; i < _columns.size(); i++)
+    {
+        const auto& c = _columns[i];
+        const auto& info = chunks[i];
+
+        w.beginStruct();
+        w.fieldI64(2, info.UseDictionary ? info.DictionaryOffset : info.DataOffset);
+        w.fieldHeader(3, ThriftWriter::Struct);
+        w.beginStruct();
+        w.fieldI32(1, c.Type);
+        w.fieldHeader(2, ThriftWriter::List);
+        if(info.UseDictionary)
+        {
+            w.listHeader(3, ThriftWriter::I32);
+            w.writeI32(EncodingPlainDictionary);
+            w.writeI32(EncodingPlain);
+            w.writeI32(EncodingRle);
+        }
+        else
+        {
+            w.listHeader(2, ThriftWriter::I32);
+            w.writeI32(EncodingPlain);
+            w.writeI32(EncodingRle);
+        }
+        w.fieldHeader(3, ThriftWriter::List);
+        w.listHeader(1, ThriftWriter::Binary);
+        w.writeString(c.Name);
+        w.fieldI32(4, CodecUncompressed);
+        w.fieldI64(5, c.NumRows);
+        w.fieldI64(6, info.Size);
+        w.fieldI64(7, info.Size);
+        w.fieldI64(9, info.DataOffset);
+        if(info.UseDictionary)
+            w.fieldI64(11, info.DictionaryOffset);
+        w.endStruct();
+        w.endStruct();
+    }
+    w.fieldI64(2, totalSize);
+    w.fieldI64(3, numRows);
+    w.endStruct();
+
+    // key-value metadata
+    if(!_metadata.isEmpty())
+    {
+        w.fieldHeader(5, ThriftWriter::List);
+        w.listHeader(_metadata.size(), ThriftWriter::Struct);
+        for(auto&& kv : _metadata)
+        {
+            w.beginStruct();
+            w.fieldString(1, kv.first);
+            w.fieldString(2, kv.second);
+            w.endStruct();
+        }
+    }
+
+    w.fieldString(6, QString(APP_NAME) + " " + QString(APP_VERSION));
+    w.endStruct();
+
+    const auto& footer = w.data();
+    char len[4];
+    qToLittleEndian<quint32>(footer.size(), len);
+
+    return device->write(footer) == footer.size() &&
+           device->write(len, 4) == 4 &&
+           device->write("PAR1", 4) == 4;
+}
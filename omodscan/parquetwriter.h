@@ -0,0 +1,66 @@
+#ifndef PARQUETWRITER_H
+#define PARQUETWRITER_H
+
+#include <QHash>
+#include <QPair>
+#include <QVector>
+#include <QString>
+#include <QIODevice>
+#include <QByteArray>
+
+///
+/// \brief The ParquetWriter class
+/// Minimal Apache Parquet writer: one row group, uncompressed pages,
+/// dictionary/RLE encoding chosen per column when it is smaller than plain
+///
+class ParquetWriter
+{
+public:
+    enum PhysicalType
+    {
+        Int32 = 1,
+        Int64 = 2,
+        Float = 4,
+        Double = 5
+    };
+
+    enum ConvertedType
+    {
+        NoConvertedType = -1,
+        TimestampMillis = 9,
+        UInt16 = 12,
+        UInt32 = 13,
+        Int16 = 16
+    };
+
+    int addColumn(const QString& name, PhysicalType type, ConvertedType converted = NoConvertedType, bool nullable = false);
+    void setMetadata(const QString& key, const QString& value);
+
+    void append(int column, qint64 value);
+    void append(int column, double value);
+    void appendNull(int column);
+
+    bool write(QIODevice* device) const;
+
+private:
+    struct Column
+    {
+        QString Name;
+        PhysicalType Type;
+        ConvertedType Converted;
+        bool Nullable;
+        qint64 NumRows = 0;
+        QVector<bool> Defined;
+        QVector<quint32> Indexes;
+        QVector<quint64> Dictionary;
+        QHash<quint64, quint32> Lookup;
+    };
+
+    void appendBits(int column, quint64 bits);
+
+private:
+    QVector<Column> _columns;
+    QVector<QPair<QString, QString>> _metadata;
+};
+
+#endif // PARQUETWRITER_H
@@ -0,0 +1,328 @@
+#include <QtEndian>
+#include "pcapreader.h"
+
+namespace {
+const quint32 PcapMagic = 0xA1B2C3D4;
+const quint32 PcapMagicNano = 0xA1B23C4D;
+const quint32 PcapNgSectionHeader = 0x0A0D0D0A;
+const quint32 PcapNgByteOrderMagic = 0x1A2B3C4D;
+
+const quint32 PcapNgInterfaceDescription = 1;
+const quint32 PcapNgPacket = 2;
+const quint32 PcapNgSimplePacket = 3;
+const quint32 PcapNgEnhancedPacket = 6;
+
+// larger records are treated as a corrupted file rather than allocated
+const qint64 MaxRecordSize = 16 * 1024 * 1024;
+}
+
+///
+/// \brief PcapReader::PcapReader
+/// \param device
+///
+PcapReader::PcapReader(QIODevice* device)
+    : _device(device)
+{
+}
+
+///
+/// \brief PcapReader::isPcapFile
+/// \param header first bytes of the file
+/// \return
+///
+bool PcapReader::isPcapFile(const QByteArray& header)
+{
+    if(header.size() < 4)
+        return false;
+
+    const auto magic = qFromLittleEndian<quint32>(header.constData());
+    const auto magicBE = qFromBigEndian<quint32>(header.constData());
+    return magic == PcapNgSectionHeader ||
+           magic == PcapMagic || magicBE == PcapMagic ||
+           magic == PcapMagicNano || magicBE == PcapMagicNano;
+}
+
+///
+/// \brief PcapReader::open
+/// Reads the file header, the device must be open for reading
+/// \return
+///
+bool PcapReader::open()
+{
+    QByteArray header;
+    if(!readBytes(header, 4))
+    {
+        _errorString = QObject::tr("Not a pcap file");
+        return false;
+    }
+
+    const auto magic = qFromLittleEndian<quint32>(header.constData());
+    if(magic == PcapNgSectionHeader)
+    {
+        _ng = true;
+        if(!readBytes(header, 8) || !readSectionHeader(header))
+        {
+            if(_errorString.isEmpty())
+                _errorString = QObject::tr("Truncated pcapng header");
+
+            return false;
+        }
+        return true;
+    }
+
+    const auto magicBE = qFromBigEndian<quint32>(header.constData());
+    if(magic != PcapMagic && magic != PcapMagicNano && magicBE != PcapMagic && magicBE != PcapMagicNano)
+    {
+        _errorString = QObject::tr("Not a pcap file");
+        return false;
+    }
+
+    _swapped = (magicBE == PcapMagic || magicBE == PcapMagicNano);
+    _nanoseconds = (magic == PcapMagicNano || magicBE == PcapMagicNano);
+
+    if(!readBytes(header, 20))
+    {
+        _errorString = QObject::tr("Truncated pcap header");
+        return false;
+    }
+
+    _linkType = int(readUInt32(header.constData() + 16) & 0xFFFF);
+    return true;
+}
+
+///
+/// \brief PcapReader::readPacket
+/// \param packet
+/// \return false at the end of the file or on error
+///
+bool PcapReader::readPacket(PcapPacket& packet)
+{
+    return _ng ? readNgPacket(packet) : readClassicPacket(packet);
+}
+
+///
+/// \brief PcapReader::readClassicPacket
+/// \param packet
+/// \return
+///
+bool PcapReader::readClassicPacket(PcapPacket& packet)
+{
+    if(!readBytes(_buffer, 16))
+        return false;
+
+    const quint32 sec = readUInt32(_buffer.constData());
+    const quint32 frac = readUInt32(_buffer.constData() + 4);
+    const quint32 length = readUInt32(_buffer.constData() + 8);
+    if(length > MaxRecordSize)
+    {
+        _errorString = QObject::tr("Corrupted packet record");
+        return false;
+    }
+
+    if(!readBytes(packet.Data, length))
+        return false;
+
+    packet.LinkType = _linkType;
+    packet.Timestamp = qint64(sec) * 1000 + (_nanoseconds ? frac / 1000000 : frac / 1000);
+    return true;
+}
+
+///
+/// \brief PcapReader::readNgPacket
+/// Skips blocks until the next packet block
+/// \param packet
+/// \return
+///
+bool PcapReader::readNgPacket(PcapPacket& packet)
+{
+    while(readBytes(_buffer, 8))
+    {
+        const quint32 type = readUInt32(_buffer.constData());
+        const quint32 length = readUInt32(_buffer.constData() + 4);
+
+        if(type == PcapNgSectionHeader)
+        {
+            QByteArray magic;
+            if(!readBytes(magic, 4) || !readSectionHeader(_buffer.mid(4) + magic))
+                return false;
+
+            continue;
+        }
+
+        if(length < 12 || length > MaxRecordSize || (length & 3))
+        {
+            _errorString = QObject::tr("Corrupted block");
+            return false;
+        }
+
+        // body and trailing length
+        if(!readBytes(_buffer, length - 8))
+            return false;
+
+        const char* body = _buffer.constData();
+        const int bodySize = int(length - 12);
+
+        switch(type)
+        {
+            case PcapNgInterfaceDescription:
+                parseInterface(QByteArray::fromRawData(body, bodySize));
+            break;
+
+            case PcapNgEnhancedPacket:
+            case PcapNgPacket:
+            {
+                if(bodySize < 20) break;
+
+                const int interface = (type == PcapNgPacket) ? readUInt16(body) : int(readUInt32(body));
+                const quint32 captured = readUInt32(body + 12);
+                if(interface >= _interfaces.size() || captured > quint32(bodySize - 20))
+                    break;
+
+                packet.LinkType = _interfaces[interface].LinkType;
+                packet.Timestamp = ngTimestamp(interface, readUInt32(body + 4), readUInt32(body + 8));
+                packet.Data = QByteArray(body + 20, captured);
+                return true;
+            }
+
+            case PcapNgSimplePacket:
+            {
+                if(bodySize < 4 || _interfaces.isEmpty()) break;
+
+                const quint32 original = readUInt32(body);
+                packet.LinkType = _interfaces[0].LinkType;
+                packet.Timestamp = 0;
+                packet.Data = QByteArray(body + 4, int(qMin<qint64>(original, bodySize - 4)));
+                return true;
+            }
+        }
+    }
+
+    return false;
+}
+
+///
+/// \brief PcapReader::readSectionHeader
+/// Every section may use its own byte order, interfaces are numbered per section
+/// \param lengthAndMagic block length followed by the byte-order magic
+/// \return
+///
+bool PcapReader::readSectionHeader(const QByteArray& lengthAndMagic)
+{
+    const char* magic = lengthAndMagic.constData() + 4;
+    _swapped = (qFromLittleEndian<quint32>(magic) != PcapNgByteOrderMagic);
+    if(_swapped && qFromBigEndian<quint32>(magic) != PcapNgByteOrderMagic)
+    {
+        _errorString = QObject::tr("Corrupted section header");
+        return false;
+    }
+
+    const quint32 length = readUInt32(lengthAndMagic.constData());
+    if(length < 28 || length > MaxRecordSize || (length & 3))
+    {
+        _errorString = QObject::tr("Corrupted section header");
+        return false;
+    }
+
+    _interfaces.clear();
+
+    // version, section length, options and trailing length
+    return readBytes(_buffer, length - 12);
+}
+
+///
+/// \brief PcapReader::parseInterface
+/// \param body
+///
+void PcapReader::parseInterface(const QByteArray& body)
+{
+    Interface iface;
+    if(body.size() >= 8)
+        iface.LinkType = readUInt16(body.constData());
+
+    // options are 32-bit aligned code/length/value triplets
+    int pos = 8;
+    while(pos + 4 <= body.size())
+    {
+        const quint16 code = readUInt16(body.constData() + pos);
+        const quint16 length = readUInt16(body.constData() + pos + 2);
+        if(code == 0 || pos + 4 + length > body.size())
+            break;
+
+        // if_tsresol: negative power of 10, or of 2 when the high bit is set
+        if(code == 9 && length >= 1)
+        {
+            const quint8 res = quint8(body[pos + 4]);
+            const int exp = res & 0x7F;
+            if((res & 0x80) && exp < 64)
+            {
+                iface.TicksPerSecond = Q_UINT64_C(1) << exp;
+            }
+            else if(!(res & 0x80) && exp <= 19)
+            {
+                iface.TicksPerSecond = 1;
+                for(int i = 0; i < exp; i++)
+                    iface.TicksPerSecond *= 10;
+            }
+        }
+
+        pos += 4 + ((length + 3) & ~3);
+    }
+
+    _interfaces.push_back(iface);
+}
+
+///
+/// \brief PcapReader::ngTimestamp
+/// \param interface
+/// \param high
+/// \param low
+/// \return msecs since epoch
+///
+qint64 PcapReader::ngTimestamp(int interface, quint32 high, quint32 low) const
+{
+    const quint64 ticks = quint64(high) << 32 | low;
+    const quint64 tps = _interfaces[interface].TicksPerSecond;
+    const quint64 msecs = (tps >= 1000) ? (ticks % tps) / (tps / 1000) : (ticks % tps) * 1000 / tps;
+    return qint64(ticks / tps * 1000 + msecs);
+}
+
+///
+/// \brief PcapReader::readBytes
+/// \param buffer
+/// \param size
+/// \return
+///
+bool PcapReader::readBytes(QByteArray& buffer, qint64 size)
+{
+    buffer.resize(int(size));
+    if(size == 0)
+        return true;
+
+    if(_device->read(buffer.data(), size) != size)
+    {
+        buffer.clear();
+        return false;
+    }
+
+    return true;
+}
+
+///
+/// \brief PcapReader::readUInt16
+/// \param p
+/// \return
+///
+quint16 PcapReader::readUInt16(const char* p) const
+{
+    return _swapped ? qFromBigEndian<quint16>(p) : qFromLittleEndian<quint16>(p);
+}
+
+///
+/// \brief PcapReader::readUInt32
+/// \param p
+/// \return
+///
+quint32 PcapReader::readUInt32(const char* p) const
+{
+    return _swapped ? qFromBigEndian<quint32>(p) : qFromLittleEndian<quint32>(p);
+}
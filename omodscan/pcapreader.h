@@ -0,0 +1,76 @@
+#ifndef PCAPREADER_H
+#define PCAPREADER_H
+
+#include <QVector>
+#include <QIODevice>
+#include <QByteArray>
+
+///
+/// \brief The PcapPacket struct
+///
+struct PcapPacket
+{
+    qint64 Timestamp = 0; ///< msecs since epoch
+    int LinkType = 0;
+    QByteArray Data;
+};
+
+///
+/// \brief The PcapReader class
+/// Sequential reader of classic pcap and pcapng files, one packet is held in memory at a time
+///
+class PcapReader
+{
+public:
+    enum LinkType
+    {
+        LinkNull = 0,
+        LinkEthernet = 1,
+        LinkRaw = 101,
+        LinkLinuxSll = 113,
+        LinkIPv4 = 228,
+        LinkIPv6 = 229,
+        LinkLinuxSll2 = 276
+    };
+
+    explicit PcapReader(QIODevice* device);
+
+    bool open();
+    bool readPacket(PcapPacket& packet);
+
+    QString errorString() const {
+        return _errorString;
+    }
+
+    static bool isPcapFile(const QByteArray& header);
+
+private:
+    bool readClassicPacket(PcapPacket& packet);
+    bool readNgPacket(PcapPacket& packet);
+    bool readSectionHeader(const QByteArray& lengthAndMagic);
+    bool readBytes(QByteArray& buffer, qint64 size);
+    quint16 readUInt16(const char* p) const;
+    quint32 readUInt32(const char* p) const;
+    void parseInterface(const QByteArray& body);
+    qint64 ngTimestamp(int interface, quint32 high, quint32 low) const;
+
+private:
+    struct Interface
+    {
+        int LinkType = 0;
+        quint64 TicksPerSecond = 1000000;
+    };
+
+    QIODevice* _device;
+    QString _errorString;
+
+    bool _ng = false;
+    bool _swapped = false;
+    bool _nanoseconds = false;
+    int _linkType = 0;
+
+    QVector<Interface> _interfaces;
+    QByteArray _buffer;
+};
+
+#endif // PCAPREADER_H
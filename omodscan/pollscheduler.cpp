@@ -0,0 +1,129 @@
+#include <QtMath>
+#include "polltask.h"
+#include "pollscheduler.h"
+
+namespace {
+const int BackoffThreshold = 2;
+const qint64 BackoffInitial = 1000000;
+const qint64 BackoffMaximum = 32000000;
+}
+
+///
+/// \brief PollScheduler::PollScheduler
+/// \param parent
+///
+PollScheduler::PollScheduler(QObject* parent)
+    : QObject(parent)
+{
+    _clock.start();
+
+    _timer.setSingleShot(true);
+    _timer.setTimerType(Qt::PreciseTimer);
+    connect(&_timer, &QTimer::timeout, this, &PollScheduler::on_timeout);
+}
+
+///
+/// \brief PollScheduler::nextPhase
+/// Golden ratio sequence, any number of tasks ends up evenly spread over the period
+/// \return fraction of the scan period in [0, 1)
+///
+double PollScheduler::nextPhase()
+{
+    const double phase = _phaseCounter++ * 0.6180339887498949;
+    return phase - qFloor(phase);
+}
+
+///
+/// \brief PollScheduler::schedule
+/// \param task
+/// \param generation entries of an older generation were cancelled by stop() or a restart
+/// \param due usecs on the scheduler clock
+///
+void PollScheduler::schedule(PollTask* task, quint64 generation, qint64 due)
+{
+    _queue.push({ due, generation, task });
+    arm();
+}
+
+///
+/// \brief PollScheduler::isPollAllowed
+/// After repeated timeouts a device gets one probe per back-off interval, shared by all tasks polling it
+/// \param deviceId
+/// \return
+///
+bool PollScheduler::isPollAllowed(int deviceId)
+{
+    const auto it = _devices.find(deviceId);
+    if(it == _devices.end() || it->Timeouts < BackoffThreshold)
+        return true;
+
+    const auto time = now();
+    if(time < it->NextProbe)
+        return false;
+
+    const auto shift = qMin(it->Timeouts - BackoffThreshold, 5);
+    it->NextProbe = time + qMin(BackoffInitial << shift, BackoffMaximum);
+    return true;
+}
+
+///
+/// \brief PollScheduler::deviceResponded
+/// Any answer, an exception included, closes the breaker and normal scanning resumes
+/// \param deviceId
+///
+void PollScheduler::deviceResponded(int deviceId)
+{
+    _devices.remove(deviceId);
+}
+
+///
+/// \brief PollScheduler::deviceTimedOut
+/// \param deviceId
+///
+void PollScheduler::deviceTimedOut(int deviceId)
+{
+    _devices[deviceId].Timeouts++;
+}
+
+///
+/// \brief PollScheduler::on_timeout
+///
+void PollScheduler::on_timeout()
+{
+    const auto time = now();
+    while(!_queue.empty() && _queue.top().Due <= time)
+    {
+        const auto entry = _queue.top();
+        _queue.pop();
+
+        if(entry.Task && entry.Task->_generation == entry.Generation)
+            entry.Task->on_deadline(entry.Due, time);
+    }
+
+    arm();
+}
+
+///
+/// \brief PollScheduler::arm
+/// Starts the timer for the earliest deadline, cancelled entries are dropped on the way
+///
+void PollScheduler::arm()
+{
+    while(!_queue.empty())
+    {
+        const auto& top = _queue.top();
+        if(top.Task && top.Task->_generation == top.Generation)
+            break;
+
+        _queue.pop();
+    }
+
+    if(_queue.empty())
+    {
+        _timer.stop();
+        return;
+    }
+
+    const auto wait = _queue.top().Due - now();
+    _timer.start(wait > 0 ? int((wait + 999) / 1000) : 0);
+}
@@ -0,0 +1,70 @@
+#ifndef POLLSCHEDULER_H
+#define POLLSCHEDULER_H
+
+#include <queue>
+#include <vector>
+#include <QHash>
+#include <QTimer>
+#include <QPointer>
+#include <QElapsedTimer>
+
+class PollTask;
+
+///
+/// \brief The PollScheduler class
+/// Single precise timer serving the deadlines of all poll tasks from a min-heap on a monotonic clock.
+/// Deadlines lie on a fixed grid per task, so the scan period does not drift with reply handling
+/// and the tasks get different phases instead of firing together.
+/// It also keeps a circuit breaker per device id, so a dead slave is only probed at a falling rate
+/// instead of spending a full response timeout on every scan
+///
+class PollScheduler : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PollScheduler(QObject* parent = nullptr);
+
+    qint64 now() const {
+        return _clock.nsecsElapsed() / 1000;
+    }
+
+    double nextPhase();
+    void schedule(PollTask* task, quint64 generation, qint64 due);
+
+    bool isPollAllowed(int deviceId);
+    void deviceResponded(int deviceId);
+    void deviceTimedOut(int deviceId);
+
+private slots:
+    void on_timeout();
+
+private:
+    void arm();
+
+private:
+    struct Entry
+    {
+        qint64 Due;
+        quint64 Generation;
+        QPointer<PollTask> Task;
+
+        bool operator >(const Entry& other) const {
+            return Due > other.Due;
+        }
+    };
+
+    struct DeviceState
+    {
+        int Timeouts = 0;
+        qint64 NextProbe = 0;
+    };
+
+    QElapsedTimer _clock;
+    QTimer _timer;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> _queue;
+    int _phaseCounter = 0;
+    QHash<int, DeviceState> _devices;
+};
+
+#endif // POLLSCHEDULER_H
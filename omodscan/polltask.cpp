@@ -0,0 +1,475 @@
+#include <cstring>
+#include "formatutils.h"
+#include "numericutils.h"
+#include "modbuslimits.h"
+#include "modbusexception.h"
+#include "polltask.h"
+
+namespace {
+///
+/// \brief writtenType
+/// \param functionCode
+/// \param type receives the register type the function writes to
+/// \return false if the function writes nothing
+///
+bool writtenType(QModbusPdu::FunctionCode functionCode, QModbusDataUnit::RegisterType& type)
+{
+    switch(functionCode)
+    {
+        case QModbusPdu::WriteSingleCoil:
+        case QModbusPdu::WriteMultipleCoils:
+            type = QModbusDataUnit::Coils;
+            return true;
+
+        case QModbusPdu::WriteSingleRegister:
+        case QModbusPdu::WriteMultipleRegisters:
+        case QModbusPdu::MaskWriteRegister:
+        case QModbusPdu::ReadWriteMultipleRegisters:
+            type = QModbusDataUnit::HoldingRegisters;
+            return true;
+
+        default:
+            return false;
+    }
+}
+}
+
+///
+/// \brief PollTask::PollTask
+/// \param requestId tags the requests so the replies of other tasks can be told apart
+/// \param client
+/// \param scheduler shared by all tasks polling through the same client
+/// \param parent
+///
+PollTask::PollTask(int requestId, ModbusClient& client, PollScheduler& scheduler, QObject* parent)
+    : QObject(parent)
+    ,_requestId(requestId)
+    ,_modbusClient(client)
+    ,_scheduler(scheduler)
+    ,_phase(scheduler.nextPhase())
+{
+    connect(&_modbusClient, &ModbusClient::modbusRequest, this, &PollTask::on_modbusRequest);
+    connect(&_modbusClient, &ModbusClient::modbusReply, this, &PollTask::on_modbusReply);
+}
+
+///
+/// \brief PollTask::setDefinition
+/// Takes effect with the next request, call start() to apply it at once.
+/// The reported block is only forgotten when another block is polled
+/// \param dd
+///
+void PollTask::setDefinition(const DisplayDefinition& dd)
+{
+    const bool sameBlock = dd.DeviceId == _definition.DeviceId &&
+                           dd.PointType == _definition.PointType &&
+                           dd.PointAddress == _definition.PointAddress &&
+                           dd.ZeroBasedAddress == _definition.ZeroBasedAddress &&
+                           dd.Length == _definition.Length;
+    if(!sameBlock)
+        _lastData = QModbusDataUnit();
+
+    _definition = dd;
+}
+
+///
+/// \brief PollTask::setValueFormat
+/// How the registers are decoded downstream, the deadband is applied to the decoded values
+/// \param mode
+/// \param order
+///
+void PollTask::setValueFormat(DataDisplayMode mode, ByteOrder order)
+{
+    _valueMode = mode;
+    _byteOrder = order;
+}
+
+///
+/// \brief PollTask::resetStatistics
+///
+void PollTask::resetStatistics()
+{
+    _numberOfPolls = 0;
+    _validSlaveResponses = 0;
+    _lastValidSlaveResponses = 0;
+    _statistics.reset();
+    _scanJitter.reset();
+    _missedDeadlines = 0;
+    _skippedPolls = 0;
+    _unchangedReplies = 0;
+
+    emit numberOfPollsChanged(_numberOfPolls);
+    emit validSlaveResposesChanged(_validSlaveResponses);
+    emit statisticsChanged();
+}
+
+///
+/// \brief PollTask::start
+/// Sends the first request immediately, the following ones are due on the task's
+/// grid of the scan period, at least half a period later. The reported block is kept,
+/// a restart after a write passes on only what the write changed
+///
+void PollTask::start()
+{
+    if(_modbusClient.state() != QModbusDevice::ConnectedState)
+        return;
+
+    if(!sendReadRequest())
+        emit statusChanged(Status::InvalidLength, QString());
+
+    const qint64 period = qint64(_definition.ScanRate) * 1000;
+    const qint64 offset = qint64(_phase * period);
+    const auto now = _scheduler.now();
+    const auto earliest = now + period / 2;
+    const auto due = offset + ((earliest - offset + period - 1) / period) * period;
+
+    _active = true;
+    _lastPoll = now;
+    _pollInterval = 0;
+    _scheduler.schedule(this, ++_generation, due);
+}
+
+///
+/// \brief PollTask::stop
+///
+void PollTask::stop()
+{
+    _active = false;
+    _generation++;
+}
+
+///
+/// \brief PollTask::isValidReply
+/// \param reply
+/// \return
+///
+bool PollTask::isValidReply(const QModbusReply* reply) const
+{
+    const auto& dd = _definition;
+    const auto data = reply->result();
+    const auto response = reply->rawResult();
+    const auto addr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
+
+    switch(response.functionCode())
+    {
+        case QModbusPdu::ReadCoils:
+        case QModbusPdu::ReadDiscreteInputs:
+            return (data.startAddress() == addr) && (data.valueCount() - dd.Length) < 8;
+
+        case QModbusPdu::ReadInputRegisters:
+        case QModbusPdu::ReadHoldingRegisters:
+            return (data.valueCount() == dd.Length) && (data.startAddress() == addr);
+
+        default:
+            return true;
+    }
+}
+
+///
+/// \brief PollTask::registersPerValue
+/// \param mode
+/// \return number of registers one decoded value spans
+///
+int PollTask::registersPerValue(DataDisplayMode mode)
+{
+    switch(mode)
+    {
+        case DataDisplayMode::FloatingPt:
+        case DataDisplayMode::SwappedFP:
+        case DataDisplayMode::Int32:
+        case DataDisplayMode::SwappedInt32:
+        case DataDisplayMode::UInt32:
+        case DataDisplayMode::SwappedUInt32:
+            return 2;
+
+        case DataDisplayMode::DblFloat:
+        case DataDisplayMode::SwappedDbl:
+        case DataDisplayMode::Int64:
+        case DataDisplayMode::SwappedInt64:
+        case DataDisplayMode::UInt64:
+        case DataDisplayMode::SwappedUInt64:
+            return 4;
+
+        default:
+            return 1;
+    }
+}
+
+///
+/// \brief PollTask::isNumeric
+/// \param mode
+/// \return true if the deadband applies to values decoded in this mode
+///
+bool PollTask::isNumeric(DataDisplayMode mode)
+{
+    switch(mode)
+    {
+        case DataDisplayMode::Binary:
+        case DataDisplayMode::Hex:
+        case DataDisplayMode::Ansi:
+            return false;
+
+        default:
+            return true;
+    }
+}
+
+///
+/// \brief PollTask::reportChanges
+/// Report by exception: only the values whose registers differ from the reported ones are passed on,
+/// a decoded number moving less than the deadband keeps its previously reported registers
+/// \param data the reply, replaced by the block to report
+/// \param changed receives the changed registers, it stays empty when the whole block is new
+/// \return false when there is nothing to report
+///
+bool PollTask::reportChanges(QModbusDataUnit& data, QBitArray& changed)
+{
+    if(!_definition.ReportByException)
+        return true;
+
+    const bool sameBlock = _lastData.isValid() &&
+                           _lastData.startAddress() == data.startAddress() &&
+                           _lastData.valueCount() == data.valueCount();
+    if(!sameBlock)
+    {
+        _lastData = data;
+        return true;
+    }
+
+    const auto values = data.values();
+    auto reported = _lastData.values();
+    if(std::memcmp(reported.constData(), values.constData(), size_t(values.size()) * sizeof(quint16)) == 0)
+        return false;
+
+    const auto pointType = _definition.PointType;
+    const bool isBit = (pointType == QModbusDataUnit::Coils || pointType == QModbusDataUnit::DiscreteInputs);
+    const int words = isBit ? 1 : registersPerValue(_valueMode);
+    const double deadband = (isBit || !isNumeric(_valueMode)) ? 0 : _definition.Deadband;
+    const int count = values.size();
+
+    changed.resize(count);
+    bool hasChanges = false;
+    for(int i = 0; i < count; i += words)
+    {
+        const int n = qMin(words, count - i);
+
+        quint16 diff = 0;
+        for(int k = 0; k < n; k++)
+            diff |= values[i + k] ^ reported[i + k];
+
+        if(diff == 0)
+            continue;
+
+        if(deadband > 0 && n == words &&
+           qAbs(decodeValue(values.constData() + i) - decodeValue(reported.constData() + i)) < deadband)
+        {
+            continue;
+        }
+
+        for(int k = 0; k < n; k++)
+        {
+            reported[i + k] = values[i + k];
+            changed.setBit(i + k);
+        }
+        hasChanges = true;
+    }
+
+    if(!hasChanges)
+        return false;
+
+    _lastData.setValues(reported);
+    data = _lastData;
+    return true;
+}
+
+///
+/// \brief PollTask::decodeValue
+/// \param values registers of one value
+/// \return the value as shown in the current value format
+///
+double PollTask::decodeValue(const quint16* values) const
+{
+    const auto v = values;
+    switch(_valueMode)
+    {
+        case DataDisplayMode::Int16: return qint16(toByteOrderValue(v[0], _byteOrder));
+        case DataDisplayMode::FloatingPt: return makeFloat(v[0], v[1], _byteOrder);
+        case DataDisplayMode::SwappedFP: return makeFloat(v[1], v[0], _byteOrder);
+        case DataDisplayMode::DblFloat: return makeDouble(v[0], v[1], v[2], v[3], _byteOrder);
+        case DataDisplayMode::SwappedDbl: return makeDouble(v[3], v[2], v[1], v[0], _byteOrder);
+        case DataDisplayMode::Int32: return makeInt32(v[0], v[1], _byteOrder);
+        case DataDisplayMode::SwappedInt32: return makeInt32(v[1], v[0], _byteOrder);
+        case DataDisplayMode::UInt32: return makeUInt32(v[0], v[1], _byteOrder);
+        case DataDisplayMode::SwappedUInt32: return makeUInt32(v[1], v[0], _byteOrder);
+        case DataDisplayMode::Int64: return double(makeInt64(v[0], v[1], v[2], v[3], _byteOrder));
+        case DataDisplayMode::SwappedInt64: return double(makeInt64(v[3], v[2], v[1], v[0], _byteOrder));
+        case DataDisplayMode::UInt64: return double(quint64(makeUInt64(v[0], v[1], v[2], v[3], _byteOrder)));
+        case DataDisplayMode::SwappedUInt64: return double(quint64(makeUInt64(v[3], v[2], v[1], v[0], _byteOrder)));
+        default: return toByteOrderValue(v[0], _byteOrder);
+    }
+}
+
+///
+/// \brief PollTask::sendReadRequest
+/// \return false if the definition runs past the address range
+///
+bool PollTask::sendReadRequest()
+{
+    const auto& dd = _definition;
+    const auto addr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
+    if(addr + dd.Length > ModbusLimits::addressRange(dd.ZeroBasedAddress).to())
+        return false;
+
+    _modbusClient.sendReadRequest(dd.PointType, addr, dd.Length, dd.DeviceId, _requestId);
+    return true;
+}
+
+///
+/// \brief PollTask::on_deadline
+/// Missed deadlines are merged into this single request and the next one stays on the grid
+/// \param due
+/// \param now
+///
+void PollTask::on_deadline(qint64 due, qint64 now)
+{
+    const qint64 period = qint64(_definition.ScanRate) * 1000;
+    const auto missed = (now - due) / period;
+    _missedDeadlines += quint64(missed);
+    _scheduler.schedule(this, _generation, due + (missed + 1) * period);
+
+    _scanJitter.record(now - due);
+
+    const auto interval = double(now - _lastPoll);
+    _pollInterval = (_pollInterval > 0) ? 0.9 * _pollInterval + 0.1 * interval : interval;
+    _lastPoll = now;
+
+    if(_modbusClient.state() != QModbusDevice::ConnectedState)
+        return;
+
+    const auto& dd = _definition;
+    const auto addr = dd.PointAddress - (dd.ZeroBasedAddress ? 0 : 1);
+    if(addr + dd.Length > ModbusLimits::addressRange(dd.ZeroBasedAddress).to())
+        return;
+
+    if(!_scheduler.isPollAllowed(dd.DeviceId))
+    {
+        _skippedPolls++;
+        return;
+    }
+
+    if(_lastValidSlaveResponses == _validSlaveResponses)
+    {
+        _noSlaveResponsesCounter++;
+        if(_noSlaveResponsesCounter > _modbusClient.numberOfRetries())
+        {
+            emit statusChanged(Status::NoResponse, QString());
+        }
+    }
+
+    sendReadRequest();
+}
+
+///
+/// \brief PollTask::on_modbusRequest
+/// \param requestId
+/// \param request
+///
+void PollTask::on_modbusRequest(int requestId, int, int, const QModbusRequest& request)
+{
+    if(requestId != _requestId)
+        return;
+
+    switch(request.functionCode())
+    {
+        case QModbusPdu::ReadCoils:
+        case QModbusPdu::ReadDiscreteInputs:
+        case QModbusPdu::ReadHoldingRegisters:
+        case QModbusPdu::ReadInputRegisters:
+            _numberOfPolls++;
+            emit numberOfPollsChanged(_numberOfPolls);
+        break;
+
+        default:
+        break;
+    }
+}
+
+///
+/// \brief PollTask::on_modbusReply
+/// A successful write to the polled device and register type, from anywhere, restarts the poll
+/// so the new values show up at once
+/// \param reply
+///
+void PollTask::on_modbusReply(QModbusReply* reply)
+{
+    if(!reply) return;
+
+    const auto response = reply->rawResult();
+    const bool hasError = reply->error() != QModbusDevice::NoError;
+
+    switch(response.functionCode())
+    {
+        case QModbusRequest::ReadCoils:
+        case QModbusRequest::ReadDiscreteInputs:
+        case QModbusRequest::ReadInputRegisters:
+        case QModbusRequest::ReadHoldingRegisters:
+        break;
+
+        default:
+        {
+            QModbusDataUnit::RegisterType type;
+            if(!hasError && _active && writtenType(response.functionCode(), type) &&
+               type == _definition.PointType && reply->serverAddress() == _definition.DeviceId)
+            {
+                start();
+            }
+        }
+        return;
+    }
+
+    if(reply->property("RequestId").toInt() != _requestId)
+        return;
+
+    _statistics.Requests++;
+    _statistics.addReply(reply->error(), reply->property("Latency").toLongLong());
+
+    if(reply->error() == QModbusDevice::TimeoutError)
+        _scheduler.deviceTimedOut(reply->serverAddress());
+    else if(!hasError || reply->error() == QModbusDevice::ProtocolError)
+        _scheduler.deviceResponded(reply->serverAddress());
+
+    if (!hasError)
+    {
+        if(!isValidReply(reply))
+        {
+            emit statusChanged(Status::InvalidResponse, QString());
+        }
+        else
+        {
+            auto data = reply->result();
+            QBitArray changed;
+            if(reportChanges(data, changed))
+                emit dataReceived(data, changed);
+            else
+                _unchangedReplies++;
+
+            emit statusChanged(Status::Ok, QString());
+
+            _validSlaveResponses++;
+            emit validSlaveResposesChanged(_validSlaveResponses);
+        }
+    }
+    else if (reply->error() == QModbusDevice::ProtocolError)
+    {
+        const auto ex = ModbusException(response.exceptionCode());
+        emit statusChanged(Status::Exception, QString("%1 (%2)").arg(ex, formatUInt8Value(DataDisplayMode::Hex, ex)));
+    }
+    else
+    {
+        emit statusChanged(Status::Error, reply->errorString());
+    }
+
+    emit statisticsChanged();
+
+    _noSlaveResponsesCounter = 0;
+    _lastValidSlaveResponses = _validSlaveResponses;
+}
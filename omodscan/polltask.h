@@ -0,0 +1,113 @@
+#ifndef POLLTASK_H
+#define POLLTASK_H
+
+#include <QBitArray>
+#include "enums.h"
+#include "modbusclient.h"
+#include "pollscheduler.h"
+#include "modbusstatistics.h"
+#include "displaydefinition.h"
+
+///
+/// \brief The PollTask class
+/// Periodic read of one display definition: scheduling, reply validation and statistics.
+/// It knows nothing about widgets, FormModSca and the headless poller only present its results
+///
+class PollTask : public QObject
+{
+    Q_OBJECT
+
+    friend class PollScheduler;
+
+public:
+    enum class Status
+    {
+        Ok,
+        InvalidLength,
+        NoResponse,
+        InvalidResponse,
+        Exception,
+        Error
+    };
+    Q_ENUM(Status)
+
+    explicit PollTask(int requestId, ModbusClient& client, PollScheduler& scheduler, QObject* parent = nullptr);
+
+    int requestId() const {
+        return _requestId;
+    }
+
+    const DisplayDefinition& definition() const {
+        return _definition;
+    }
+    void setDefinition(const DisplayDefinition& dd);
+    void setValueFormat(DataDisplayMode mode, ByteOrder order);
+
+    bool isActive() const {
+        return _active;
+    }
+
+    uint numberOfPolls() const { return _numberOfPolls; }
+    uint validSlaveResponses() const { return _validSlaveResponses; }
+    const ModbusStatistics& statistics() const { return _statistics; }
+
+    double achievedRate() const { return _pollInterval > 0 ? 1e6 / _pollInterval : 0; }
+    const LatencyHistogram& scanJitter() const { return _scanJitter; }
+    quint64 missedDeadlines() const { return _missedDeadlines; }
+    quint64 skippedPolls() const { return _skippedPolls; }
+    quint64 unchangedReplies() const { return _unchangedReplies; }
+    void resetStatistics();
+
+    bool isValidReply(const QModbusReply* reply) const;
+
+    static int registersPerValue(DataDisplayMode mode);
+    static bool isNumeric(DataDisplayMode mode);
+
+public slots:
+    void start();
+    void stop();
+
+signals:
+    void dataReceived(const QModbusDataUnit& data, const QBitArray& changed);
+    void statusChanged(PollTask::Status status, const QString& details);
+    void numberOfPollsChanged(uint value);
+    void validSlaveResposesChanged(uint value);
+    void statisticsChanged();
+
+private slots:
+    void on_modbusRequest(int requestId, int deviceId, int transactionId, const QModbusRequest& request);
+    void on_modbusReply(QModbusReply* reply);
+
+private:
+    bool sendReadRequest();
+    bool reportChanges(QModbusDataUnit& data, QBitArray& changed);
+    double decodeValue(const quint16* values) const;
+    void on_deadline(qint64 due, qint64 now);
+
+private:
+    const int _requestId;
+    ModbusClient& _modbusClient;
+    PollScheduler& _scheduler;
+    DisplayDefinition _definition;
+    DataDisplayMode _valueMode = DataDisplayMode::UInt16;
+    ByteOrder _byteOrder = ByteOrder::Direct;
+
+    bool _active = false;
+    quint64 _generation = 0;
+    double _phase = 0;
+    qint64 _lastPoll = 0;
+    double _pollInterval = 0;
+    LatencyHistogram _scanJitter;
+    quint64 _missedDeadlines = 0;
+    quint64 _skippedPolls = 0;
+    quint64 _unchangedReplies = 0;
+    QModbusDataUnit _lastData;
+
+    uint _numberOfPolls = 0;
+    uint _validSlaveResponses = 0;
+    uint _lastValidSlaveResponses = 0;
+    uint _noSlaveResponsesCounter = 0;
+    ModbusStatistics _statistics;
+};
+
+#endif // POLLTASK_H
@@ -6,48 +6,53 @@
 
 ///
 /// \brief The QModbusAdu class
+/// Non-owning view over a raw frame buffer, fields are parsed in place
 ///
 class QModbusAdu
 {
 public:
     ///
     /// \brief QModbusAdu
-    /// \param type
     /// \param data
-    ///
-    explicit QModbusAdu() = default;
-    virtual ~QModbusAdu() = default;
-
-    ///
-    /// \brief isValid
-    /// \return
-    ///
-    virtual bool isValid() const = 0;
+    /// \param size
+    /// \param pduOffset offset of the function code
+    /// \param pduDataSize
+    ///
+    explicit QModbusAdu(const char* data, int size, int pduOffset, int pduDataSize)
+        : _data(data)
+        , _size(size)
+        , _pduOffset(pduOffset)
+        , _pduDataSize(qMax(0, pduDataSize))
+    {
+    }
 
     ///
     /// \brief rawData
     /// \return
     ///
-    QByteArray rawData() const { return _data; }
+    const char* rawData() const { return _data; }
 
     ///
-    /// \brief setRawData
-    /// \param data
+    /// \brief rawSize
+    /// \return
     ///
-    virtual void setRawData(const QByteArray& data)  = 0;
+    int rawSize() const { return _size; }
 
     ///
-    /// \brief serverAddress
-    /// \return
+    /// \brief at
+    /// \param idx
+    /// \return the raw byte at idx or zero when it is out of the frame
     ///
-    virtual quint8 serverAddress() const  = 0;
+    quint8 at(int idx) const {
+        return (idx >= 0 && idx < _size) ? quint8(_data[idx]) : 0;
+    }
 
     ///
     /// \brief functionCode
     /// \return
     ///
     QModbusPdu::FunctionCode functionCode() const {
-        return _pdu.functionCode();
+        return QModbusPdu::FunctionCode(at(_pduOffset) & ~QModbusPdu::ExceptionByte);
     }
 
     ///
@@ -55,7 +60,8 @@ public:
     /// \return
     ///
     QModbusPdu::ExceptionCode exceptionCode() const {
-        return _pdu.exceptionCode();
+        if(!_pduDataSize || !isException()) return QModbusPdu::ExtendedException;
+        return QModbusPdu::ExceptionCode(pduAt(0));
     }
 
     ///
@@ -63,20 +69,47 @@ public:
     /// \return
     ///
     bool isException() const {
-        return _pdu.isException();
+        return at(_pduOffset) & QModbusPdu::ExceptionByte;
+    }
+
+    ///
+    /// \brief isPduValid
+    /// \return
+    ///
+    bool isPduValid() const {
+        return at(_pduOffset) != QModbusPdu::Invalid && _pduDataSize + 1 < 254;
+    }
+
+    ///
+    /// \brief pduData
+    /// \return pointer to the PDU data following the function code
+    ///
+    const char* pduData() const {
+        return _data + qMin(_size, _pduOffset + 1);
+    }
+
+    ///
+    /// \brief pduDataSize
+    /// \return
+    ///
+    int pduDataSize() const {
+        return qMin(_pduDataSize, qMax(0, _size - _pduOffset - 1));
     }
 
     ///
-    /// \brief pdu
+    /// \brief pduAt
+    /// \param idx
     /// \return
     ///
-    const QModbusPdu& pdu() const {
-        return _pdu;
+    quint8 pduAt(int idx) const {
+        return (idx >= 0 && idx < pduDataSize()) ? quint8(pduData()[idx]) : 0;
     }
 
 protected:
-    QByteArray _data;
-    QModbusPdu _pdu;
+    const char* _data;
+    int _size;
+    int _pduOffset;
+    int _pduDataSize;
 };
 
 #endif // QMODBUSADU_H
@@ -3,6 +3,7 @@
 
 #include "qmodbusadu.h"
 #include "numericutils.h"
+#include "modbuscrc.h"
 
 ///
 /// \brief The QModbusAduRtu class
@@ -10,36 +11,34 @@
 class QModbusAduRtu : public QModbusAdu
 {
 public:
-    explicit QModbusAduRtu(const QByteArray& rawData)
-        : QModbusAdu()
+    explicit QModbusAduRtu(const char* data, int size)
+        : QModbusAdu(data, size, 1, size - 4)
     {
-        setRawData(rawData);
     }
 
     ///
-    /// \brief isValid
-    /// \return
+    /// \brief QModbusAduRtu
+    /// \param rawData must outlive the view
     ///
-    bool isValid() const override {
-        return matchingChecksum() && _pdu.isValid();
+    explicit QModbusAduRtu(const QByteArray& rawData)
+        : QModbusAduRtu(rawData.constData(), rawData.size())
+    {
     }
 
     ///
-    /// \brief setRawData
-    /// \param data
+    /// \brief isValid
+    /// \return
     ///
-    void setRawData(const QByteArray& data) override {
-        _data = data;
-        _pdu.setFunctionCode(QModbusPdu::FunctionCode((quint8)_data[1]));
-        _pdu.setData(_data.mid(2, _data.size() - 4));
+    bool isValid() const {
+        return matchingChecksum() && isPduValid();
     }
 
     ///
     /// \brief serverAddress
     /// \return
     ///
-    quint8 serverAddress() const override {
-        return quint8(_data[0]);
+    quint8 serverAddress() const {
+        return at(0);
     }
 
     ///
@@ -47,7 +46,7 @@ public:
     /// \return
     ///
     quint16 checksum() const {
-        return makeUInt16(_data[_data.size() - 1], _data[_data.size() - 2], ByteOrder::Direct);
+        return makeUInt16(at(_size - 1), at(_size - 2), ByteOrder::Direct);
     }
 
     ///
@@ -55,9 +54,8 @@ public:
     /// \return
     ///
     quint16 calcChecksum() const {
-        const auto size = _data.size() - 2; // two bytes, CRC
-        const auto data = _data.left(size);
-        return calculateCRC(data, size);
+        const auto size = _size - 2; // two bytes, CRC
+        return calculateCRC(_data, size);
     }
 
     ///
@@ -68,33 +66,16 @@ public:
         return checksum() == calcChecksum();
     }
 
+    ///
+    /// \brief calculateCRC
+    /// \param data
+    /// \param len
+    /// \return CRC with swapped bytes, as it is streamed big-endian after the PDU
+    ///
     inline static quint16 calculateCRC(const char* data, qint32 len){
-        quint16 crc = 0xFFFF;
-        while (len--) {
-            const quint8 c = *data++;
-            for (qint32 i = 0x01; i & 0xFF; i <<= 1) {
-                bool bit = crc & 0x8000;
-                if (c & i)
-                    bit = !bit;
-                crc <<= 1;
-                if (bit)
-                    crc ^= 0x8005;
-            }
-            crc &= 0xFFFF;
-        }
-        crc = crc_reflect(crc & 0xFFFF, 16) ^ 0x0000;
+        const quint16 crc = ModbusCrc::calculate(data, len);
         return (crc >> 8) | (crc << 8); // swap bytes
     }
-
-private:
-    inline static quint16 crc_reflect(quint16 data, qint32 len){
-        quint16 ret = data & 0x01;
-        for (qint32 i = 1; i < len; i++) {
-            data >>= 1;
-            ret = (ret << 1) | (data & 0x01);
-        }
-        return ret;
-    }
 };
 
 #endif // QMODBUSADURTU_H
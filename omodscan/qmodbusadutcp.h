@@ -10,28 +10,26 @@
 class QModbusAduTcp : public QModbusAdu
 {
 public:
-    explicit QModbusAduTcp(const QByteArray& rawData)
-        : QModbusAdu()
+    explicit QModbusAduTcp(const char* data, int size)
+        : QModbusAdu(data, size, 7, size - 8)
     {
-        setRawData(rawData);
     }
 
     ///
-    /// \brief isValid
-    /// \return
+    /// \brief QModbusAduTcp
+    /// \param rawData must outlive the view
     ///
-    bool isValid() const override {
-        return _pdu.isValid() && length() == _pdu.size() + 1;
+    explicit QModbusAduTcp(const QByteArray& rawData)
+        : QModbusAduTcp(rawData.constData(), rawData.size())
+    {
     }
 
     ///
-    /// \brief setRawData
-    /// \param data
+    /// \brief isValid
+    /// \return
     ///
-    void setRawData(const QByteArray& data) override {
-        _data = data;
-        _pdu.setFunctionCode(QModbusPdu::FunctionCode((quint8)_data[7]));
-        _pdu.setData(_data.mid(8));
+    bool isValid() const {
+        return isPduValid() && length() == pduDataSize() + 2;
     }
 
     ///
@@ -39,17 +37,7 @@ public:
     /// \return
     ///
     quint16 transactionId() const {
-        return makeUInt16(_data[1], _data[0], ByteOrder::Direct);
-    }
-
-    ///
-    /// \brief setTransactionId
-    /// \param id
-    ///
-    void setTransactionId(quint16 id) {
-        quint8 lo,hi;
-        breakUInt16(id, lo, hi, ByteOrder::Direct);
-        _data[1] = lo; _data[0] = hi;
+        return makeUInt16(at(1), at(0), ByteOrder::Direct);
     }
 
     ///
@@ -57,7 +45,7 @@ public:
     /// \return
     ///
     quint16 protocolId() const {
-        return makeUInt16(_data[3], _data[2], ByteOrder::Direct);
+        return makeUInt16(at(3), at(2), ByteOrder::Direct);
     }
 
     ///
@@ -65,15 +53,15 @@ public:
     /// \return
     ///
     quint16 length() const {
-        return makeUInt16(_data[5], _data[4], ByteOrder::Direct);
+        return makeUInt16(at(5), at(4), ByteOrder::Direct);
     }
 
     ///
     /// \brief serverAddress
     /// \return
     ///
-    quint8 serverAddress() const override {
-        return quint8(_data[6]);
+    quint8 serverAddress() const {
+        return at(6);
     }
 
 };
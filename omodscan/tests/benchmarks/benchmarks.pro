@@ -0,0 +1,29 @@
+QT += gui widgets
+
+TARGET = tst_benchmarks
+
+include(../tests.pri)
+
+INCLUDEPATH += $$PWD/../../controls \
+               $$PWD/../../modbusmessages
+
+# OMODSCAN_CHECK_BASELINES=1 checks every benchmark against it, OMODSCAN_UPDATE_BASELINES=1 writes the measured values back
+DEFINES += BASELINES_FILE=\\\"$$PWD/baselines.json\\\"
+
+SOURCES += \
+    ../../controls/modbuslogwidget.cpp \
+    ../../controls/modbusmessagewidget.cpp \
+    ../../controls/outputwidget.cpp \
+    ../../htmldelegate.cpp \
+    ../../modbusmessages/modbusmessage.cpp \
+    tst_benchmarks.cpp
+
+HEADERS += \
+    ../../controls/modbuslogwidget.h \
+    ../../controls/modbusmessagewidget.h \
+    ../../controls/outputwidget.h \
+    ../../htmldelegate.h \
+    ../../modbusmessages/modbusmessage.h
+
+FORMS += \
+    ../../controls/outputwidget.ui
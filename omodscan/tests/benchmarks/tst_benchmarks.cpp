@@ -0,0 +1,614 @@
+#include <QtTest>
+#include <QFile>
+#include <QListView>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QElapsedTimer>
+#include <QRandomGenerator>
+#include "modbuscrc.h"
+#include "formatutils.h"
+#include "numericutils.h"
+#include "qmodbusadurtu.h"
+#include "modbusmessages.h"
+#include "outputwidget.h"
+#include "modbuslogwidget.h"
+
+namespace {
+const qint64 MeasureTime = 200000000; // ns each baseline check runs for
+const double DefaultTolerance = 1.2;
+const int BlockLength = 125;
+
+///
+/// \brief referenceCrc
+/// Bitwise CRC-16/MODBUS, the table driven one is checked against it
+/// \param data
+/// \return
+///
+quint16 referenceCrc(const QByteArray& data)
+{
+    quint16 crc = 0xFFFF;
+    for(auto&& c : data)
+    {
+        crc ^= quint8(c);
+        for(int i = 0; i < 8; i++)
+            crc = (crc & 1) ? quint16((crc >> 1) ^ 0xA001) : quint16(crc >> 1);
+    }
+    return crc;
+}
+
+///
+/// \brief randomBytes
+/// \param size
+/// \return
+///
+QByteArray randomBytes(int size)
+{
+    QByteArray data(size, '\0');
+    for(auto&& c : data)
+        c = char(QRandomGenerator::global()->bounded(256));
+    return data;
+}
+
+///
+/// \brief makeBlock
+/// \param seed
+/// \return holding registers 1..BlockLength
+///
+QModbusDataUnit makeBlock(quint16 seed)
+{
+    QVector<quint16> values(BlockLength);
+    for(int i = 0; i < BlockLength; i++)
+        values[i] = quint16(seed + i * 257);
+    return QModbusDataUnit(QModbusDataUnit::HoldingRegisters, 0, values);
+}
+
+///
+/// \brief makeResponse
+/// \return read holding registers response with BlockLength registers
+///
+QModbusResponse makeResponse()
+{
+    QByteArray data;
+    data.append(char(BlockLength * 2));
+    for(auto&& v : makeBlock(0x1234).values())
+    {
+        data.append(char(v >> 8));
+        data.append(char(v & 0xFF));
+    }
+    return QModbusResponse(QModbusPdu::ReadHoldingRegisters, data);
+}
+}
+
+///
+/// \brief The TestBenchmarks class
+/// Correctness checks and benchmarks of the hot paths: register decoding, formatting, CRC,
+/// message creation and the output and log models
+///
+class TestBenchmarks : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void numericRoundTrip_data();
+    void numericRoundTrip();
+    void benchmarkMakeValues();
+    void benchmarkBreakValues();
+
+    void formatters_data();
+    void formatters();
+    void benchmarkFormatters();
+
+    void crc();
+    void benchmarkCrc();
+    void benchmarkCalculateCRC();
+
+    void createMessage();
+    void benchmarkCreateMessage();
+
+    void outputUpdateData();
+    void benchmarkOutputFullUpdate();
+    void benchmarkOutputMaskedUpdate();
+
+    void logAppend();
+    void benchmarkLogAppend();
+
+private:
+    template<typename Function>
+    void measure(const QString& name, Function fn);
+
+    void setupOutput(OutputWidget& output);
+
+    double _tolerance = DefaultTolerance;
+    bool _checkBaselines = false;
+    bool _updateBaselines = false;
+    QJsonObject _baselines;
+    QJsonObject _measured;
+};
+
+///
+/// \brief TestBenchmarks::initTestCase
+///
+void TestBenchmarks::initTestCase()
+{
+    _checkBaselines = qEnvironmentVariableIsSet("OMODSCAN_CHECK_BASELINES");
+    _updateBaselines = qEnvironmentVariableIsSet("OMODSCAN_UPDATE_BASELINES");
+    if(!_checkBaselines && !_updateBaselines)
+        return;
+
+    QFile file(BASELINES_FILE);
+    if(!file.open(QFile::ReadOnly))
+    {
+        qWarning("%s not found, the benchmarks are not checked", BASELINES_FILE);
+        return;
+    }
+
+    const auto root = QJsonDocument::fromJson(file.readAll()).object();
+    _tolerance = root.value("tolerance").toDouble(DefaultTolerance);
+    _baselines = root.value("benchmarks").toObject();
+}
+
+///
+/// \brief TestBenchmarks::cleanupTestCase
+///
+void TestBenchmarks::cleanupTestCase()
+{
+    if(!_updateBaselines)
+        return;
+
+    auto benchmarks = _baselines;
+    for(auto it = _measured.constBegin(); it != _measured.constEnd(); ++it)
+        benchmarks.insert(it.key(), it.value());
+
+    QJsonObject root;
+    root.insert("tolerance", _tolerance);
+    root.insert("benchmarks", benchmarks);
+
+    QFile file(BASELINES_FILE);
+    QVERIFY(file.open(QFile::WriteOnly | QFile::Truncate));
+    file.write(QJsonDocument(root).toJson());
+}
+
+///
+/// \brief TestBenchmarks::measure
+/// QBENCHMARK does not hand its result back, the baseline is checked against a timed batch of its own.
+/// Wall-clock numbers only mean something on the machine they were recorded on, so the check runs
+/// with OMODSCAN_CHECK_BASELINES=1 only and a plain make check just runs the benchmark
+/// \param name
+/// \param fn
+///
+template<typename Function>
+void TestBenchmarks::measure(const QString& name, Function fn)
+{
+    QBENCHMARK {
+        fn();
+    }
+
+    if(!_checkBaselines && !_updateBaselines)
+        return;
+
+    QElapsedTimer timer;
+    qint64 iterations = 0;
+    timer.start();
+    do
+    {
+        fn();
+        iterations++;
+    }
+    while(timer.nsecsElapsed() < MeasureTime);
+
+    const double ns = double(timer.nsecsElapsed()) / iterations;
+    if(_updateBaselines)
+    {
+        _measured.insert(name, QJsonObject{ { "ns", qRound(ns) } });
+        return;
+    }
+
+    const double baseline = _baselines.value(name).toObject().value("ns").toDouble();
+    if(baseline <= 0)
+        QSKIP(qPrintable(QString("%1: %2 ns, no baseline recorded").arg(name, QString::number(ns, 'f', 0))));
+
+    const auto message = QString("%1: %2 ns, baseline %3 ns").arg(name, QString::number(ns, 'f', 0), QString::number(baseline));
+    QVERIFY2(ns <= baseline * _tolerance, qPrintable(message));
+}
+
+///
+/// \brief TestBenchmarks::numericRoundTrip_data
+///
+void TestBenchmarks::numericRoundTrip_data()
+{
+    QTest::addColumn<ByteOrder>("order");
+    QTest::newRow("direct") << ByteOrder::Direct;
+    QTest::newRow("swapped") << ByteOrder::Swapped;
+}
+
+///
+/// \brief TestBenchmarks::numericRoundTrip
+///
+void TestBenchmarks::numericRoundTrip()
+{
+    QFETCH(ByteOrder, order);
+
+    quint8 lo8, hi8;
+    breakUInt16(0xA55A, lo8, hi8, order);
+    QCOMPARE(makeUInt16(lo8, hi8, order), quint16(0xA55A));
+
+    quint16 lo, hi;
+    breakFloat(-123.25f, lo, hi, order);
+    QCOMPARE(makeFloat(lo, hi, order), -123.25f);
+
+    breakInt32(-123456789, lo, hi, order);
+    QCOMPARE(makeInt32(lo, hi, order), -123456789);
+
+    breakUInt32(0xDEADBEEF, lo, hi, order);
+    QCOMPARE(makeUInt32(lo, hi, order), 0xDEADBEEFu);
+
+    quint16 lolo, lohi, hilo, hihi;
+    breakDouble(-1.0e300, lolo, lohi, hilo, hihi, order);
+    QCOMPARE(makeDouble(lolo, lohi, hilo, hihi, order), -1.0e300);
+
+    breakInt64(-1234567890123456789LL, lolo, lohi, hilo, hihi, order);
+    QCOMPARE(makeInt64(lolo, lohi, hilo, hihi, order), -1234567890123456789LL);
+
+    breakUInt64(0xFEDCBA9876543210ULL, lolo, lohi, hilo, hihi, order);
+    QCOMPARE(quint64(makeUInt64(lolo, lohi, hilo, hihi, order)), 0xFEDCBA9876543210ULL);
+}
+
+///
+/// \brief TestBenchmarks::benchmarkMakeValues
+/// Decodes a block as floats and as doubles
+///
+void TestBenchmarks::benchmarkMakeValues()
+{
+    const auto values = makeBlock(0x4000).values();
+    const auto v = values.constData();
+
+    // the sum goes to a volatile, or the decoding could be optimized away
+    volatile double sink = 0;
+    measure("makeValues", [&]{
+        double sum = 0;
+        for(int i = 0; i + 1 < BlockLength; i += 2)
+            sum += makeFloat(v[i], v[i + 1], ByteOrder::Direct);
+        for(int i = 0; i + 3 < BlockLength; i += 4)
+            sum += makeDouble(v[i], v[i + 1], v[i + 2], v[i + 3], ByteOrder::Swapped);
+        sink = sum;
+    });
+    QVERIFY(sink != 0);
+}
+
+///
+/// \brief TestBenchmarks::benchmarkBreakValues
+/// Encodes a block of floats and doubles
+///
+void TestBenchmarks::benchmarkBreakValues()
+{
+    QVector<quint16> values(BlockLength);
+    auto v = values.data();
+
+    measure("breakValues", [&]{
+        for(int i = 0; i + 1 < BlockLength; i += 2)
+            breakFloat(i * 0.5f, v[i], v[i + 1], ByteOrder::Direct);
+        for(int i = 0; i + 3 < BlockLength; i += 4)
+            breakDouble(i * 0.25, v[i], v[i + 1], v[i + 2], v[i + 3], ByteOrder::Swapped);
+    });
+    QCOMPARE(makeFloat(v[2], v[3], ByteOrder::Direct), 1.f);
+}
+
+///
+/// \brief TestBenchmarks::formatters_data
+///
+void TestBenchmarks::formatters_data()
+{
+    numericRoundTrip_data();
+}
+
+///
+/// \brief TestBenchmarks::formatters
+///
+void TestBenchmarks::formatters()
+{
+    QFETCH(ByteOrder, order);
+
+    QVariant value;
+    const quint16 v = 0x12AB;
+    const quint16 ordered = toByteOrderValue(v, order);
+
+    QCOMPARE(formatUInt16Value(QModbusDataUnit::HoldingRegisters, v, order, value), QString("<%1>").arg(ordered, 5, 10, QLatin1Char('0')));
+    QCOMPARE(value.toUInt(), uint(ordered));
+
+    QCOMPARE(formatInt16Value(QModbusDataUnit::HoldingRegisters, qint16(v), order, value), QString("<%1>").arg(qint16(ordered), 5, 10, QLatin1Char(' ')));
+    QCOMPARE(formatHexValue(QModbusDataUnit::HoldingRegisters, v, order, value), QString("<0x%1>").arg(QString::number(ordered, 16).toUpper(), 4, '0'));
+    QCOMPARE(formatBinaryValue(QModbusDataUnit::HoldingRegisters, v, order, value), QString("<%1>").arg(ordered, 16, 2, QLatin1Char('0')));
+    QCOMPARE(formatUInt16Value(QModbusDataUnit::Coils, 1, order, value), QString("<1>"));
+
+    quint16 lo, hi;
+    breakFloat(2.5f, lo, hi, order);
+    QCOMPARE(formatFloatValue(QModbusDataUnit::HoldingRegisters, lo, hi, order, false, value), QLocale().toString(2.5f));
+    QCOMPARE(value.toFloat(), 2.5f);
+    QVERIFY(formatFloatValue(QModbusDataUnit::HoldingRegisters, lo, hi, order, true, value).isEmpty());
+
+    breakInt32(-42, lo, hi, order);
+    QCOMPARE(formatInt32Value(QModbusDataUnit::InputRegisters, lo, hi, order, false, value), QString("<%1>").arg(-42, 10, 10, QLatin1Char(' ')));
+
+    quint16 lolo, lohi, hilo, hihi;
+    breakDouble(0.125, lolo, lohi, hilo, hihi, order);
+    QCOMPARE(formatDoubleValue(QModbusDataUnit::HoldingRegisters, lolo, lohi, hilo, hihi, order, false, value), QLocale().toString(0.125, 'g', 16));
+
+    breakUInt64(1234567890123ULL, lolo, lohi, hilo, hihi, order);
+    formatUInt64Value(QModbusDataUnit::HoldingRegisters, lolo, lohi, hilo, hihi, order, false, value);
+    QCOMPARE(value.toULongLong(), 1234567890123ULL);
+
+    QCOMPARE(formatUInt16Value(DataDisplayMode::UInt16, 42), QString("00042"));
+    QCOMPARE(formatUInt16Value(DataDisplayMode::Hex, 0xAB), QString("0x00AB"));
+}
+
+///
+/// \brief TestBenchmarks::benchmarkFormatters
+/// Formats a block in the 16, 32 and 64-bit modes
+///
+void TestBenchmarks::benchmarkFormatters()
+{
+    const auto values = makeBlock(0x4000).values();
+    const auto v = values.constData();
+    const auto type = QModbusDataUnit::HoldingRegisters;
+
+    QVariant value;
+    QString text;
+    measure("formatters", [&]{
+        for(int i = 0; i < BlockLength; i++)
+        {
+            text = formatUInt16Value(type, v[i], ByteOrder::Direct, value);
+            text = formatHexValue(type, v[i], ByteOrder::Direct, value);
+        }
+        for(int i = 0; i + 1 < BlockLength; i += 2)
+            text = formatFloatValue(type, v[i], v[i + 1], ByteOrder::Direct, false, value);
+        for(int i = 0; i + 3 < BlockLength; i += 4)
+            text = formatInt64Value(type, v[i], v[i + 1], v[i + 2], v[i + 3], ByteOrder::Direct, false, value);
+    });
+    QVERIFY(!text.isEmpty());
+}
+
+///
+/// \brief TestBenchmarks::crc
+///
+void TestBenchmarks::crc()
+{
+    QCOMPARE(ModbusCrc::calculate("123456789", 9), quint16(0x4B37));
+
+    const QByteArray request = QByteArray::fromHex("01030000000A");
+    QCOMPARE(ModbusCrc::calculate(request.constData(), request.size()), quint16(0xCDC5));
+    QCOMPARE(QModbusAduRtu::calculateCRC(request.constData(), request.size()), quint16(0xC5CD));
+    QCOMPARE(ModbusCrc::calculate(nullptr, 0), quint16(0xFFFF));
+
+    // every tail length of the slicing-by-8 loop
+    const auto data = randomBytes(300);
+    for(int len = 0; len <= data.size(); len++)
+    {
+        const auto part = data.left(len);
+        QCOMPARE(ModbusCrc::calculate(part.constData(), part.size()), referenceCrc(part));
+    }
+
+    const auto frame = ModbusMessage::create(QModbusRequest(QModbusPdu::ReadHoldingRegisters, quint16(0), quint16(10)),
+                                             ModbusMessage::Rtu, 1, QDateTime::currentDateTime(), true);
+    QCOMPARE(frame->rawData(), QByteArray::fromHex("01030000000AC5CD"));
+    QVERIFY(frame->aduRtu().matchingChecksum());
+    delete frame;
+}
+
+///
+/// \brief TestBenchmarks::benchmarkCrc
+/// CRC of a maximum length RTU frame
+///
+void TestBenchmarks::benchmarkCrc()
+{
+    const auto data = randomBytes(256);
+
+    volatile quint16 crc = 0;
+    measure("crc", [&]{
+        crc = ModbusCrc::calculate(data.constData(), data.size());
+    });
+    QCOMPARE(quint16(crc), referenceCrc(data));
+}
+
+///
+/// \brief TestBenchmarks::benchmarkCalculateCRC
+///
+void TestBenchmarks::benchmarkCalculateCRC()
+{
+    const auto data = randomBytes(256);
+
+    volatile quint16 crc = 0;
+    measure("calculateCRC", [&]{
+        crc = QModbusAduRtu::calculateCRC(data.constData(), data.size());
+    });
+    // byte swapped, as it goes on the wire
+    const quint16 expected = referenceCrc(data);
+    QCOMPARE(quint16(crc), quint16((expected >> 8) | (expected << 8)));
+}
+
+///
+/// \brief TestBenchmarks::createMessage
+///
+void TestBenchmarks::createMessage()
+{
+    const auto timestamp = QDateTime::currentDateTime();
+
+    const auto response = ModbusMessage::create(makeResponse(), ModbusMessage::Rtu, 17, timestamp, false);
+    QVERIFY(dynamic_cast<const ReadHoldingRegistersResponse*>(response) != nullptr);
+    QVERIFY(response->isValid());
+    QVERIFY(!response->isRequest());
+    QCOMPARE(response->deviceId(), 17);
+    QCOMPARE(response->functionCode(), QModbusPdu::ReadHoldingRegisters);
+
+    const auto raw = ModbusMessage::create(response->rawData(), ModbusMessage::Rtu, timestamp, false);
+    QVERIFY(dynamic_cast<const ReadHoldingRegistersResponse*>(raw) != nullptr);
+    QVERIFY(raw->isValid());
+    QCOMPARE(raw->rawData(), response->rawData());
+
+    const auto tcp = ModbusMessage::create(QModbusRequest(QModbusPdu::WriteSingleRegister, quint16(1), quint16(2)),
+                                           ModbusMessage::Tcp, 1, timestamp, true);
+    QVERIFY(dynamic_cast<const WriteSingleRegisterRequest*>(tcp) != nullptr);
+    QVERIFY(tcp->isValid());
+
+    // no typed message for it, the plain one is created
+    const auto unknown = ModbusMessage::create(QModbusRequest(QModbusPdu::FunctionCode(0x41), QByteArray(1, '\0')),
+                                               ModbusMessage::Rtu, 1, timestamp, true);
+    QVERIFY(unknown != nullptr);
+    QVERIFY(dynamic_cast<const ReadHoldingRegistersRequest*>(unknown) == nullptr);
+    QCOMPARE(int(unknown->functionCode()), 0x41);
+
+    delete response;
+    delete raw;
+    delete tcp;
+    delete unknown;
+}
+
+///
+/// \brief TestBenchmarks::benchmarkCreateMessage
+/// Creates and deletes a full read holding registers response, as the log does for every reply
+///
+void TestBenchmarks::benchmarkCreateMessage()
+{
+    const auto pdu = makeResponse();
+    const auto timestamp = QDateTime::currentDateTime();
+
+    measure("createMessage", [&]{
+        delete ModbusMessage::create(pdu, ModbusMessage::Rtu, 1, timestamp, false);
+    });
+}
+
+///
+/// \brief TestBenchmarks::setupOutput
+/// \param output
+///
+void TestBenchmarks::setupOutput(OutputWidget& output)
+{
+    DisplayDefinition dd;
+    dd.PointType = QModbusDataUnit::HoldingRegisters;
+    dd.PointAddress = 1;
+    dd.Length = BlockLength;
+    dd.ReportByException = true;
+
+    output.setDataDisplayMode(DataDisplayMode::UInt16);
+    output.setByteOrder(ByteOrder::Swapped);
+    output.setup(dd, ModbusMessage::Rtu, ModbusSimulationMap());
+}
+
+///
+/// \brief TestBenchmarks::outputUpdateData
+///
+void TestBenchmarks::outputUpdateData()
+{
+    OutputWidget output;
+    setupOutput(output);
+
+    const auto model = output.findChild<QListView*>("listView")->model();
+    QSignalSpy spy(model, &QAbstractItemModel::dataChanged);
+
+    auto data = makeBlock(0);
+    output.updateData(data);
+    QCOMPARE(spy.count(), 1);
+    QCOMPARE(spy.last().at(0).toModelIndex().row(), 0);
+    QCOMPARE(spy.last().at(1).toModelIndex().row(), BlockLength - 1);
+    QCOMPARE(output.data(), data.values());
+
+    QBitArray changed(BlockLength);
+    changed.setBit(10);
+    changed.setBit(20);
+    data.setValue(10, 11);
+    data.setValue(20, 22);
+    output.updateData(data, changed);
+    QCOMPARE(spy.count(), 2);
+    QCOMPARE(spy.last().at(0).toModelIndex().row(), 10);
+    QCOMPARE(spy.last().at(1).toModelIndex().row(), 20);
+    QCOMPARE(output.data(), data.values());
+
+    const auto text = model->data(model->index(10), Qt::DisplayRole).toString();
+    QVERIFY2(text.contains(QString("<%1>").arg(toByteOrderValue<quint16>(11, ByteOrder::Swapped), 5, 10, QLatin1Char('0'))), qPrintable(text));
+
+    // nothing marked, nothing formatted
+    output.updateData(data, QBitArray(BlockLength));
+    QCOMPARE(spy.count(), 2);
+}
+
+///
+/// \brief TestBenchmarks::benchmarkOutputFullUpdate
+///
+void TestBenchmarks::benchmarkOutputFullUpdate()
+{
+    OutputWidget output;
+    setupOutput(output);
+
+    const auto data = makeBlock(0);
+    measure("outputFullUpdate", [&]{
+        output.updateData(data);
+    });
+}
+
+///
+/// \brief TestBenchmarks::benchmarkOutputMaskedUpdate
+/// One changed register of a block, as report by exception passes it on
+///
+void TestBenchmarks::benchmarkOutputMaskedUpdate()
+{
+    OutputWidget output;
+    setupOutput(output);
+
+    auto data = makeBlock(0);
+    output.updateData(data);
+
+    QBitArray changed(BlockLength);
+    changed.setBit(BlockLength / 2);
+
+    quint16 value = 0;
+    measure("outputMaskedUpdate", [&]{
+        data.setValue(BlockLength / 2, value++);
+        output.updateData(data, changed);
+    });
+}
+
+///
+/// \brief TestBenchmarks::logAppend
+///
+void TestBenchmarks::logAppend()
+{
+    ModbusLogWidget log;
+    log.setRowLimit(30);
+
+    const auto model = static_cast<ModbusLogModel*>(log.model());
+    const auto pdu = makeResponse();
+    for(int i = 0; i < 100; i++)
+        model->append(ModbusMessage::create(pdu, ModbusMessage::Rtu, i + 1, QDateTime::currentDateTime(), false));
+
+    QCOMPARE(log.rowCount(), 30);
+    QCOMPARE(log.itemAt(log.index(0))->deviceId(), 71);
+    QCOMPARE(log.itemAt(log.index(29))->deviceId(), 100);
+
+    model->append(nullptr);
+    QCOMPARE(log.rowCount(), 30);
+}
+
+///
+/// \brief TestBenchmarks::benchmarkLogAppend
+/// Appending to a full log drops the oldest row
+///
+void TestBenchmarks::benchmarkLogAppend()
+{
+    ModbusLogWidget log;
+    log.setRowLimit(30);
+
+    const auto model = static_cast<ModbusLogModel*>(log.model());
+    const auto pdu = makeResponse();
+    const auto timestamp = QDateTime::currentDateTime();
+
+    measure("logAppend", [&]{
+        model->append(ModbusMessage::create(pdu, ModbusMessage::Rtu, 1, timestamp, false));
+    });
+    QCOMPARE(log.rowCount(), 30);
+}
+
+QTEST_MAIN(TestBenchmarks)
+
+#include "tst_benchmarks.moc"
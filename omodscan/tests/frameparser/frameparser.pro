@@ -0,0 +1,14 @@
+TARGET = tst_frameparser
+
+include(../tests.pri)
+
+INCLUDEPATH += $$PWD/../../modbusmessages
+
+SOURCES += \
+    ../../modbusframeparser.cpp \
+    ../../modbusmessages/modbusmessage.cpp \
+    tst_frameparser.cpp
+
+HEADERS += \
+    ../../modbusframeparser.h \
+    ../../modbusmessages/modbusmessage.h
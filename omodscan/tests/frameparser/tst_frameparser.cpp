@@ -0,0 +1,124 @@
+#include <QtTest>
+#include "modbusframeparser.h"
+
+namespace {
+// a read of 10 holding registers from unit 1 and its response, 33 bytes
+const QByteArray Request = QByteArray::fromHex("01030000000AC5CD");
+const QByteArray Response = QByteArray::fromHex("010314101112131415161718191A1B1C1D1E1F20212223A52C");
+}
+
+///
+/// \brief The TestFrameParser class
+/// Hex dumps as they are pasted or loaded: one frame per line, wrapped at a fixed width and
+/// with the offset and text columns of xxd and hexdump -C
+///
+class TestFrameParser : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void fromHexDump_data();
+    void fromHexDump();
+
+    void wrappedFrames_data();
+    void wrappedFrames();
+
+    void noiseEndsAtLineStart();
+};
+
+///
+/// \brief TestFrameParser::fromHexDump_data
+///
+void TestFrameParser::fromHexDump_data()
+{
+    QTest::addColumn<QByteArray>("dump");
+    QTest::addColumn<QVector<qint64>>("lineStarts");
+
+    QTest::newRow("frame per line")
+        << QByteArray("01 03 00 00 00 0A C5 CD\n"
+                      "01 03 14 10 11 12 13 14 15 16 17 18 19 1A 1B 1C 1D 1E 1F 20 21 22 23 A5 2C\n")
+        << QVector<qint64>{ 8, 33 };
+
+    QTest::newRow("16 bytes per line")
+        << QByteArray("01 03 00 00 00 0A C5 CD 01 03 14 10 11 12 13 14\n"
+                      "15 16 17 18 19 1A 1B 1C 1D 1E 1F 20 21 22 23 A5\n"
+                      "2C\n")
+        << QVector<qint64>{ 16, 32, 33 };
+
+    QTest::newRow("xxd")
+        << QByteArray("00000000: 0103 0000 000a c5cd 0103 1410 1112 1314  ................\n"
+                      "00000010: 1516 1718 191a 1b1c 1d1e 1f20 2122 23a5  ........... !\"#.\n"
+                      "00000020: 2c                                       ,\n")
+        << QVector<qint64>{ 16, 32, 33 };
+
+    QTest::newRow("hexdump -C")
+        << QByteArray("00000000  01 03 00 00 00 0a c5 cd  01 03 14 10 11 12 13 14  |................|\n"
+                      "00000010  15 16 17 18 19 1a 1b 1c  1d 1e 1f 20 21 22 23 a5  |........... !\"#.|\n"
+                      "00000020  2c                                                |,|\n"
+                      "00000021\n")
+        << QVector<qint64>{ 16, 32, 33 };
+}
+
+///
+/// \brief TestFrameParser::fromHexDump
+///
+void TestFrameParser::fromHexDump()
+{
+    QFETCH(QByteArray, dump);
+    QFETCH(QVector<qint64>, lineStarts);
+
+    QVector<qint64> gaps;
+    QCOMPARE(ModbusFrameParser::fromHexDump(dump, &gaps), Request + Response);
+    QCOMPARE(gaps, lineStarts);
+}
+
+///
+/// \brief TestFrameParser::wrappedFrames_data
+///
+void TestFrameParser::wrappedFrames_data()
+{
+    fromHexDump_data();
+}
+
+///
+/// \brief TestFrameParser::wrappedFrames
+/// Line starts are hints only, a frame continues on the next line when its CRC is not there yet
+///
+void TestFrameParser::wrappedFrames()
+{
+    QFETCH(QByteArray, dump);
+
+    QVector<qint64> gaps;
+    const auto data = ModbusFrameParser::fromHexDump(dump, &gaps);
+    const auto frames = ModbusFrameParser(ModbusMessage::Rtu).parse(data, gaps);
+
+    QCOMPARE(frames.size(), 2);
+    QCOMPARE(frames[0].Offset, 0);
+    QCOMPARE(frames[0].Length, Request.size());
+    QVERIFY(frames[0].Valid);
+    QCOMPARE(frames[1].Offset, Request.size());
+    QCOMPARE(frames[1].Length, Response.size());
+    QVERIFY(frames[1].Valid);
+}
+
+///
+/// \brief TestFrameParser::noiseEndsAtLineStart
+///
+void TestFrameParser::noiseEndsAtLineStart()
+{
+    QVector<qint64> gaps;
+    const auto data = ModbusFrameParser::fromHexDump("FF FF FF\n01 03 00 00 00 0A C5 CD\n", &gaps);
+    const auto frames = ModbusFrameParser(ModbusMessage::Rtu).parse(data, gaps);
+
+    QCOMPARE(frames.size(), 2);
+    QCOMPARE(frames[0].Offset, 0);
+    QCOMPARE(frames[0].Length, 3);
+    QVERIFY(!frames[0].Valid);
+    QCOMPARE(frames[1].Offset, 3);
+    QCOMPARE(frames[1].Length, Request.size());
+    QVERIFY(frames[1].Valid);
+}
+
+QTEST_GUILESS_MAIN(TestFrameParser)
+
+#include "tst_frameparser.moc"
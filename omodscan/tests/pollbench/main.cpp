@@ -0,0 +1,24 @@
+#include <QTimer>
+#include <QCoreApplication>
+#include "pollbenchmark.h"
+
+///
+/// \brief main
+/// \param argc
+/// \param argv
+/// \return
+///
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    a.setApplicationName("omodscan-pollbench");
+
+    PollBenchmark benchmark;
+    if(!benchmark.parse(a.arguments()))
+        return PollBenchmark::UsageError;
+
+    QObject::connect(&benchmark, &PollBenchmark::finished, &a, &QCoreApplication::exit, Qt::QueuedConnection);
+    QTimer::singleShot(0, &benchmark, &PollBenchmark::start);
+
+    return a.exec();
+}
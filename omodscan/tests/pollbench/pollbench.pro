@@ -0,0 +1,23 @@
+QT = core network serialbus serialport
+
+greaterThan(QT_MAJOR_VERSION, 5) {
+    QT += core5compat
+}
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+CONFIG -= debug_and_release
+CONFIG -= debug_and_release_target
+
+TARGET = omodscan-pollbench
+
+# polls the server simulator through the same client, scheduler and tasks as the GUI
+include(../../core/core.pri)
+include(../simulator.pri)
+
+SOURCES += \
+    main.cpp \
+    pollbenchmark.cpp
+
+HEADERS += \
+    pollbenchmark.h
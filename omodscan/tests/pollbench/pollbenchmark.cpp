@@ -0,0 +1,276 @@
+#include <QTimer>
+#include <QCommandLineParser>
+#include "modbuslimits.h"
+#include "pollbenchmark.h"
+
+namespace {
+const int DeviceId = 1;
+const quint32 ResponseTimeout = 1000;
+
+///
+/// \brief seconds
+/// \param tv
+/// \return
+///
+double seconds(const timeval& tv)
+{
+    return tv.tv_sec + tv.tv_usec / 1e6;
+}
+
+///
+/// \brief cpuTime
+/// \param from
+/// \param to
+/// \return user and system time spent between the two samples, in seconds
+///
+double cpuTime(const rusage& from, const rusage& to)
+{
+    return seconds(to.ru_utime) - seconds(from.ru_utime) +
+           seconds(to.ru_stime) - seconds(from.ru_stime);
+}
+}
+
+///
+/// \brief PollBenchmark::PollBenchmark
+/// \param parent
+///
+PollBenchmark::PollBenchmark(QObject* parent)
+    : QObject(parent)
+    ,_out(stdout)
+    ,_err(stderr)
+{
+    connect(&_modbusClient, &ModbusClient::modbusConnected, this, &PollBenchmark::on_modbusConnected);
+    connect(&_modbusClient, &ModbusClient::modbusConnectionError, this, &PollBenchmark::on_modbusConnectionError);
+}
+
+///
+/// \brief PollBenchmark::~PollBenchmark
+///
+PollBenchmark::~PollBenchmark()
+{
+    if(_serverThread)
+    {
+        QMetaObject::invokeMethod(_server, "stop", Qt::BlockingQueuedConnection);
+        _serverThread->quit();
+        _serverThread->wait();
+    }
+}
+
+///
+/// \brief PollBenchmark::parse
+/// \param arguments
+/// \return false when the arguments are not usable, the reason is already printed
+///
+bool PollBenchmark::parse(const QStringList& arguments)
+{
+    QCommandLineParser parser;
+    parser.setApplicationDescription(tr("Polls the server simulator on localhost with tasks sharing one client."));
+    parser.addHelpOption();
+
+    const QCommandLineOption tasksOption("tasks", tr("Number of poll tasks."), "n", "10");
+    const QCommandLineOption scanRateOption("scan-rate", tr("Scan rate of every task."), "ms", "100");
+    const QCommandLineOption durationOption("duration", tr("Measurement time."), "s", "10");
+    const QCommandLineOption countOption("count", tr("Holding registers read by every task."), "count", "10");
+    const QCommandLineOption portOption("port", tr("TCP port of the simulator."), "port", "5502");
+    const QCommandLineOption latencyOption("latency", tr("Response latency of the simulator."), "ms", "0");
+
+    parser.addOptions({ tasksOption, scanRateOption, durationOption, countOption, portOption, latencyOption });
+    parser.process(arguments);
+
+    auto usageError = [this](const QString& error) {
+        _err << error << Qt::endl;
+        return false;
+    };
+
+    bool ok;
+    _tasks = parser.value(tasksOption).toInt(&ok);
+    if(!ok || _tasks < 1)
+        return usageError(tr("Invalid number of tasks %1").arg(parser.value(tasksOption)));
+
+    _scanRate = parser.value(scanRateOption).toUInt(&ok);
+    if(!ok || _scanRate < 20)
+        return usageError(tr("Invalid scan rate %1, the minimum is 20 ms").arg(parser.value(scanRateOption)));
+
+    _duration = parser.value(durationOption).toInt(&ok);
+    if(!ok || _duration < 1)
+        return usageError(tr("Invalid duration %1").arg(parser.value(durationOption)));
+
+    _length = parser.value(countOption).toUShort(&ok);
+    if(!ok || !ModbusLimits::lengthRange().contains(_length))
+        return usageError(tr("Invalid count %1").arg(parser.value(countOption)));
+
+    _port = parser.value(portOption).toUShort(&ok);
+    if(!ok || _port == 0)
+        return usageError(tr("Invalid port %1").arg(parser.value(portOption)));
+
+    _latency = parser.value(latencyOption).toInt(&ok);
+    if(!ok || _latency < 0)
+        return usageError(tr("Invalid latency %1").arg(parser.value(latencyOption)));
+
+    return true;
+}
+
+///
+/// \brief PollBenchmark::start
+///
+void PollBenchmark::start()
+{
+    ModbusServerParams params;
+    params.Type = ConnectionType::Tcp;
+    params.Port = _port;
+    params.UnitIds = QRange<int>(DeviceId, DeviceId);
+    params.Latency = _latency;
+
+    // a thread of its own keeps the simulator out of the timing of the polls
+    _server = new ModbusServerSimulator(params);
+    _serverThread = new QThread(this);
+    _server->moveToThread(_serverThread);
+
+    connect(_server, &ModbusServerSimulator::errorOccurred, this, &PollBenchmark::on_serverError);
+    connect(_serverThread, &QThread::finished, _server, &QObject::deleteLater);
+
+    _serverThread->start(QThread::TimeCriticalPriority);
+    QMetaObject::invokeMethod(_server, "start", Qt::BlockingQueuedConnection);
+
+    ConnectionDetails cd;
+    cd.Type = ConnectionType::Tcp;
+    cd.TcpParams.IPAddress = "127.0.0.1";
+    cd.TcpParams.ServicePort = _port;
+    cd.ModbusParams.SlaveResponseTimeOut = ResponseTimeout;
+    cd.ModbusParams.NumberOfRetries = 1;
+
+    _modbusClient.connectDevice(cd);
+}
+
+///
+/// \brief PollBenchmark::on_serverError
+/// \param error
+///
+void PollBenchmark::on_serverError(const QString& error)
+{
+    finish(CommunicationError, error);
+}
+
+///
+/// \brief PollBenchmark::on_modbusConnected
+/// Every task reads its own block, identical reads would be coalesced by the client
+///
+void PollBenchmark::on_modbusConnected(const ConnectionDetails&)
+{
+    if(_done || !_pollTasks.isEmpty())
+        return;
+
+    for(int i = 0; i < _tasks; i++)
+    {
+        DisplayDefinition dd;
+        dd.ScanRate = _scanRate;
+        dd.DeviceId = DeviceId;
+        dd.PointType = QModbusDataUnit::HoldingRegisters;
+        dd.PointAddress = quint16(1 + (i * _length) % (ModbusLimits::addressRange(false).to() - _length));
+        dd.Length = _length;
+
+        auto task = new PollTask(i + 1, _modbusClient, _scheduler, this);
+        task->setDefinition(dd);
+        _pollTasks.push_back(task);
+    }
+
+    _modbusClient.resetStatistics();
+    getrusage(RUSAGE_SELF, &_startUsage);
+#ifdef RUSAGE_THREAD
+    getrusage(RUSAGE_THREAD, &_startThreadUsage);
+#endif
+    _clock.start();
+
+    for(auto&& task : _pollTasks)
+        task->start();
+
+    QTimer::singleShot(_duration * 1000, this, &PollBenchmark::report);
+}
+
+///
+/// \brief PollBenchmark::on_modbusConnectionError
+/// \param error
+///
+void PollBenchmark::on_modbusConnectionError(const QString& error)
+{
+    finish(CommunicationError, error);
+}
+
+///
+/// \brief PollBenchmark::report
+///
+void PollBenchmark::report()
+{
+    const double elapsed = _clock.nsecsElapsed() / 1e9;
+
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef RUSAGE_THREAD
+    rusage threadUsage;
+    getrusage(RUSAGE_THREAD, &threadUsage);
+#endif
+
+    for(auto&& task : _pollTasks)
+        task->stop();
+
+    quint64 missedDeadlines = 0;
+    quint64 skippedPolls = 0;
+    qint64 scanJitter = 0;
+    for(auto&& task : _pollTasks)
+    {
+        missedDeadlines += task->missedDeadlines();
+        skippedPolls += task->skippedPolls();
+        scanJitter = qMax(scanJitter, task->scanJitter().percentile(99));
+    }
+
+    const auto stats = _modbusClient.statistics().value(DeviceId);
+    const auto& latency = stats.Latency;
+    const auto errors = stats.Exceptions + stats.InvalidResponses + stats.OtherErrors;
+
+#ifdef Q_OS_MACOS
+    const long maxRss = usage.ru_maxrss / 1024; // bytes on macOS
+#else
+    const long maxRss = usage.ru_maxrss;
+#endif
+
+    const double cpu = cpuTime(_startUsage, usage);
+
+    _out << QString("tasks: %1 x %2 registers every %3 ms, target %4 polls/s").arg(_tasks).arg(_length).arg(_scanRate)
+                .arg(_tasks * 1000. / _scanRate, 0, 'f', 1) << Qt::endl;
+    _out << QString("achieved: %1 polls/s, %2 responses, %3 timeouts, %4 errors").arg(stats.Responses / elapsed, 0, 'f', 1)
+                .arg(stats.Responses).arg(stats.Timeouts).arg(errors) << Qt::endl;
+    _out << QString("response time: p50 %1 ms, p95 %2 ms, p99 %3 ms, max %4 ms").arg(formatLatency(latency.percentile(50)),
+                formatLatency(latency.percentile(95)), formatLatency(latency.percentile(99)), formatLatency(latency.max())) << Qt::endl;
+    _out << QString("deadlines: %1 missed, %2 skipped, scan jitter p99 %3 ms").arg(missedDeadlines).arg(skippedPolls)
+                .arg(formatLatency(scanJitter)) << Qt::endl;
+    _out << QString("cpu time: %1 s, %2% of one core, simulator included").arg(cpu, 0, 'f', 2).arg(100 * cpu / elapsed, 0, 'f', 1) << Qt::endl;
+#ifdef RUSAGE_THREAD
+    const double clientCpu = cpuTime(_startThreadUsage, threadUsage);
+    _out << QString("client thread: %1 s, %2% of one core").arg(clientCpu, 0, 'f', 2).arg(100 * clientCpu / elapsed, 0, 'f', 1) << Qt::endl;
+#endif
+    _out << QString("max rss: %1 KB").arg(maxRss) << Qt::endl;
+
+    finish(stats.Responses > 0 ? Success : CommunicationError);
+}
+
+///
+/// \brief PollBenchmark::finish
+/// \param exitCode
+/// \param error
+///
+void PollBenchmark::finish(int exitCode, const QString& error)
+{
+    if(_done) return;
+    _done = true;
+
+    if(!error.isEmpty())
+        _err << error << Qt::endl;
+
+    for(auto&& task : _pollTasks)
+        task->stop();
+
+    _out.flush();
+    _modbusClient.disconnectDevice();
+
+    emit finished(exitCode);
+}
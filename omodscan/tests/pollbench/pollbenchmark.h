@@ -0,0 +1,75 @@
+#ifndef POLLBENCHMARK_H
+#define POLLBENCHMARK_H
+
+#include <QThread>
+#include <QVector>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <sys/resource.h>
+#include "polltask.h"
+#include "pollscheduler.h"
+#include "modbusclient.h"
+#include "modbusserversimulator.h"
+
+///
+/// \brief The PollBenchmark class
+/// Starts the server simulator on localhost, polls it with a number of tasks sharing one client
+/// and prints the achieved poll rate, the response time percentiles, CPU time and peak memory
+///
+class PollBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ExitCode
+    {
+        Success = 0,
+        UsageError,
+        CommunicationError
+    };
+
+    explicit PollBenchmark(QObject* parent = nullptr);
+    ~PollBenchmark() override;
+
+    bool parse(const QStringList& arguments);
+
+public slots:
+    void start();
+
+signals:
+    void finished(int exitCode);
+
+private slots:
+    void on_serverError(const QString& error);
+    void on_modbusConnected(const ConnectionDetails& cd);
+    void on_modbusConnectionError(const QString& error);
+
+private:
+    void report();
+    void finish(int exitCode, const QString& error = QString());
+
+private:
+    int _tasks = 10;
+    quint32 _scanRate = 100;
+    int _duration = 10;
+    quint16 _length = 10;
+    quint16 _port = 5502;
+    int _latency = 0;
+    bool _done = false;
+
+    ModbusClient _modbusClient;
+    PollScheduler _scheduler;
+    QVector<PollTask*> _pollTasks;
+
+    QThread* _serverThread = nullptr;
+    ModbusServerSimulator* _server = nullptr;
+
+    QElapsedTimer _clock;
+    rusage _startUsage = {};
+    rusage _startThreadUsage = {};
+
+    QTextStream _out;
+    QTextStream _err;
+};
+
+#endif // POLLBENCHMARK_H
@@ -0,0 +1,168 @@
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <termios.h>
+#include <unistd.h>
+#include "ptybridge.h"
+
+namespace {
+const int PollInterval = 50; // ms, how soon the thread notices a stop request
+}
+
+///
+/// \brief PtyBridge::PtyBridge
+/// \param parent
+///
+PtyBridge::PtyBridge(QObject* parent)
+    : QThread(parent)
+{
+}
+
+///
+/// \brief PtyBridge::~PtyBridge
+///
+PtyBridge::~PtyBridge()
+{
+    close();
+}
+
+///
+/// \brief PtyBridge::open
+/// \return
+///
+bool PtyBridge::open()
+{
+    if(!openPty(_client) || !openPty(_server))
+    {
+        close();
+        return false;
+    }
+
+    _clock.start();
+    start(QThread::TimeCriticalPriority);
+    return true;
+}
+
+///
+/// \brief PtyBridge::close
+///
+void PtyBridge::close()
+{
+    requestInterruption();
+    wait();
+
+    closePty(_client);
+    closePty(_server);
+}
+
+///
+/// \brief PtyBridge::takeChunks
+/// \return the chunks passed since the last call
+///
+QVector<PtyBridge::Chunk> PtyBridge::takeChunks()
+{
+    QMutexLocker locker(&_mutex);
+
+    QVector<Chunk> chunks;
+    chunks.swap(_chunks);
+    return chunks;
+}
+
+///
+/// \brief PtyBridge::run
+///
+void PtyBridge::run()
+{
+    pollfd fds[2] = {
+        { _client.Master, POLLIN, 0 },
+        { _server.Master, POLLIN, 0 }
+    };
+
+    while(!isInterruptionRequested())
+    {
+        if(::poll(fds, 2, PollInterval) <= 0)
+            continue;
+
+        if(fds[0].revents & POLLIN)
+            forward(_client.Master, _server.Master, true);
+
+        if(fds[1].revents & POLLIN)
+            forward(_server.Master, _client.Master, false);
+    }
+}
+
+///
+/// \brief PtyBridge::openPty
+/// \param pty
+/// \return
+///
+bool PtyBridge::openPty(Pty& pty)
+{
+    pty.Master = ::posix_openpt(O_RDWR | O_NOCTTY);
+    if(pty.Master < 0 || ::grantpt(pty.Master) != 0 || ::unlockpt(pty.Master) != 0)
+    {
+        _errorString = QString("posix_openpt: %1").arg(QString::fromLocal8Bit(std::strerror(errno)));
+        return false;
+    }
+
+    const char* name = ::ptsname(pty.Master);
+    pty.Name = QString::fromLocal8Bit(name);
+
+    // the slave end stays open while the ports are reopened, a master without one reads EIO
+    pty.Slave = ::open(name, O_RDWR | O_NOCTTY);
+    if(pty.Slave < 0)
+    {
+        _errorString = QString("%1: %2").arg(pty.Name, QString::fromLocal8Bit(std::strerror(errno)));
+        return false;
+    }
+
+    termios tio;
+    ::tcgetattr(pty.Slave, &tio);
+    ::cfmakeraw(&tio);
+    ::tcsetattr(pty.Slave, TCSANOW, &tio);
+
+    ::fcntl(pty.Master, F_SETFL, ::fcntl(pty.Master, F_GETFL) | O_NONBLOCK);
+    return true;
+}
+
+///
+/// \brief PtyBridge::closePty
+/// \param pty
+///
+void PtyBridge::closePty(Pty& pty)
+{
+    if(pty.Slave >= 0) ::close(pty.Slave);
+    if(pty.Master >= 0) ::close(pty.Master);
+    pty = Pty();
+}
+
+///
+/// \brief PtyBridge::forward
+/// \param from
+/// \param to
+/// \param fromClient
+///
+void PtyBridge::forward(int from, int to, bool fromClient)
+{
+    char buffer[512];
+    const auto size = ::read(from, buffer, sizeof(buffer));
+    if(size <= 0)
+        return;
+
+    const qint64 time = _clock.nsecsElapsed() / 1000;
+
+    qint64 written = 0;
+    while(written < size)
+    {
+        const auto n = ::write(to, buffer + written, size_t(size - written));
+        if(n > 0)
+            written += n;
+        else if(errno != EAGAIN && errno != EINTR)
+            break;
+    }
+
+    QMutexLocker locker(&_mutex);
+    _chunks.push_back({ time, int(size), fromClient });
+}
@@ -0,0 +1,64 @@
+#ifndef PTYBRIDGE_H
+#define PTYBRIDGE_H
+
+#include <QMutex>
+#include <QThread>
+#include <QVector>
+#include <QElapsedTimer>
+
+///
+/// \brief The PtyBridge class
+/// A virtual null-modem cable, as socat makes one: two pseudo terminals whose master ends are joined
+/// by a thread of their own. The client and the server open the slave ends like serial ports,
+/// every chunk passing the bridge is timestamped so the timing on the line can be checked afterwards
+///
+class PtyBridge : public QThread
+{
+    Q_OBJECT
+
+public:
+    struct Chunk
+    {
+        qint64 Time = 0;    ///< usecs since the bridge was opened
+        int Size = 0;
+        bool FromClient = false;
+    };
+
+    explicit PtyBridge(QObject* parent = nullptr);
+    ~PtyBridge() override;
+
+    bool open();
+    void close();
+
+    QString clientPort() const { return _client.Name; }
+    QString serverPort() const { return _server.Name; }
+    QString errorString() const { return _errorString; }
+
+    QVector<Chunk> takeChunks();
+
+protected:
+    void run() override;
+
+private:
+    struct Pty
+    {
+        int Master = -1;
+        int Slave = -1;
+        QString Name;
+    };
+
+    bool openPty(Pty& pty);
+    static void closePty(Pty& pty);
+    void forward(int from, int to, bool fromClient);
+
+private:
+    Pty _client;
+    Pty _server;
+    QString _errorString;
+
+    QElapsedTimer _clock;
+    QMutex _mutex;
+    QVector<Chunk> _chunks;
+};
+
+#endif // PTYBRIDGE_H
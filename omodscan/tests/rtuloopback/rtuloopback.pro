@@ -0,0 +1,15 @@
+TARGET = tst_rtuloopback
+
+include(../tests.pri)
+include(../simulator.pri)
+
+SOURCES += \
+    ../../modbusrtuscanner.cpp \
+    ../../modbusscanner.cpp \
+    ptybridge.cpp \
+    tst_rtuloopback.cpp
+
+HEADERS += \
+    ../../modbusrtuscanner.h \
+    ../../modbusscanner.h \
+    ptybridge.h
@@ -0,0 +1,251 @@
+#include <QtTest>
+#include "ptybridge.h"
+#include "modbusclient.h"
+#include "modbusrtuscanner.h"
+#include "modbusrtusniffer.h"
+#include "modbusserversimulator.h"
+
+namespace {
+const QSerialPort::BaudRate BaudRate = QSerialPort::Baud115200;
+const int RunTime = 3000;           // ms of polling for the throughput
+const int ConnectTimeout = 2000;    // ms
+const int ResponseTimeout = 500;    // ms
+const int ScanTimeout = 100;        // ms per unit id of the sweep
+const int SweepTimeout = 30000;     // ms, only a hung scanner gets near it
+const quint16 Registers = 125;
+const int DeviceId = 2;
+const int RequestId = 1;
+const int FirstUnitId = 2;          // unit ids answered by the simulator
+const int LastUnitId = 4;
+
+///
+/// \brief serialDetails
+/// \param portName
+/// \return
+///
+ConnectionDetails serialDetails(const QString& portName)
+{
+    ConnectionDetails cd;
+    cd.Type = ConnectionType::Serial;
+    cd.SerialParams.PortName = portName;
+    cd.SerialParams.BaudRate = BaudRate;
+    cd.SerialParams.SetDTR = false;
+    cd.SerialParams.SetRTS = false;
+    cd.ModbusParams.SlaveResponseTimeOut = ResponseTimeout;
+    cd.ModbusParams.NumberOfRetries = 1;
+    return cd;
+}
+
+///
+/// \brief The LineTiming struct
+/// Silence on the line before each frame, split by who sent it
+///
+struct LineTiming
+{
+    LatencyHistogram ClientGaps;    ///< last byte of a response to the first byte of the next request
+    LatencyHistogram ServerGaps;    ///< last byte of a request to the first byte of its response
+    quint64 Bytes = 0;
+};
+
+///
+/// \brief lineTiming
+/// Chunks of one direction closer than half of t3.5 belong to the same frame
+/// \param chunks
+/// \param t35 usecs
+/// \return
+///
+LineTiming lineTiming(const QVector<PtyBridge::Chunk>& chunks, int t35)
+{
+    LineTiming timing;
+    const PtyBridge::Chunk* last = nullptr;
+    for(auto&& chunk : chunks)
+    {
+        timing.Bytes += chunk.Size;
+
+        if(last && last->FromClient != chunk.FromClient)
+        {
+            auto& gaps = chunk.FromClient ? timing.ClientGaps : timing.ServerGaps;
+            gaps.record(chunk.Time - last->Time);
+        }
+        else if(last && chunk.Time - last->Time >= t35 / 2 && chunk.FromClient)
+        {
+            // a request after an unanswered one
+            timing.ClientGaps.record(chunk.Time - last->Time);
+        }
+
+        last = &chunk;
+    }
+    return timing;
+}
+
+///
+/// \brief report
+/// \param name
+/// \param h
+///
+void report(const char* name, const LatencyHistogram& h)
+{
+    qInfo("%s: %llu, min %lld us, p50 %lld us, p99 %lld us, max %lld us", name, h.count(),
+          h.min(), h.percentile(50), h.percentile(99), h.max());
+}
+
+///
+/// \brief reportSilence
+/// Pseudo terminals pass bytes on at once instead of at the baud rate, so the silence is reported, not checked
+/// \param name
+/// \param gaps
+/// \param t35 usecs
+///
+void reportSilence(const char* name, const LatencyHistogram& gaps, int t35)
+{
+    report(name, gaps);
+    if(gaps.count() > 0 && gaps.min() < t35)
+        qWarning("%s: %lld us is below t3.5 of %d us", name, gaps.min(), t35);
+}
+}
+
+///
+/// \brief The TestRtuLoopback class
+/// The server simulator in RTU mode on one end of a pseudo terminal pair, the client and the scanner
+/// on the other. Checks the replies and the unit ids found, the throughput, the sweep time and the
+/// silence kept between frames are only reported
+///
+class TestRtuLoopback : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void throughput();
+    void scannerSweep();
+
+private:
+    PtyBridge _bridge;
+    ModbusServerSimulator* _server = nullptr;
+};
+
+///
+/// \brief TestRtuLoopback::initTestCase
+///
+void TestRtuLoopback::initTestCase()
+{
+    QVERIFY2(_bridge.open(), qPrintable(_bridge.errorString()));
+
+    ModbusServerParams params;
+    params.Type = ConnectionType::Serial;
+    params.SerialParams = serialDetails(_bridge.serverPort()).SerialParams;
+    params.UnitIds = QRange<int>(FirstUnitId, LastUnitId);
+
+    _server = new ModbusServerSimulator(params, this);
+    QSignalSpy errors(_server, &ModbusServerSimulator::errorOccurred);
+    _server->start();
+    QVERIFY2(errors.isEmpty(), errors.isEmpty() ? "" : qPrintable(errors.first().first().toString()));
+}
+
+///
+/// \brief TestRtuLoopback::cleanupTestCase
+///
+void TestRtuLoopback::cleanupTestCase()
+{
+    if(_server)
+        _server->stop();
+
+    _bridge.close();
+}
+
+///
+/// \brief TestRtuLoopback::throughput
+/// One read of Registers in flight at a time, the next one is sent from the reply
+///
+void TestRtuLoopback::throughput()
+{
+    ModbusClient client;
+    client.connectDevice(serialDetails(_bridge.clientPort()));
+    QTRY_COMPARE_WITH_TIMEOUT(client.state(), QModbusDevice::ConnectedState, ConnectTimeout);
+
+    _bridge.takeChunks();
+
+    bool running = true;
+    quint64 replies = 0;
+    quint64 errors = 0;
+    connect(&client, &ModbusClient::modbusReply, this, [&](QModbusReply* reply) {
+        if(reply->error() == QModbusDevice::NoError && reply->result().valueCount() == Registers)
+            replies++;
+        else
+            errors++;
+
+        if(running)
+            client.sendReadRequest(QModbusDataUnit::HoldingRegisters, 0, Registers, DeviceId, RequestId);
+    });
+
+    QElapsedTimer timer;
+    timer.start();
+    client.sendReadRequest(QModbusDataUnit::HoldingRegisters, 0, Registers, DeviceId, RequestId);
+    QTest::qWait(RunTime);
+    running = false;
+
+    const double elapsed = timer.nsecsElapsed() / 1e9;
+    QTest::qWait(ResponseTimeout);
+    client.disconnectDevice();
+
+    const int t35 = ModbusRtuSniffer::interFrameDelay(BaudRate);
+    const auto timing = lineTiming(_bridge.takeChunks(), t35);
+    const auto& latency = client.statistics().value(DeviceId).Latency;
+
+    qInfo("%.1f polls/s, %.0f bytes/s on the line, %llu errors", replies / elapsed, timing.Bytes / elapsed, errors);
+    report("response time", latency);
+    reportSilence("client inter-frame silence", timing.ClientGaps, t35);
+    reportSilence("server inter-frame silence", timing.ServerGaps, t35);
+
+    QVERIFY(replies > 0);
+    QCOMPARE(errors, 0ull);
+}
+
+///
+/// \brief TestRtuLoopback::scannerSweep
+/// Unit ids 1..LastUnitId + 2, the simulator answers FirstUnitId..LastUnitId
+///
+void TestRtuLoopback::scannerSweep()
+{
+    ScanParams params;
+    params.Timeout = ScanTimeout;
+    params.DeviceIds = QRange<int>(1, LastUnitId + 2);
+    params.Request = QModbusRequest(QModbusPdu::ReadHoldingRegisters, quint16(0), quint16(1));
+    params.ConnParams << serialDetails(_bridge.clientPort());
+
+    ModbusRtuScanner scanner(params);
+
+    QList<int> found;
+    connect(&scanner, &ModbusScanner::found, this, [&](const ConnectionDetails&, int deviceId, bool dubious) {
+        if(!dubious && !found.contains(deviceId))
+            found.push_back(deviceId);
+    });
+
+    QSignalSpy finished(&scanner, &ModbusScanner::finished);
+    QSignalSpy errors(&scanner, &ModbusScanner::errorOccurred);
+
+    QElapsedTimer timer;
+    timer.start();
+    scanner.startScan();
+    QVERIFY(finished.count() > 0 || finished.wait(SweepTimeout));
+
+    // every unit id waits the timeout at most, either for its reply or after it
+    const int ids = params.DeviceIds.to() - params.DeviceIds.from() + 1;
+    const auto elapsed = timer.elapsed();
+    qInfo("sweep of %d unit ids: %lld ms, %.1f ms per unit id, %d ms expected at most", ids, elapsed,
+          double(elapsed) / ids, ids * ScanTimeout);
+
+    QVERIFY2(errors.isEmpty(), errors.isEmpty() ? "" : qPrintable(errors.first().first().toString()));
+    QList<int> expected;
+    for(int id = FirstUnitId; id <= LastUnitId; id++)
+        expected.push_back(id);
+
+    std::sort(found.begin(), found.end());
+    QCOMPARE(found, expected);
+}
+
+QTEST_GUILESS_MAIN(TestRtuLoopback)
+
+#include "tst_rtuloopback.moc"
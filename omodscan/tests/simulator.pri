@@ -0,0 +1,13 @@
+# The server simulator and the frame splitting it answers with
+
+SOURCES += \
+    $$PWD/../datasimulator.cpp \
+    $$PWD/../modbusframeparser.cpp \
+    $$PWD/../modbusrtusniffer.cpp \
+    $$PWD/../modbusserversimulator.cpp
+
+HEADERS += \
+    $$PWD/../datasimulator.h \
+    $$PWD/../modbusframeparser.h \
+    $$PWD/../modbusrtusniffer.h \
+    $$PWD/../modbusserversimulator.h
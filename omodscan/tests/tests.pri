@@ -0,0 +1,14 @@
+# Shared settings of the test executables, they link the core library like the application does
+
+QT = core network serialbus serialport testlib
+
+greaterThan(QT_MAJOR_VERSION, 5) {
+    QT += core5compat
+}
+
+CONFIG += c++17 console testcase
+CONFIG -= app_bundle
+CONFIG -= debug_and_release
+CONFIG -= debug_and_release_target
+
+include($$PWD/../core/core.pri)
@@ -0,0 +1,8 @@
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    benchmarks \
+    frameparser
+
+# the RTU loopback joins two pseudo terminals, the polling benchmark reads getrusage
+unix: SUBDIRS += rtuloopback pollbench